@@ -1,9 +1,9 @@
+#include <glm/gtc/type_ptr.hpp>
+
 #include "Camera.h"
 
 // Namespace using directives
 
-using std::lock_guard;
-using std::mutex;
 using std::string;
 using std::vector;
 
@@ -16,30 +16,27 @@ Camera::Camera(const string &name,
                const vector<float> &view,
                float zoom) :
     name(name),
-    view(view),
-    zoom(zoom) { }
+    state({glm::make_vec3(view.data()), zoom}) { }
 
 
 // Accessors / mutators
 
-const vector<float>& Camera::getView() const {
-    lock_guard<mutex> lock(stateMutex);
-    return view;
+Camera::State Camera::getState() const {
+    return state.load();
+}
+
+glm::vec3 Camera::getView() const {
+    return state.load().view;
 }
 
 void Camera::setView(float alpha, float beta, float phi) {
-    lock_guard<mutex> lock(stateMutex);
-    view[0] = alpha;
-    view[1] = beta;
-    view[2] = phi;
+    state.modify([&](State &s) { s.view = glm::vec3(alpha, beta, phi); });
 }
 
 float Camera::getZoom() const {
-    lock_guard<mutex> lock(stateMutex);
-    return zoom;
+    return state.load().zoom;
 }
 
 void Camera::setZoom(float z) {
-    lock_guard<mutex> lock(stateMutex);
-    zoom = z;
+    state.modify([&](State &s) { s.zoom = z; });
 }
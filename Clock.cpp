@@ -0,0 +1,120 @@
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
+
+#include "Clock.h"
+
+// Namespace using directives
+
+namespace chrono = std::chrono;
+
+using std::ostringstream;
+using std::string;
+
+
+// Implementation of class Clock
+
+// Constructor
+
+Clock::Clock() :
+    mode(Mode::REAL),
+    origin(chrono::steady_clock::now()),
+    step(0),
+    scale(1.0),
+    elapsed(0) { }
+
+
+// Public methods
+
+void Clock::setReal() {
+    mode = Mode::REAL;
+    scale = 1.0;
+
+    restart();
+}
+
+void Clock::setFixed(Duration s) {
+    mode = Mode::FIXED;
+    step = s;
+
+    restart();
+}
+
+void Clock::setAccelerated(double s) {
+    mode = Mode::ACCELERATED;
+    scale = s;
+
+    restart();
+}
+
+bool Clock::parse(const string &description) {
+    auto separator(description.find(':'));
+    auto name(description.substr(0, separator));
+
+    double value(0.0);
+    if (separator != string::npos) {
+        char *end(nullptr);
+        value = std::strtod((description.c_str() + separator + 1), &end);
+        if (*end != '\0') return false;
+    }
+
+    if ((name == "real") and (separator == string::npos)) {
+        setReal();
+    } else if ((name == "fixed") and (separator == string::npos)) {
+        setFixed(Duration(16666667));
+    } else if ((name == "fixed") and (value > 0.0)) {
+        setFixed(Duration(std::llround(1.0e9 / value)));
+    } else if ((name == "accelerated") and (value > 0.0)) {
+        setAccelerated(value);
+    } else {
+        return false;
+    }
+
+    return true;
+}
+
+string Clock::describe() const {
+    ostringstream description;
+    description.precision(9);
+
+    switch (mode) {
+    case Mode::REAL:
+        description << "real";
+        break;
+    case Mode::FIXED:
+        description << "fixed:" << (1.0e9 / step.count());
+        break;
+    case Mode::ACCELERATED:
+        description << "accelerated:" << scale;
+        break;
+    }
+
+    return description.str();
+}
+
+void Clock::tick() {
+    if (mode == Mode::FIXED) elapsed += step;
+}
+
+
+// Accessors
+
+Clock::Duration Clock::now() const {
+    if (mode == Mode::FIXED) return elapsed;
+
+    auto real(chrono::duration_cast<Duration>(chrono::steady_clock::now() - origin));
+    return (elapsed + Duration(std::llround(real.count() * scale)));
+}
+
+Clock::Mode Clock::getMode() const {
+    return mode;
+}
+
+
+// Private methods
+
+void Clock::restart() {
+    // Time spent before the clock was configured must not leak into a run
+    origin = chrono::steady_clock::now();
+    elapsed = Duration(0);
+}
@@ -0,0 +1,244 @@
+#include <algorithm>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+#include "EffectCosts.h"
+#include "Florb.h"
+#include "FlorbConfigs.h"
+#include "nlohmann/json.hpp"
+
+// Namespace using directives
+
+using std::cout;
+using std::endl;
+using std::ostringstream;
+using std::runtime_error;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+using json = nlohmann::json_abi_v3_12_0::json;
+
+
+// Implementation of class EffectCosts
+
+// Static attribute initialization
+
+// Each effect at the strength of the sample effects configuration. The
+// vignette has no switch, so is taken from a steep falloff to a gentle one.
+const EffectCosts::Effect EffectCosts::k_Effects[] = {
+    { "anisotropy",  R"({ "effects" : { "anisotropy" : { "enabled" : true, "strength" : 2.5, "sharpness" : 10.0 } } })" },
+    { "iridescence", R"({ "effects" : { "iridescence" : { "strength" : 0.15, "frequency" : 6.0, "shift" : 1.0 } } })" },
+    { "rim",         R"({ "light" : { "rim" : { "strength" : 0.25 } } })" },
+    { "motes",       R"({ "effects" : { "motes" : { "count" : 256 } } })" },
+    { "flutter",     R"({ "effects" : { "flutter" : { "enabled" : true, "amplitude" : 0.01 } } })" },
+    { "vignette",    R"({ "effects" : { "vignette" : { "exponent" : 3.0 } } })" },
+    { "blend",       R"({ "transitions" : { "mode" : "blend" } })" }
+};
+
+// A transition which never ends keeps a blend in progress throughout
+const char *const EffectCosts::k_EffectsOff = R"({
+    "transitions" : { "mode" : "flip", "time" : 1.0e6 },
+    "light" : { "rim" : { "strength" : 0.0 } },
+    "effects" : {
+        "anisotropy" : { "enabled" : false },
+        "iridescence" : { "strength" : 0.0 },
+        "motes" : { "count" : 0 },
+        "flutter" : { "enabled" : false },
+        "vignette" : { "exponent" : 64.0 }
+    },
+    "debug" : {
+        "anisotropic_mode" : "normal",
+        "render_mode" : "fill",
+        "specular_mode" : "normal"
+    }
+})";
+
+const unsigned int EffectCosts::k_DefaultFrames(120U);
+
+// Enough for uniform uploads and shader variants to settle after a change
+const unsigned int EffectCosts::k_WarmupFrames(10U);
+
+
+// Constructor / destructor
+
+EffectCosts::EffectCosts(shared_ptr<FlorbConfigs> configs, Florb &florb) :
+    configs(configs),
+    florb(florb),
+    document(configs->getSnapshot()->document),
+    queries() { }
+
+EffectCosts::~EffectCosts() {
+    if (!queries.empty()) glDeleteQueries(queries.size(), queries.data());
+}
+
+
+// Public methods
+
+void EffectCosts::prepare(FlorbConfigs &configs) {
+    auto loaded(configs.getSnapshot());
+
+    auto scene(json::parse(loaded->document));
+    for (const auto &effect : k_Effects) scene.merge_patch(json::parse(effect.patch));
+
+    configs.parse(scene.dump());
+
+    // The patches touch no lights or cameras, so the scene measured is the one configured
+    auto prepared(configs.getSnapshot());
+    if ((prepared->spotlights.size() != loaded->spotlights.size()) or
+        (prepared->cameras.size() != loaded->cameras.size())) {
+
+        ostringstream error;
+        error << "Effect costs would be measured with "
+              << prepared->spotlights.size() << " spotlights and " << prepared->cameras.size()
+              << " cameras, rather than the " << loaded->spotlights.size() << " and "
+              << loaded->cameras.size() << " configured";
+        throw runtime_error(error.str());
+    }
+}
+
+bool EffectCosts::parseSizes(const string &description, vector<Size> &sizes) {
+    std::istringstream list(description);
+    string item;
+
+    while (std::getline(list, item, ',')) {
+        Size size;
+        char separator('\0');
+        char extra('\0');
+
+        if ((std::sscanf(item.c_str(), "%d%c%d%c", &size.first, &separator, &size.second, &extra) != 3) or
+            (separator != 'x') or (size.first <= 0) or (size.second <= 0)) return false;
+
+        sizes.push_back(size);
+    }
+
+    return !sizes.empty();
+}
+
+void EffectCosts::run(const vector<Size> &sizes, unsigned int frames) {
+    extern int screenWidth;
+    extern int screenHeight;
+
+    // Rows of every effect off, each effect alone, and every effect on
+    vector<string> names(1, "none");
+    vector<string> patches(1, "{}");
+
+    json all(json::object());
+    for (const auto &effect : k_Effects) {
+        names.push_back(effect.name);
+        patches.push_back(effect.patch);
+        all.merge_patch(json::parse(effect.patch));
+    }
+
+    names.push_back("all");
+    patches.push_back(all.dump());
+
+    queries.resize(2 * frames);
+    glGenQueries(queries.size(), queries.data());
+
+    // Flower images upload one per frame; costs are measured once all are in
+    apply(patches[0]);
+    while (florb.isLoading()) florb.renderFrame();
+
+    vector<vector<double>> costs(names.size(), vector<double>(sizes.size(), 0.0));
+
+    for (size_t column = 0; column < sizes.size(); column++) {
+        screenWidth = sizes[column].first;
+        screenHeight = sizes[column].second;
+        glViewport(0, 0, screenWidth, screenHeight);
+
+        for (size_t row = 0; row < names.size(); row++) {
+            apply(patches[row]);
+            costs[row][column] = measure(frames);
+
+            cout << "[INFO] "
+                 << names[row]
+                 << " at "
+                 << screenWidth
+                 << "x"
+                 << screenHeight
+                 << " : "
+                 << std::fixed
+                 << std::setprecision(3)
+                 << costs[row][column]
+                 << " ms"
+                 << endl;
+        }
+    }
+
+    cout << endl
+         << "GPU time per frame with every effect off, and the marginal cost of each effect"
+         << " alone (median of " << frames << " frames)" << endl
+         << std::left << std::setw(14) << "effect";
+
+    for (const auto &size : sizes) {
+        ostringstream heading;
+        heading << size.first << "x" << size.second;
+        cout << std::right << std::setw(24) << heading.str();
+    }
+    cout << endl;
+
+    for (size_t row = 0; row < names.size(); row++) {
+        cout << std::left << std::setw(14) << names[row] << std::right;
+
+        for (size_t column = 0; column < sizes.size(); column++) {
+            auto base(costs[0][column]);
+            auto cost(costs[row][column]);
+
+            ostringstream cell;
+            cell << std::fixed << std::setprecision(3);
+
+            if (row == 0) {
+                cell << cost << " ms";
+            } else {
+                cell << std::showpos << (cost - base) << " ms ("
+                     << std::setprecision(0) << ((base > 0.0) ? (100.0 * (cost - base) / base) : 0.0) << "%)";
+            }
+
+            cout << std::setw(24) << cell.str();
+        }
+        cout << endl;
+    }
+
+}
+
+
+// Private methods
+
+void EffectCosts::apply(const string &patch) {
+    auto scene(json::parse(document));
+    scene.merge_patch(json::parse(k_EffectsOff));
+    scene.merge_patch(json::parse(patch));
+
+    configs->parse(scene.dump());
+}
+
+double EffectCosts::measure(unsigned int frames) {
+    for (unsigned int frame = 0; frame < k_WarmupFrames; frame++) florb.renderFrame();
+
+    for (unsigned int frame = 0; frame < frames; frame++) {
+        glQueryCounter(queries[2 * frame], GL_TIMESTAMP);
+        florb.renderFrame();
+        glQueryCounter(queries[(2 * frame) + 1], GL_TIMESTAMP);
+    }
+
+    // Results are only read back once every frame is complete
+    glFinish();
+
+    vector<double> times;
+    for (unsigned int frame = 0; frame < frames; frame++) {
+        GLuint64 begin(0);
+        GLuint64 end(0);
+        glGetQueryObjectui64v(queries[2 * frame], GL_QUERY_RESULT, &begin);
+        glGetQueryObjectui64v(queries[(2 * frame) + 1], GL_QUERY_RESULT, &end);
+
+        times.push_back((end - begin) / 1.0e6);
+    }
+
+    std::nth_element(times.begin(), (times.begin() + (times.size() / 2)), times.end());
+
+    return times[times.size() / 2];
+}
@@ -0,0 +1,163 @@
+#include <iostream>
+#include <stdexcept>
+
+#include "EventScript.h"
+#include "nlohmann/json.hpp"
+
+// Namespace using directives
+
+using std::cout;
+using std::endl;
+using std::ifstream;
+using std::runtime_error;
+using std::string;
+
+using json = nlohmann::json_abi_v3_12_0::json;
+
+
+// Implementation of class EventScript
+
+// Static attribute initialization
+
+const int EventScript::k_Version(1);
+
+
+// Constructor
+
+EventScript::EventScript() :
+    output(),
+    events(),
+    replaying(false) { }
+
+
+// Public methods
+
+void EventScript::record(const string &path, const Header &header) {
+    output.open(path);
+    if (!output) throw runtime_error("Cannot open session script \"" + path + "\"");
+
+    json line;
+    line["florb_script"] = k_Version;
+    line["seed"] = header.seed;
+    line["clock"] = header.clock;
+    line["width"] = header.width;
+    line["height"] = header.height;
+
+    output << line.dump() << endl;
+
+    cout << "[INFO] Recording session to \"" << path << "\"" << endl;
+}
+
+EventScript::Header EventScript::replay(const string &path) {
+    ifstream input(path);
+    if (!input) throw runtime_error("Cannot open session script \"" + path + "\"");
+
+    Header header;
+    string text;
+
+    try {
+        if (!std::getline(input, text)) throw runtime_error("empty script");
+
+        auto line(json::parse(text));
+        if (line.value("florb_script", 0) != k_Version) throw runtime_error("unknown script version");
+
+        header.seed = line.at("seed");
+        header.clock = line.at("clock");
+        header.width = line.at("width");
+        header.height = line.at("height");
+
+        while (std::getline(input, text)) {
+            if (text.empty()) continue;
+
+            line = json::parse(text);
+
+            Event event;
+            event.frame = line.at("frame");
+
+            const string type(line.at("type"));
+            if (type == "key") {
+                event.type = Type::KEY;
+                event.key = line.at("key");
+            } else if (type == "resize") {
+                event.type = Type::RESIZE;
+                event.width = line.at("width");
+                event.height = line.at("height");
+            } else if (type == "config") {
+                event.type = Type::CONFIG;
+                event.document = line.at("document");
+            } else if (type == "end") {
+                event.type = Type::END;
+            } else {
+                throw runtime_error("unknown event type \"" + type + "\"");
+            }
+
+            events.push_back(event);
+        }
+    } catch (const std::exception &exc) {
+        throw runtime_error("Cannot read session script \"" + path + "\" : " + exc.what());
+    }
+
+    replaying = true;
+
+    cout << "[INFO] Replaying "
+         << events.size()
+         << " events from \""
+         << path
+         << "\" (seed "
+         << header.seed
+         << ", clock "
+         << header.clock
+         << ")"
+         << endl;
+
+    return header;
+}
+
+void EventScript::add(const Event &event) {
+    if (!output.is_open()) return;
+
+    json line;
+    line["frame"] = event.frame;
+
+    switch (event.type) {
+    case Type::KEY:
+        line["type"] = "key";
+        line["key"] = event.key;
+        break;
+    case Type::RESIZE:
+        line["type"] = "resize";
+        line["width"] = event.width;
+        line["height"] = event.height;
+        break;
+    case Type::CONFIG:
+        line["type"] = "config";
+        line["document"] = event.document;
+        break;
+    case Type::END:
+        line["type"] = "end";
+        break;
+    }
+
+    // Flushed, so a script survives a crash up to its last event
+    output << line.dump() << endl;
+}
+
+bool EventScript::poll(unsigned long frame, Event &event) {
+    if (events.empty() or (events.front().frame > frame)) return false;
+
+    event = events.front();
+    events.pop_front();
+
+    return true;
+}
+
+
+// Accessors
+
+bool EventScript::isRecording() const {
+    return output.is_open();
+}
+
+bool EventScript::isReplaying() const {
+    return replaying;
+}
@@ -0,0 +1,30 @@
+#include "ExpressionMotion.h"
+
+// Namespace using directives
+using std::string;
+using std::vector;
+
+
+// Implementation of class ExpressionMotion
+
+// Constructor
+
+ExpressionMotion::ExpressionMotion(bool enabled, const vector<string> &expressions) :
+    MultiMotion(enabled),
+    expressions() {
+
+    this->expressions.reserve(expressions.size());
+    for (const auto &expression : expressions) this->expressions.emplace_back(expression);
+}
+
+void ExpressionMotion::evaluate(float time, float *results, size_t count) const {
+    auto dimensions(count < expressions.size() ? count : expressions.size());
+
+    for (size_t i = 0; i < dimensions; i++) {
+        results[i] = expressions[i].evaluate(time);
+    }
+}
+
+size_t ExpressionMotion::getDimensions() const {
+    return expressions.size();
+}
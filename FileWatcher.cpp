@@ -0,0 +1,90 @@
+#include "FileWatcher.h"
+
+// Namespace using directives
+
+namespace chrono = std::chrono;
+namespace fs = std::filesystem;
+
+using std::error_code;
+using std::lock_guard;
+using std::mutex;
+using std::string;
+using std::thread;
+using std::unique_lock;
+using std::vector;
+
+
+// Implementation of class FileWatcher
+
+// Constructor / destructor
+
+FileWatcher::FileWatcher(const vector<string> &paths,
+                         chrono::milliseconds interval) :
+    paths(paths),
+    interval(interval),
+    writeTimes(),
+    generation(0U),
+    running(true),
+    wakeMutex(),
+    wake(),
+    watcher() {
+
+    // Record the baseline modification times before watching begins
+    for (const auto &path : paths) writeTimes.push_back(writeTime(path));
+
+    watcher = thread(&FileWatcher::watch, this);
+}
+
+FileWatcher::~FileWatcher() {
+    {
+        lock_guard<mutex> lock(wakeMutex);
+        running = false;
+    }
+
+    wake.notify_all();
+    watcher.join();
+}
+
+
+// Accessors
+
+const vector<string>& FileWatcher::getPaths() const {
+    return paths;
+}
+
+unsigned int FileWatcher::getGeneration() const {
+    return generation.load(std::memory_order_acquire);
+}
+
+
+// Private methods
+
+void FileWatcher::watch() {
+    unique_lock<mutex> lock(wakeMutex);
+
+    while (running) {
+        wake.wait_for(lock, interval);
+        if (!running) break;
+
+        // Any file whose modification time moved constitutes a change
+        bool changed(false);
+        for (size_t i = 0; i < paths.size(); i++) {
+            auto modified(writeTime(paths[i]));
+
+            if (modified != writeTimes[i]) {
+                writeTimes[i] = modified;
+                changed = true;
+            }
+        }
+
+        if (changed) generation.fetch_add(1U, std::memory_order_release);
+    }
+}
+
+fs::file_time_type FileWatcher::writeTime(const string &path) const {
+    // Files which are briefly missing (e.g. editor save-by-rename) read as epoch
+    error_code error;
+    auto modified(fs::last_write_time(path, error));
+
+    return (error ? fs::file_time_type::min() : modified);
+}
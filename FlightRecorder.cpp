@@ -0,0 +1,341 @@
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+#include "FlightRecorder.h"
+#include "FlorbUtils.h"
+
+// Namespace using directives
+
+using std::cerr;
+using std::cout;
+using std::endl;
+using std::int64_t;
+using std::lock_guard;
+using std::mutex;
+using std::ofstream;
+using std::shared_ptr;
+using std::string;
+using std::thread;
+using std::unique_lock;
+
+
+// Implementation of class FlightRecorder
+
+// Static attribute initialization
+
+// The fastest rate FramePacer paces frames at, so the ring covers a whole window
+const float FlightRecorder::k_MaxFrameRate(240.0f);
+
+// Bounds the ring, and the two snapshots filled from it
+const int64_t FlightRecorder::k_MaxWindow(60000000000);
+
+// Hitches often come in bursts; one snapshot covers the burst
+const int64_t FlightRecorder::k_MinSnapshotInterval(10000000000);
+
+
+// Constructor / destructor
+
+FlightRecorder::FlightRecorder(shared_ptr<const FrameProfiler> profiler) :
+    profiler(profiler),
+    enabled(true),
+    window(10000000000),
+    threshold(2.0f),
+    directory("."),
+    frames(getCapacity(window)),
+    frameCapacity(frames.size()),
+    frameNext(0),
+    frameCount(0),
+    events(k_MaxEvents),
+    eventNext(0),
+    eventCount(0),
+    lastEnd(0),
+    lastErrors(0UL),
+    lastSnapshot(0),
+    snapshots(0UL),
+    pending(),
+    writePending(false),
+    running(true),
+    writing(),
+    writeMutex(),
+    wake(),
+    writer() {
+
+    // Snapshots are filled in place, so recording never allocates
+    reserve(pending);
+    reserve(writing);
+
+    writer = thread(&FlightRecorder::writeLoop, this);
+}
+
+FlightRecorder::~FlightRecorder() {
+    {
+        lock_guard<mutex> lock(writeMutex);
+        running = false;
+    }
+
+    wake.notify_all();
+    writer.join();
+}
+
+
+// Public methods
+
+void FlightRecorder::setEnabled(bool e) {
+    enabled = e;
+}
+
+void FlightRecorder::setWindow(float seconds) {
+    if (seconds <= 0.0f) return;
+
+    auto w(std::min(static_cast<int64_t>(seconds * 1.0e9), k_MaxWindow));
+    if (w == window) return;
+
+    window = w;
+
+    auto capacity(getCapacity(window));
+    if (capacity == frameCapacity) return;
+
+    // The history is dropped along with the old ring
+    frames.assign(capacity, Frame());
+    frameNext = 0;
+    frameCount = 0;
+
+    lock_guard<mutex> lock(writeMutex);
+    frameCapacity = capacity;
+
+    // The snapshot being written is resized by the writer once it is done
+    reserve(pending);
+    if (!writePending) reserve(writing);
+}
+
+void FlightRecorder::setThreshold(float multiple) {
+    if (multiple > 1.0f) threshold = multiple;
+}
+
+void FlightRecorder::setDirectory(const string &d) {
+    if (d != directory) directory = d;
+}
+
+void FlightRecorder::addEvent(const char *name, double value) {
+    if (!enabled) return;
+
+    events[eventNext] = { FrameProfiler::now(), name, value };
+    eventNext = ((eventNext + 1) % k_MaxEvents);
+    if (eventCount < k_MaxEvents) eventCount++;
+}
+
+void FlightRecorder::addFrame(int64_t budget) {
+    if (!enabled) return;
+
+    auto end(FrameProfiler::now());
+    auto interval((lastEnd != 0) ? (end - lastEnd) : 0);
+    lastEnd = end;
+
+    auto &frame(frames[frameNext]);
+    frame.end = end;
+    frame.interval = interval;
+    frame.glErrors = (FlorbUtils::glErrorCount() - lastErrors);
+    lastErrors += frame.glErrors;
+    frame.stages = profiler->getLastFrame();
+
+    frameNext = ((frameNext + 1) % frameCapacity);
+    if (frameCount < frameCapacity) frameCount++;
+
+    if ((budget > 0) and
+        (interval > static_cast<int64_t>(budget * threshold)) and
+        ((lastSnapshot == 0) or ((end - lastSnapshot) >= k_MinSnapshotInterval))) {
+        capture(frame, budget);
+    }
+}
+
+unsigned long FlightRecorder::getSnapshots() const {
+    return snapshots;
+}
+
+
+// Private methods
+
+size_t FlightRecorder::getCapacity(int64_t window) {
+    return (static_cast<size_t>(std::ceil((window / 1.0e9) * k_MaxFrameRate)) + 1);
+}
+
+void FlightRecorder::reserve(Snapshot &snapshot) const {
+    snapshot.frames.reserve(frameCapacity);
+    snapshot.events.reserve(k_MaxEvents);
+
+    snapshot.stageNames.resize(FrameProfiler::k_MaxStages);
+    for (auto &name : snapshot.stageNames) name.reserve(k_MaxStageName);
+
+    snapshot.counterNames.reserve(FrameProfiler::k_MaxCounters);
+    snapshot.path.reserve(PATH_MAX);
+}
+
+void FlightRecorder::capture(const Frame &trigger, int64_t budget) {
+    unique_lock<mutex> lock(writeMutex, std::try_to_lock);
+
+    // Never wait on the writer; a snapshot still being written wins
+    if (!lock.owns_lock() or writePending) return;
+
+    lastSnapshot = trigger.end;
+    snapshots++;
+
+    // Copy out the window, oldest first
+    pending.frames.clear();
+    for (size_t i = 0; i < frameCount; i++) {
+        const auto &frame(frames[(frameNext + frameCapacity - frameCount + i) % frameCapacity]);
+        if ((trigger.end - frame.end) <= window) pending.frames.push_back(frame);
+    }
+
+    pending.events.clear();
+    for (size_t i = 0; i < eventCount; i++) {
+        const auto &event(events[(eventNext + k_MaxEvents - eventCount + i) % k_MaxEvents]);
+        if ((trigger.end - event.time) <= window) pending.events.push_back(event);
+    }
+
+    // Names fit the storage reserved for them, unless unusually long
+    pending.stageCount = std::min(profiler->getStageCount(), FrameProfiler::k_MaxStages);
+    for (unsigned int stage = 0; stage < pending.stageCount; stage++) {
+        pending.stageNames[stage] = profiler->getStageName(stage);
+    }
+
+    pending.counterNames.resize(profiler->getCounterCount());
+    for (size_t counter = 0; counter < profiler->getCounterCount(); counter++) {
+        pending.counterNames[counter] = profiler->getCounterName(counter);
+    }
+
+    // Name the snapshot after the wall clock time of the hitch
+    auto wallTime(std::time(nullptr));
+    std::tm local;
+    localtime_r(&wallTime, &local);
+
+    char time[32];
+    std::strftime(time, sizeof(time), "%Y%m%d-%H%M%S", &local);
+
+    char name[96];
+    std::snprintf(name, sizeof(name), "/florb-hitch-%s-%llu.json",
+                  time, static_cast<unsigned long long>(trigger.stages.frame));
+
+    pending.budget = budget;
+    pending.path.assign(directory);
+    pending.path.append(name);
+
+    writePending = true;
+    lock.unlock();
+    wake.notify_one();
+}
+
+void FlightRecorder::writeLoop() {
+    unique_lock<mutex> lock(writeMutex);
+
+    while (true) {
+        wake.wait(lock, [this] { return (writePending or !running); });
+        if (!running) break;
+
+        std::swap(pending, writing);
+        lock.unlock();
+
+        write(writing);
+
+        lock.lock();
+        reserve(writing);
+        writePending = false;
+    }
+}
+
+void FlightRecorder::write(const Snapshot &snapshot) {
+    ofstream file(snapshot.path);
+    if (!file) {
+        cerr << "[WARN] Could not write hitch snapshot \"" << snapshot.path << "\"" << endl;
+        return;
+    }
+
+    // Times are in milliseconds, relative to the end of the slow frame
+    const auto &trigger(snapshot.frames.back());
+    auto milliseconds = [&trigger](int64_t time) {
+        return ((time - trigger.end) / 1.0e6);
+    };
+
+    file << std::fixed << std::setprecision(3);
+    file << "{\n  \"frame\" : " << trigger.stages.frame
+         << ",\n  \"interval_ms\" : " << (trigger.interval / 1.0e6)
+         << ",\n  \"budget_ms\" : " << (snapshot.budget / 1.0e6)
+         << ",\n  \"frames\" : [";
+
+    for (size_t i = 0; i < snapshot.frames.size(); i++) {
+        const auto &frame(snapshot.frames[i]);
+
+        file << ((i == 0) ? "\n" : ",\n")
+             << "    { \"frame\" : " << frame.stages.frame
+             << ", \"end_ms\" : " << milliseconds(frame.end)
+             << ", \"interval_ms\" : " << (frame.interval / 1.0e6)
+             << ", \"gl_errors\" : " << frame.glErrors;
+
+        const int64_t *times[] = { frame.stages.cpu, frame.stages.gpu };
+        const char *sources[] = { "cpu_ms", "gpu_ms" };
+
+        for (unsigned int s = 0; s < 2; s++) {
+            file << ", \"" << sources[s] << "\" : {";
+
+            bool first(true);
+            for (size_t stage = 0; stage < snapshot.stageCount; stage++) {
+                if (times[s][stage] < 0) continue;
+
+                file << (first ? " \"" : ", \"")
+                     << snapshot.stageNames[stage]
+                     << "\" : "
+                     << (times[s][stage] / 1.0e6);
+                first = false;
+            }
+
+            file << (first ? "}" : " }");
+        }
+
+        // Performance counter deltas of each stage, where collected
+        if (!snapshot.counterNames.empty()) {
+            file << ", \"counters\" : {";
+
+            bool first(true);
+            for (size_t stage = 0; stage < snapshot.stageCount; stage++) {
+                const auto &counts(frame.stages.counters[stage]);
+                if (counts[0] < 0) continue;
+
+                file << (first ? " \"" : ", \"") << snapshot.stageNames[stage] << "\" : {";
+                for (size_t counter = 0; counter < snapshot.counterNames.size(); counter++) {
+                    file << ((counter == 0) ? " \"" : ", \"")
+                         << snapshot.counterNames[counter]
+                         << "\" : "
+                         << counts[counter];
+                }
+                file << " }";
+
+                first = false;
+            }
+
+            file << (first ? "}" : " }");
+        }
+
+        file << " }";
+    }
+
+    file << "\n  ],\n  \"events\" : [";
+
+    for (size_t i = 0; i < snapshot.events.size(); i++) {
+        const auto &event(snapshot.events[i]);
+
+        file << ((i == 0) ? "\n" : ",\n")
+             << "    { \"time_ms\" : " << milliseconds(event.time)
+             << ", \"name\" : \"" << event.name
+             << "\", \"value\" : " << event.value
+             << " }";
+    }
+
+    file << "\n  ]\n}\n";
+
+    cout << "[INFO] Slow frame; wrote hitch snapshot \"" << snapshot.path << "\"" << endl;
+}
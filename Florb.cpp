@@ -6,33 +6,36 @@
 #include <cmath>
 #include <filesystem>
 #include <iostream>
+#include <sstream>
 #include <stdint.h>
 
 #include "Camera.h"
 #include "Florb.h"
 #include "FlorbConfigs.h"
 #include "FlorbUtils.h"
+#include "GLDebug.h"
+#include "KeyframeCurve.h"
+#include "MotionExpression.h"
+#include "ShaderProgram.h"
 #include "SinusoidalMotion.h"
 #include "Spotlight.h"
+#include "Tracer.h"
 
 
 namespace chrono = std::chrono;
 namespace fs = std::filesystem;
 
-using chrono::duration_cast;
-using chrono::milliseconds;
-using chrono::steady_clock;
-
 using std::cerr;
 using std::cos;
 using std::cout;
 using std::default_random_engine;
 using std::endl;
+using std::exception;
 using std::make_shared;
 using std::min;
 using std::mt19937;
+using std::ostringstream;
 using std::pair;
-using std::random_device;
 using std::shared_ptr;
 using std::shuffle;
 using std::sin;
@@ -56,25 +59,28 @@ const float Florb::k_MaxMoteWinkFrequency(1.0f);
 
 const float Florb::k_MoteWinkThreshold(0.001f);
 
+const char *const Florb::k_StageNames[MAX_STAGES] = {
+    "configs", "timeline", "sphere", "textures", "shaders",
+    "physics", "motes", "uniforms", "draw"
+};
+
 
 // Constructor
 
-Florb::Florb() :
+Florb::Florb(shared_ptr<FlorbConfigs> configs, unsigned int seed) :
     flowers(),
     flowerPaths(),
     loadFlower(0UL),
     currentFlower(0UL),
     previousFlower(0UL),
-    flowersRandom(),
+    flowersRandom(make_shared<default_random_engine>(seed)),
 
-    transitionStart(0.0f),
+    transitionStart(0),
 
     cameras(),
 
     baseRadius(FlorbConfigs::k_DefaultRadius),
     
-    baseRimStrength(0.0f),
-    
     animatedRimColor(0.0f, 0.0f, 0.0f),
     
     moteCount(0UL),
@@ -82,7 +88,6 @@ Florb::Florb() :
     motesSpeeds(),
     motesMaxStep(),
     motesCenters(),
-    motesPulsers(),
     motesWinkingEnabled(),
     motesWinkTimes(),
     motesWinking(),
@@ -91,66 +96,100 @@ Florb::Florb() :
     motesDirections(),
     motesColor(),
 
-    configs(make_shared<FlorbConfigs>()),
+    configs(configs),
+    snapshot(),
+
+    profiler(make_shared<FrameProfiler>()),
+
+    recorder(make_shared<FlightRecorder>(profiler)),
+
+    timeline(),
+    imageSwitchEvent(0UL),
+    imageSwitchPeriod(0.0f),
+    transitionPending(false),
+
+    motions(),
+    motionValues(),
+    motesMotion(0UL),
+    motionSources(),
+    motionExpressions(),
+    motionCurves(),
 
-    bouncer(make_shared<SinusoidalMotion>()),
-    bounceOffset(0.0f),
-    breather(make_shared<SinusoidalMotion>()),
-    rimPulser(make_shared<SinusoidalMotion>()),
+    physics(),
+    bounceBody(physics.addBody(PhysicsWorld::Body())),
+    physicsTime(0),
+
+    uniformStatsFrames(0U),
+    uniformStatsCalls(0UL),
+    uniformStatsUploads(0UL),
 
     loadingTexture(FlorbUtils::createTexture(0, 0, 0, 255)),
     fallbackTexture(FlorbUtils::createTexture(255, 0, 0, 255)),
     
     dist(0.0f, 1.0f) {
 
-    // Load configs and initialize dependent elements
-    configs->load();
+    GLDebug::label(GL_TEXTURE, loadingTexture, "loading");
+    GLDebug::label(GL_TEXTURE, fallbackTexture, "fallback");
 
-    cameras = configs->getCameras();
+    // Register the profiled frame stages, whose indices match ProfileStage
+    for (auto name : k_StageNames) profiler->addStage(name);
 
-    spotlights = configs->getSpotlights();
+    // Seed the Mersenne Twister for the motes, apart from the flower order
+    std::seed_seq moteSeeds{ seed };
+    gen.seed(moteSeeds);
 
-    createBouncer();
-    
-    baseRadius = configs->getRadius();
+    // Initialize elements dependent upon the configs
+    snapshot = configs->getSnapshot();
 
-    baseRimStrength = configs->getRimStrength();
-    
-    createBreather();
+    cameras = snapshot->cameras;
 
-    createRimPulser();
-    
-    initMotes(configs->getMoteCount(),
-              configs->getMotesRadius(),
-              configs->getMotesMaxStep(),
-              configs->getMotesColor());
+    spotlights = snapshot->spotlights;
+
+    baseRadius = snapshot->radius;
+
+    initMotes(snapshot->moteCount,
+              snapshot->motesRadius,
+              snapshot->motesMaxStep,
+              snapshot->motesColor);
+
+    // Storage for one batch evaluation of every motion per frame
+    motionValues.resize(motions.size());
 
-    unsigned seed(chrono::system_clock::now().time_since_epoch().count());
-    flowersRandom = make_shared<default_random_engine>(seed);
     loadFlowers();
     
     initShaders();
 
-    // Seed the Mersenne Twister
-    gen.seed(rd());
+    scheduleImageSwitch();
 }
 
 Florb::~Florb() {
     glDeleteVertexArrays(1, &vao);
     glDeleteBuffers(1, &vbo);
     glDeleteBuffers(1, &ebo);
-    glDeleteProgram(shaderProgram);
 }
 
 shared_ptr<FlorbConfigs> Florb::getConfigs() const {
     return configs;
 }
 
+shared_ptr<FrameProfiler> Florb::getProfiler() const {
+    return profiler;
+}
+
+shared_ptr<FlightRecorder> Florb::getRecorder() const {
+    return recorder;
+}
+
+void Florb::setClock(shared_ptr<Clock> clock) {
+    timeline.setClock(clock);
+}
+
 void Florb::nextFlower() {
     
     if (flowers.empty()) return;
     
     previousFlower = currentFlower;
+    recorder->addEvent("flower switch", currentFlower);
     if(++currentFlower >= flowers.size()) {
         // Cache a reference to the last flower displayed
         const auto lastFlower(flowers.back());
@@ -159,7 +198,7 @@ void Florb::nextFlower() {
         currentFlower = 0;
 
         // If the transition order is random, re-shuffle the collection
-        if (configs->getTransitionOrder() == FlorbConfigs::TransitionOrder::RANDOM) {
+        if (snapshot->transitionOrder == FlorbConfigs::TransitionOrder::RANDOM) {
             bool shuffled(false);
 
             while(shuffled == false) {
@@ -178,38 +217,112 @@ void Florb::nextFlower() {
 }
 
 
+bool Florb::isLoading() const {
+    return (loadFlower < flowers.size());
+}
+
+
 // Render frame method
 
-void Florb::renderFrame(bool transition) {
+void Florb::renderFrame() {
     extern int screenWidth;
     extern int screenHeight;
     static bool firstFrame(true);
     
     FlorbUtils::glCheck("renderFrame()");
 
-    if (!glXGetCurrentContext()) {
-        cerr << "[renderFrame()] OpenGL context is not current" << endl;
+    // Adopt the latest published configuration snapshot for this frame,
+    // re-describing GPU-evaluated motions only when the configs change
+    {
+        FrameProfiler::Scope scope(*profiler, CONFIGS_STAGE);
+
+        if (configs->refresh(snapshot)) {
+            recorder->addEvent("config change", snapshot->version);
+
+            // A reloaded or replayed configuration brings its own cameras
+            // and spotlights; one without cameras keeps viewing through the last
+            if (!snapshot->cameras.empty()) cameras = snapshot->cameras;
+            spotlights = snapshot->spotlights;
+
+            updateMotionDescriptors();
+
+            if (snapshot->imageSwitch != imageSwitchPeriod) scheduleImageSwitch();
+        }
     }
 
+    // Fire any timed events which have come due, such as image switches
+    {
+        FrameProfiler::Scope scope(*profiler, TIMELINE_STAGE);
+        timeline.advance();
+    }
+
+    bool transition(transitionPending);
+    transitionPending = false;
+
     // Perform one-time initialization upon the first frame
     if (firstFrame) {
+        FrameProfiler::Scope scope(*profiler, SPHERE_STAGE);
+        GLDebug::Group group("sphere");
+
+        // Asking the window system may wait on it, so is done only once
+        if (!FlorbUtils::hasCurrentContext()) {
+            cerr << "[renderFrame()] OpenGL context is not current" << endl;
+        }
+
         // Initialize the sphere
-        auto smoothness(configs->getSmoothness());
+        auto smoothness(snapshot->smoothness);
         initSphere(smoothness, (smoothness / 2));
 
+        // Geometry is a unit sphere, scaled and offset by the vertex shader
+        generateSphere(1.0f, smoothness, (smoothness / 2));
+
         // Begin loading flower images
         loadFlower = 0UL;
-        if (flowers.empty() == false) {
-            flowers[loadFlower++]->loadImage();
+    }
+
+    // Load flower images one at a time
+    if (loadFlower < flowers.size()) {
+        FrameProfiler::Scope scope(*profiler, TEXTURES_STAGE);
+        GLDebug::Group group("texture upload");
+        flowers[loadFlower++]->loadImage();
+        recorder->addEvent("texture upload", (loadFlower - 1));
+
+        if (Tracer::isEnabled()) {
+            double textureBytes(0.0);
+            for (auto i = 0U; i < loadFlower; i++) {
+                textureBytes += (static_cast<double>(flowers[i]->getWidth()) *
+                                 flowers[i]->getHeight() *
+                                 flowers[i]->getChannels());
+            }
+
+            Tracer::counter("texture_bytes", textureBytes);
+            Tracer::counter("flower_queue", (flowers.size() - loadFlower));
         }
-    } else {
-        // Load flower images one at a time
-        if (loadFlower < flowers.size())
-            flowers[loadFlower++]->loadImage();
+    }
+
+    // Adopt any hot-reloaded shader program, then bind it for this frame
+    {
+        FrameProfiler::Scope scope(*profiler, SHADERS_STAGE);
+        GLDebug::Group group("shaders");
+
+        bool reloaded(shaders->update());
+        uniforms->update();
+
+        // A program built with new motion expressions may now be live
+        if (reloaded) {
+            recorder->addEvent("shader reload");
+            updateMotionDescriptors();
+        }
+
+        glUseProgram(shaders->getProgram());
+        FlorbUtils::glCheck("glUseProgram");
     }
 
     // Update physical effects
-    updatePhysicalEffects(transition);
+    {
+        FrameProfiler::Scope scope(*profiler, PHYSICS_STAGE);
+        updatePhysicalEffects(transition);
+    }
     
     // Set a dark gray background color for the window
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -219,7 +332,7 @@ void Florb::renderFrame(bool transition) {
     glDisable(GL_CULL_FACE);
 
     // Set either line or fill rendering
-    if (configs->getRenderMode() == FlorbConfigs::RenderMode::LINE) {
+    if (snapshot->renderMode == FlorbConfigs::RenderMode::LINE) {
         glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
     } else {
         glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
@@ -237,16 +350,14 @@ void Florb::renderFrame(bool transition) {
         previousTexture = flowers[previousFlower]->getTextureID();
         currentTexture = flowers[currentFlower]->getTextureID();
     }
-    
-    if (!glIsTexture(currentTexture))
+
+    // A flower which failed to load has no texture; glIsTexture would ask the driver
+    if (currentTexture == 0)
         cerr << "[WARN] Texture ID ("
              << currentTexture
              << ") is not valid"
              << endl;
 
-    glUseProgram(shaderProgram);
-    FlorbUtils::glCheck("glUseProgram");
-    
     // Projection and view matrices
     float aspect = static_cast<float>(screenWidth) / static_cast<float>(screenHeight);
     glm::mat4 projection = glm::perspective(glm::radians(45.0f), aspect, 0.1f, 100.0f);
@@ -255,172 +366,103 @@ void Florb::renderFrame(bool transition) {
                                  glm::vec3(0.0f, 1.0f, 0.0f));
     glm::mat4 projView = projection * view;
 
-    // Set the uniform once per frame
-    int projViewLoc = glGetUniformLocation(shaderProgram, "projView");
-    glUniformMatrix4fv(projViewLoc, 1, GL_FALSE, glm::value_ptr(projView));
-    FlorbUtils::glCheck("glUniformMatrix4fv()");
+    {
+        GLDebug::Group group("uniforms");
 
+        auto uniformsStart(FrameProfiler::now());
 
-    // Use texture units zero and one for current and previous flowers
-    GLuint previousTextureLoc = glGetUniformLocation(shaderProgram, "previousTexture");
-    GLuint currentTextureLoc = glGetUniformLocation(shaderProgram, "currentTexture");
-    glUniform1i(previousTextureLoc, 0);
-    glUniform1i(currentTextureLoc, 1);
+        // Per-frame uniforms, each only re-sent when its value changes
+        frameUniforms.projView.set(projView);
 
+        // Use texture units zero and one for current and previous flowers
+        frameUniforms.previousTexture.set(0);
+        frameUniforms.currentTexture.set(1);
 
-    // Set screen resolution uniform
-    GLuint resolutionLoc = glGetUniformLocation(shaderProgram, "resolution");
-    glUniform2f(resolutionLoc, screenWidth, screenHeight);
+        frameUniforms.resolution.set(glm::vec2(screenWidth, screenHeight));
+        frameUniforms.aspectRatio.set(aspect);
 
+        frameUniforms.offset.set(glm::vec2(snapshot->offsetX, snapshot->offsetY));
 
-    // Set screen aspect ratio uniform
-    GLuint aspectRatioLoc = glGetUniformLocation(shaderProgram, "aspectRatio");
-    glUniform1f(aspectRatioLoc, aspect);
-    
-    
-    // Set offset and radius uniforms
-    GLuint offsetLoc = glGetUniformLocation(shaderProgram, "offset");
-    GLuint radiusLoc = glGetUniformLocation(shaderProgram, "radius");
 
-    auto center(configs->getCenter());
-    glUniform2f(offsetLoc, center.first, center.second);
-    glUniform1f(radiusLoc, configs->getRadius());
-    
+        // Spotlight uniform block
+        auto &lights(lightsBlock->edit());
+        int lightCount(min(spotlights.size(), static_cast<size_t>(k_MaxLights)));
+        lights.lightCount = lightCount;
+        lights.shininess = snapshot->shininess;
 
-    // Camera uniforms
-    GLuint viewPosLoc = glGetUniformLocation(shaderProgram, "viewPos");
-    GLuint zoomLoc = glGetUniformLocation(shaderProgram, "zoom");
-    
-    const auto &cameraView(cameras[0]->getView());
-    glUniform3f(viewPosLoc,
-                cameraView[0],
-                cameraView[1],
-                cameraView[2]);
+        for (int i = 0; i < lightCount; ++i) {
+            auto spotlight(spotlights[i]->getState());
 
-    glUniform1f(zoomLoc, cameras[0]->getZoom());
+            const auto &direction(spotlight.direction);
 
-    
-    // Set light uniforms
-    int lightCount(spotlights.size());
-    glUniform1i(glGetUniformLocation(shaderProgram, "lightCount"), lightCount);
+            float alpha = direction[0];
+            float beta  = direction[1];
 
-    // Iterate through all spotlights
-    for (int i = 0; i < lightCount; ++i) {
-        const auto& spotlight = spotlights[i];
-    
-        string base = "spotlights[" + to_string(i) + "].";
+            glm::vec3 dir;
+            dir.x = cos(alpha) * cos(beta);
+            dir.y = sin(beta);
+            dir.z = sin(alpha) * cos(beta);
 
-        const auto &direction(spotlight->getDirection());
-        
-        float alpha = direction[0];
-        float beta  = direction[1];
-
-        glm::vec3 dir;
-        dir.x = cos(alpha) * cos(beta);
-        dir.y = sin(beta);
-        dir.z = sin(alpha) * cos(beta);
-        dir = glm::normalize(dir);
-        
-        const auto &spotlightColor(spotlight->getColor());
-        glUniform3f(glGetUniformLocation(shaderProgram, (base + "direction").c_str()),
-                    dir.x,
-                    dir.y,
-                    dir.z);
-        glUniform3f(glGetUniformLocation(shaderProgram, (base + "color").c_str()),
-                    spotlightColor[0],
-                    spotlightColor[1],
-                    spotlightColor[2]);
-        glUniform1f(glGetUniformLocation(shaderProgram, (base + "intensity").c_str()),
-                    spotlight->getIntensity());
-    }
+            lights.spotlights[i].direction = glm::normalize(dir);
+            lights.spotlights[i].color = spotlight.color;
+            lights.spotlights[i].intensity = spotlight.intensity;
+        }
 
-    
-    // Set specular reflection uniforms
-    GLuint shininessLoc = glGetUniformLocation(shaderProgram, "shininess");
-    GLuint anisotropyEnabledLoc = glGetUniformLocation(shaderProgram, "anisotropyEnabled");
-    GLuint anisotropyStrengthLoc = glGetUniformLocation(shaderProgram, "anisotropyStrength");
-    GLuint anisotropySharpnessLoc = glGetUniformLocation(shaderProgram, "anisotropySharpness");
-    glUniform1f(shininessLoc, configs->getShininess());
-    glUniform1i(anisotropyEnabledLoc, configs->getAnisotropyEnabled());
-    glUniform1f(anisotropyStrengthLoc, configs->getAnisotropyStrength());
-    glUniform1f(anisotropySharpnessLoc, configs->getAnisotropySharpness());
-
-    // Set debug uniforms
-    GLuint anisotropicDebugLoc = glGetUniformLocation(shaderProgram, "anisotropicDebug");
-    GLuint specularDebugLoc = glGetUniformLocation(shaderProgram, "specularDebug");
-    
-    int anisotropicDebug;
-    if (configs->getAnisotropicMode() == FlorbConfigs::AnisotropicMode::NORMAL) {
-        anisotropicDebug = 0;
-    } else {
-        anisotropicDebug = 1;
-    }
-    glUniform1i(anisotropicDebugLoc, anisotropicDebug);
-    
-    int specularDebug;
-    if (configs->getSpecularMode() == FlorbConfigs::SpecularMode::NORMAL) {
-        specularDebug = 0;
-    } else {
-        specularDebug = 1;
-    }
-    glUniform1i(specularDebugLoc, specularDebug);
+        lightsBlock->upload();
 
 
-    // Set rim lighting uniforms
-    GLuint rimColorLoc = glGetUniformLocation(shaderProgram, "rimColor");
-    GLuint rimExponentLoc = glGetUniformLocation(shaderProgram, "rimExponent");
-    GLuint rimStrengthLoc = glGetUniformLocation(shaderProgram, "rimStrength");
-    glUniform3f(rimColorLoc,
-                animatedRimColor[0],
-                animatedRimColor[1],
-                animatedRimColor[2]);
-    glUniform1f(rimExponentLoc, configs->getRimExponent());
-    glUniform1f(rimStrengthLoc, configs->getRimStrength());
+        // Effects uniform block
+        auto &effects(effectsBlock->edit());
 
+        // Specular reflections
+        effects.anisotropyEnabled = snapshot->anisotropyEnabled;
+        effects.anisotropyStrength = snapshot->anisotropyStrength;
+        effects.anisotropySharpness = snapshot->anisotropySharpness;
 
-    // Set vignette uniforms
-    GLuint vignetteRadiusLoc = glGetUniformLocation(shaderProgram, "vignetteRadius");
-    GLuint vignetteExponentLoc = glGetUniformLocation(shaderProgram, "vignetteExponent");
-    glUniform1f(vignetteRadiusLoc, configs->getVignetteRadius());
-    glUniform1f(vignetteExponentLoc, configs->getVignetteExponent());
+        // Debug modes
+        effects.anisotropicDebug =
+            (snapshot->anisotropicMode == FlorbConfigs::AnisotropicMode::NORMAL) ? 0 : 1;
+        effects.specularDebug =
+            (snapshot->specularMode == FlorbConfigs::SpecularMode::NORMAL) ? 0 : 1;
 
+        // Rim lighting
+        effects.rimColor = animatedRimColor;
+        effects.rimExponent = snapshot->rimExponent;
 
-    // Set iridescence uniforms
-    GLuint iridescenceStrengthLoc = glGetUniformLocation(shaderProgram, "iridescenceStrength");
-    GLuint iridescenceFrequencyLoc = glGetUniformLocation(shaderProgram, "iridescenceFrequency");
-    GLuint iridescenceShiftLoc = glGetUniformLocation(shaderProgram, "iridescenceShift");
-    glUniform1f(iridescenceStrengthLoc, configs->getIridescenceStrength());
-    glUniform1f(iridescenceFrequencyLoc, configs->getIridescenceFrequency());
-    glUniform1f(iridescenceShiftLoc, configs->getIridescenceShift());
+        // Vignette, whose radius follows the breathing radius in the shader
+        effects.vignetteExponent = snapshot->vignetteExponent;
 
-    
-    // Dust mote uniforms
-    GLuint moteCountLoc = glGetUniformLocation(shaderProgram, "moteCount");
-    GLuint motesRadiiLoc = glGetUniformLocation(shaderProgram, "motesRadii");
-    GLuint motesSpeedsLoc = glGetUniformLocation(shaderProgram, "motesSpeeds");
-    GLuint motesCentersLoc = glGetUniformLocation(shaderProgram, "motesCenters");
-    GLuint motesAmplitudesLoc = glGetUniformLocation(shaderProgram, "motesAmplitudes");
-    GLuint motesColorLoc = glGetUniformLocation(shaderProgram, "motesColor");
-    glUniform1i(moteCountLoc, moteCount);
-    glUniform1fv(motesRadiiLoc, motesRadii.size(), motesRadii.data());
-    glUniform1fv(motesSpeedsLoc, motesSpeeds.size(), motesSpeeds.data());
-    glUniform2fv(motesCentersLoc, motesCenters.size(), motesCenters.data());
-    glUniform1fv(motesAmplitudesLoc, motesAmplitudes.size(), motesAmplitudes.data());
-    glUniform3f(motesColorLoc, motesColor[0], motesColor[1], motesColor[2]);
-
-
-    // Flutter wave uniforms
-    GLuint waveAmplitudeLoc = glGetUniformLocation(shaderProgram, "waveAmplitude");
-    GLuint waveFrequencyLoc = glGetUniformLocation(shaderProgram, "waveFrequency");
-    GLuint waveSpeedLoc = glGetUniformLocation(shaderProgram, "waveSpeed");
-    glUniform1f(waveAmplitudeLoc, configs->getFlutterAmplitude());
-    glUniform1f(waveFrequencyLoc, configs->getFlutterFrequency());
-    glUniform1f(waveSpeedLoc, configs->getFlutterSpeed());
-
-
-    // Bounce offset uniform
-    GLuint bounceOffsetLoc = glGetUniformLocation(shaderProgram, "bounceOffset");
-    glUniform1f(bounceOffsetLoc, bounceOffset);
+        // Iridescence
+        effects.iridescenceStrength = snapshot->iridescenceStrength;
+        effects.iridescenceFrequency = snapshot->iridescenceFrequency;
+        effects.iridescenceShift = snapshot->iridescenceShift;
+
+        // Flutter wave
+        effects.waveAmplitude = snapshot->flutterAmplitude;
+        effects.waveFrequency = snapshot->flutterFrequency;
+        effects.waveSpeed = snapshot->flutterSpeed;
+
+        effectsBlock->upload();
+
+
+        // Dust mote uniform block
+        auto &motes(motesBlock->edit());
+        // Motes are allocated once; a lower configured count draws fewer of them
+        motes.moteCount = min(moteCount, snapshot->moteCount);
+        motes.motesColor = glm::vec3(motesColor[0], motesColor[1], motesColor[2]);
+
+        for (auto i = 0UL; i < moteCount; i++) {
+            motes.motes[i] = glm::vec4(motesCenters[2 * i],
+                                       motesCenters[(2 * i) + 1],
+                                       motesRadii[i],
+                                       motesSpeeds[i]);
+            motes.motesAmplitudes[i] = motesAmplitudes[i];
+        }
+
+        motesBlock->upload();
+
+        profiler->endStage(UNIFORMS_STAGE, uniformsStart);
+    }
 
     
     // Activate textures
@@ -430,18 +472,35 @@ void Florb::renderFrame(bool transition) {
     glBindTexture(GL_TEXTURE_2D, currentTexture);
 
     
-    glBindVertexArray(vao);
-    FlorbUtils::glCheck("glBindVertexArray(vao)");
+    // Sample time and interaction state as late as possible
+    latchUniforms();
+
+    {
+        FrameProfiler::Scope scope(*profiler, DRAW_STAGE);
+        FrameProfiler::GpuScope gpuScope(*profiler, DRAW_STAGE);
+        GLDebug::Group group("draw orb");
 
-    glDrawElements(GL_TRIANGLE_STRIP, indexCount, GL_UNSIGNED_INT, 0);
-    FlorbUtils::glCheck("glDrawElements()");
+        glBindVertexArray(vao);
+        FlorbUtils::glCheck("glBindVertexArray(vao)");
+
+        glDrawElements(GL_TRIANGLE_STRIP, indexCount, GL_UNSIGNED_INT, 0);
+        FlorbUtils::glCheck("glDrawElements()");
+
+        // Close the decode, upload and display flow of a newly shown flower
+        if (!flowers.empty() and (loadFlower >= flowers.size())) {
+            flowers[currentFlower]->markDisplayed();
+        }
     
-    glBindVertexArray(0);
-    FlorbUtils::glCheck("glBindVertexArray(0) - A");
+        glBindVertexArray(0);
+        FlorbUtils::glCheck("glBindVertexArray(0) - A");
+    }
 
     // Flush the OpenGL pipeline
     glFlush();
 
+    uniforms->endFrame();
+    if (snapshot->uniformStats) reportUniformStats();
+
     firstFrame = false;
 }
 
@@ -451,7 +510,7 @@ void Florb::renderFrame(bool transition) {
 // Load flowers method
 
 void Florb::loadFlowers() {
-    const auto &imagePaths(configs->getImagePaths());
+    const auto &imagePaths(snapshot->imagePaths);
 
     // Iterate through the image paths, precomputing the total number of flower images
     uint32_t numFlowers(0UL);
@@ -484,7 +543,7 @@ void Florb::loadFlowers() {
             }
         
             // Determine the ordering mode to use for the Flowers
-            if (configs->getTransitionOrder() == FlorbConfigs::TransitionOrder::ALPHABETICAL) {
+            if (snapshot->transitionOrder == FlorbConfigs::TransitionOrder::ALPHABETICAL) {
                 // Sort the collection of Flowers by filename
                 sort(flowers.begin(),
                      flowers.end(),
@@ -502,24 +561,38 @@ void Florb::loadFlowers() {
 }
 
 
-// Flower transition update method
+// Flower transition methods
 
-void Florb::updateTransition(bool transition, float timeSeconds) {
-    auto transitionMode(configs->getTransitionMode());
-
-    if (transition) transitionStart = timeSeconds;
+void Florb::updateTransition(Timeline::Duration now) {
+    auto transitionMode(snapshot->transitionMode);
 
     float progress;
     if (transitionMode == FlorbConfigs::TransitionMode::BLEND) {
         // Compute transition progress
-        progress = ((timeSeconds - transitionStart) / configs->getTransitionTime());
+        progress = (Timeline::toSeconds(now - transitionStart) / snapshot->transitionTime);
     } else {
         // Progress completes immediately
         progress = 1.0f;
     }
         
-    GLuint transitionProgressLoc = glGetUniformLocation(shaderProgram, "transitionProgress");
-    glUniform1f(transitionProgressLoc, progress);
+    frameUniforms.transitionProgress.set(progress);
+}
+
+void Florb::scheduleImageSwitch() {
+    if (imageSwitchEvent != 0UL) timeline.cancel(imageSwitchEvent);
+    imageSwitchEvent = 0UL;
+
+    imageSwitchPeriod = snapshot->imageSwitch;
+    if (imageSwitchPeriod <= 0.0f) return;
+
+    // Switches fall on a fixed grid from now on, so they never drift
+    auto period(Timeline::fromSeconds(imageSwitchPeriod));
+    imageSwitchEvent = timeline.scheduleEvery((timeline.getTime() + period),
+                                              period,
+                                              [this](Timeline::Duration) {
+                                                  nextFlower();
+                                                  transitionPending = true;
+                                              });
 }
 
 
@@ -529,19 +602,22 @@ void Florb::initSphere(int sectorCount, int stackCount) {
     // Generate and bind the vertex array
     glGenVertexArrays(1, &vao);
     glBindVertexArray(vao);
+    GLDebug::label(GL_VERTEX_ARRAY, vao, "sphere");
 
     // Allocate vertex buffer
     int numVertices((stackCount + 1) * (sectorCount + 1));
     glGenBuffers(1, &vbo);
     glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ARRAY_BUFFER, numVertices * sizeof(Vertex), nullptr, GL_DYNAMIC_DRAW);
+    GLDebug::label(GL_BUFFER, vbo, "sphere vertices");
+    glBufferData(GL_ARRAY_BUFFER, numVertices * sizeof(Vertex), nullptr, GL_STATIC_DRAW);
     FlorbUtils::glCheck("glBufferData(GL_ARRAY_BUFFER)");
 
     // Allocate index buffer
     int numIndices(stackCount * (sectorCount + 1) * 2);
     glGenBuffers(1, &ebo);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, numIndices * sizeof(GLuint), nullptr, GL_DYNAMIC_DRAW);
+    GLDebug::label(GL_BUFFER, ebo, "sphere indices");
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, numIndices * sizeof(GLuint), nullptr, GL_STATIC_DRAW);
     FlorbUtils::glCheck("glBufferData(GL_ELEMENT_ARRAY_BUFFER)");
 }
 
@@ -611,374 +687,57 @@ void Florb::generateSphere(float radius, int sectorCount, int stackCount) {
 // Shader program initialization
 
 void Florb::initShaders() {
-    const char* vertexShaderSource = R"glsl(
-        #version 330 core
-        layout (location = 0) in vec3 aPos;
-        
-        out vec2 fragUV;
-        out vec3 fragPos;
-        out vec3 fragNormal;
-
-        uniform float bounceOffset;
-
-        uniform vec2 resolution;
-
-        void main()
-        {
-            // Bounce offset addition
-            vec3 pos = aPos + vec3(0.0, bounceOffset, 0.0);
-        
-            // Aspect ratio correction
-            pos.x *= resolution.y / resolution.x;
-
-            // Assign fragment position and normal
-            fragPos = aPos;
-            fragNormal = normalize(pos);
-
-            // Generate spherical UV coordinates
-            vec3 dir = normalize(aPos);
-            fragUV.x = atan(dir.z, dir.x) / (2.0 * 3.14159265) + 0.5;
-            fragUV.y = asin(dir.y) / 3.14159265 + 0.5;
-        
-            gl_Position = vec4(pos, 1.0);
-        }
-    )glsl";
+    shaders = make_shared<ShaderProgram>(snapshot->vertexShaderPath,
+                                         snapshot->fragmentShaderPath,
+                                         snapshot->shaderHotReload);
 
-    const char* fragmentShaderSource = R"glsl(
-        #version 330 core
-        in vec2 fragUV;
-        in vec3 fragPos;
-        in vec3 fragNormal;
+    // Expression motions are compiled into the shaders, so precede the first build
+    shaders->setPrelude(compileMotionExpressions());
+    shaders->build();
 
-        out vec4 FragColor;
-
-        #define PI 3.141592654
-
-        uniform float time;
-
-        uniform vec2 resolution;
-        uniform float aspectRatio;
-
-        uniform vec2 offset;
-        uniform float zoom;
-        uniform float radius;
-
-        uniform int anisotropyEnabled;
-        uniform float anisotropyStrength;
-        uniform float anisotropySharpness;
-
-        #define MAX_MOTES 256
-        uniform int moteCount;
-        uniform float motesRadii[MAX_MOTES];
-        uniform float motesSpeeds[MAX_MOTES];
-        uniform vec2 motesCenters[MAX_MOTES];
-        uniform float motesAmplitudes[MAX_MOTES];
-        uniform vec3 motesColor;
-
-        uniform vec3 rimColor;
-        uniform float rimExponent;
-        uniform float rimStrength;
-        
-        uniform float vignetteRadius;
-        uniform float vignetteExponent;
-
-        uniform float iridescenceStrength;
-        uniform float iridescenceFrequency;
-        uniform float iridescenceShift;
-
-        #define MAX_LIGHTS 4
-        
-        struct Spotlight {
-            vec3 direction;
-            vec3 color;
-            float intensity;
-        };
-        
-        uniform Spotlight spotlights[MAX_LIGHTS];
-        uniform int lightCount;
-
-        uniform vec3 viewPos;
-        uniform float shininess;
-
-        uniform float waveAmplitude;
-        uniform float waveFrequency;
-        uniform float waveSpeed;
-
-        uniform sampler2D currentTexture;
-        uniform sampler2D previousTexture;
-        uniform float transitionProgress;
-
-        uniform int anisotropicDebug;
-        uniform int specularDebug;
-
-        // uniform float loadProgress;
-        // uniform int showProgressBar;
-        #define loadProgress 0.5
-        #define showProgressBar 1
-        
-        void drawStatusBar(inout vec4 FragColor, vec2 screenUV, vec2 resolution) {
-            if ((showProgressBar == 0) || loadProgress >= 1.0) return;
-            
-            // Bar dimensions (relative)
-            float barWidth = 0.90;
-            float barHeight = 0.03;
-            float radius = 0.015;
-            
-            // Vertically centered
-            vec2 center = vec2(0.5, 0.5);
-            vec2 halfSize = vec2(barWidth * 0.5, barHeight * 0.5);
-            vec2 uv = screenUV;
-            
-            // Relative to bar center
-            vec2 d = abs(uv - center) - halfSize;
-            
-            // Rounded rectangle mask
-            float dist = length(max(d, 0.0)) - radius;
-            float alpha = smoothstep(0.005, 0.0, dist);
-            
-            // Progress mask
-            float progressRight = center.x - halfSize.x + barWidth * loadProgress;
-            float inProgress = step(uv.x, progressRight);
-            
-            vec3 barColor = vec3(0.0, 0.8, 0.0); // Solid green
-            
-            // Composite blend
-            FragColor.rgb = mix(FragColor.rgb, barColor, alpha * inProgress);
-        }
-
-        
-        void main() {
-
-            // Obtain a normalized direction vector from the fragment shader
-            vec3 dir = normalize(fragPos);
-
-            // Use spherical coordinates to modulate wave phase
-            float wavePhase =
-                ((dot(dir, vec3(1.0, 0.0, 0.0)) * waveFrequency) - (time * waveSpeed));
-
-            // Sine-based displacement along a direction (e.g. vertical in UV space)
-            vec2 waveOffset = vec2(0.0, sin(wavePhase) * waveAmplitude);
-
-            // Convert fragment direction to spherical UV coordinates
-            vec2 uv;
-            uv.x = atan(dir.z, dir.x) / (2.0 * PI) + 0.5;
-            uv.y = asin(dir.y) / PI + 0.5;
-
-            // Apply zoom and offset after spherical conersion, flipping vertically
-            uv = (uv - 0.5) * zoom + 0.5 + offset;
-            uv.y = 1.0 - uv.y;
-
-            // Apply aspect ratio correction centered on (0.5, 0.5)
-            uv.x = (uv.x - 0.5) * aspectRatio + 0.5;
-            
-            // Clamp to avoid oversampling outside the texture
-            uv = clamp(uv, vec2(0.0), vec2(1.0));
-
-            // Apply displacement to UVs before texture sampling
-            uv += waveOffset;
-            uv = clamp(uv, vec2(0.0), vec2(1.0));
-
-            // Discard any pixel locations beyond the radius of the sphere
-            if (length(fragPos) > radius)
-                discard;
-
-
-            // Dust mote contributions
-            float moteGlow = 0.0;
-            float dust = 0.0;
-            for (int i = 0; i < moteCount; ++i) {
-                float speed = motesSpeeds[i];
-                float radius = motesRadii[i] / resolution.y;
-            
-                // Wobbling orbit using sin/cos with time
-                float wobbleX = sin(time * speed);
-                float wobbleY = cos(time * speed * 0.5);
-            
-                vec2 orbitOffset = vec2(wobbleX, wobbleY) * 0.01;
-
-                // Map [-1,1] to [0,1]
-                vec2 motePos = (motesCenters[i] * 0.5 + 0.5);
-                motePos += orbitOffset;
-            
-                float dist = distance(uv, motePos);
-                float alpha = smoothstep(radius, 0.0, dist);
-
-                dust += motesAmplitudes[i] * alpha;
-            }
-
-            // Aspect-corrected center-relative coords
-            vec2 screenUV = gl_FragCoord.xy / resolution;
-            vec2 centered = screenUV - vec2(0.5);
-            centered.x *= resolution.x / resolution.y;
-
-
-            // Diffuse lighting
-            vec3 norm = normalize(fragNormal);
-
-
-            // Spotlighting
-            vec3 totalLighting = vec3(0.0);
-            vec3 viewDir = normalize(viewPos - fragPos);
-            float totalSpecular = 0.0;
-            vec3 anisotropicColor = vec3(0.0);
-            for (int i = 0; i < lightCount; ++i) {
-                vec3 lightDir = normalize(-spotlights[i].direction);
-                vec3 reflectDir = reflect(-lightDir, norm);
-            
-                float diff = max(dot(norm, lightDir), 0.0);
-                float spec = pow(max(dot(viewDir, reflectDir), 0.0), shininess);
-                totalSpecular += spec;
-            
-                vec3 lightColor = spotlights[i].color * spotlights[i].intensity;
-                vec3 lighting = (diff + spec) * lightColor;
-
-                anisotropicColor += lightColor;
-            
-                totalLighting += lighting;
-            }
-
-            // Average the spotlight colors to produce the anisotropic color
-            if (lightCount > 0) anisotropicColor /= lightCount;
-
-
-            // Anisotropic specular reflections
-            vec3 anisotropicLightDir = -spotlights[0].direction;
-            vec3 anisotropicN = normalize(fragNormal);
-            vec3 anisotropicT = normalize(dFdx(fragPos));
-            vec3 anisotropicB = normalize(dFdy(fragPos));
-            vec3 tangent = normalize(anisotropicT - norm * dot(norm, anisotropicT));
-            vec3 bitangent = cross(norm, tangent);
-            
-            // Simulate using a modified Blinn-Phong calculation
-            vec3 anisotropicH = normalize(viewDir + anisotropicLightDir);
-            float dotTH = dot(tangent, anisotropicH);
-            float dotNH = dot(norm, anisotropicH);
-            
-            float th2 = (dotTH * dotTH);
-            float anisotropicFactor = pow(max(th2, 0.0001), anisotropySharpness);
-            float anisotropicSpec = pow(max(dotNH, 0.0), shininess) * anisotropicFactor;
-            
-            vec3 specularColor = (anisotropicColor * pow(max(dotNH, 0.0), shininess) *
-                                  anisotropicFactor * anisotropyStrength * 10.0);
-
-
-            // Calculate rim lighting
-            float rim = pow(1.0 - max(dot(viewDir, normalize(fragNormal)), 0.0), rimExponent);
-            vec3 rimLight = rimStrength * rim * rimColor;
-
-
-            // Vignette effect
-            float radial = length(centered);
-            float fadeStart = 1.0 - vignetteRadius;
-            float fadeEnd = 1.0;
-            
-            float vignette = 1.0;
-            if (radial > fadeStart) {
-                float t = (radial - fadeStart) / (fadeEnd - fadeStart);
-                vignette = 1.0 - clamp(pow(t, vignetteExponent), 0.0, 1.0);
-            }
-
-
-            // Iridescence effect
-            vec3 iridescenceN = normalize(fragNormal);
-            vec3 iridescenceV = normalize(viewPos - fragPos);
-            float angle = dot(iridescenceN, iridescenceV);
-
-            float facing = clamp(1.0 - angle, 0.0, 1.0);
-            float iridescence = sin(facing * iridescenceFrequency + iridescenceShift);
-            iridescence = 0.5 + 0.5 * iridescence;
-
-            vec3 shimmerColor = vec3(
-                0.5 + 0.5 * sin(6.2831 * iridescence + 0.0),
-                0.5 + 0.5 * sin(6.2831 * iridescence + 2.0),
-                0.5 + 0.5 * sin(6.2831 * iridescence + 4.0)
-            );
-
-
-            // Sample texture colors
-            vec4 colorPrev = texture(previousTexture, uv);
-            vec4 colorCurr = texture(currentTexture, uv);
-            
-            vec4 texColor = mix(colorPrev, colorCurr, clamp(transitionProgress, 0.0, 1.0));
-
-            // Compute final color
-            vec3 finalColor = vignette * totalLighting * texColor.rgb;
-
-            if (anisotropyEnabled == 1) finalColor += specularColor;
-
-            finalColor += rimLight;
-
-            // Clamp and overlay colored dust mote glow
-            finalColor += clamp(dust, 0.0, 1.0) * motesColor;
-
-            // Incorporate iridescence
-            finalColor.rgb = mix(finalColor.rgb, shimmerColor, iridescenceStrength);
-
-
-            // Assign final color, taking debug modes into account
-            if (anisotropicDebug == 1) {
-               FragColor = vec4(specularColor, 1.0);
-            } else if (specularDebug == 1) {
-               FragColor = vec4(vec3(totalSpecular), 1.0);
-            } else {
-                FragColor = vec4(finalColor, 1.0);
-            }
-
-            // Update the status bar
-            drawStatusBar(FragColor, screenUV, resolution);
-        }
-    )glsl";
-
-    GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    if (vertexShader == 0) {
-        cerr << "glCreateShader(GL_VERTEX_SHADER) failed — returned 0 (invalid handle)" << endl;
-    }
-    glShaderSource(vertexShader, 1, &vertexShaderSource, nullptr);
-    glCompileShader(vertexShader);
-    GLint vertexStatus = 0;
-    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &vertexStatus);
-    if (vertexStatus != GL_TRUE) {
-        char infoLog[2048];
-        glGetShaderInfoLog(vertexShader, sizeof(infoLog), nullptr, infoLog);
-        cerr << "[Vertex Shader Compile Error]\n" << infoLog << endl;
-    }
-    FlorbUtils::glCheck("glCompileShader(vertexShader)");
+    initUniforms();
+}
 
+void Florb::initUniforms() {
+    uniforms = make_shared<ShaderUniforms>(shaders);
+
+    frameUniforms.time = uniforms->get<GLfloat>("time");
+    frameUniforms.projView = uniforms->get<glm::mat4>("projView");
+    frameUniforms.resolution = uniforms->get<glm::vec2>("resolution");
+    frameUniforms.aspectRatio = uniforms->get<GLfloat>("aspectRatio");
+    frameUniforms.offset = uniforms->get<glm::vec2>("offset");
+    frameUniforms.viewPos = uniforms->get<glm::vec3>("viewPos");
+    frameUniforms.zoom = uniforms->get<GLfloat>("zoom");
+    frameUniforms.transitionProgress = uniforms->get<GLfloat>("transitionProgress");
+    frameUniforms.previousTexture = uniforms->get<GLint>("previousTexture");
+    frameUniforms.currentTexture = uniforms->get<GLint>("currentTexture");
+
+    motionsBlock = uniforms->getBlock<MotionsBlock>("Motions");
+    lightsBlock = uniforms->getBlock<LightsBlock>("Lights");
+    effectsBlock = uniforms->getBlock<EffectsBlock>("Effects");
+    motesBlock = uniforms->getBlock<MotesBlock>("Motes");
+
+    updateMotionDescriptors();
+}
 
-    GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    if (fragmentShader == 0) {
-        cerr << "glCreateShader(GL_FRAGMENT_SHADER) failed — returned 0 (invalid handle)" << endl;
-    }
-    glShaderSource(fragmentShader, 1, &fragmentShaderSource, nullptr);
-    glCompileShader(fragmentShader);
-    GLint fragmentStatus = 0;
-    glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &fragmentStatus);
-    if (fragmentStatus != GL_TRUE) {
-        char infoLog[2048];
-        glGetShaderInfoLog(fragmentShader, sizeof(infoLog), nullptr, infoLog);
-        cerr << "[Fragment Shader Compile Error]\n" << infoLog << endl;
-    }
-    FlorbUtils::glCheck("glCompileShader(fragmentShader)");
+void Florb::reportUniformStats() {
+    uniformStatsFrames++;
+    uniformStatsCalls += uniforms->getFrameCalls();
+    uniformStatsUploads += uniforms->getFrameUploads();
+
+    // Report averages roughly once per second of frames
+    if (uniformStatsFrames >= snapshot->videoFrameRate) {
+        cout << "[INFO] Uniform calls per frame : "
+             << (static_cast<float>(uniformStatsCalls) / uniformStatsFrames)
+             << " ("
+             << (static_cast<float>(uniformStatsUploads) / uniformStatsFrames)
+             << " block uploads)"
+             << endl;
 
-    
-    // Create and link the full program from its constituents
-    shaderProgram = glCreateProgram();
-    glAttachShader(shaderProgram, vertexShader);
-    glAttachShader(shaderProgram, fragmentShader);
-    glLinkProgram(shaderProgram);
-    GLint linkStatus = 0;
-    glGetProgramiv(shaderProgram, GL_LINK_STATUS, &linkStatus);
-    if (linkStatus != GL_TRUE) {
-        char log[2048];
-        glGetProgramInfoLog(shaderProgram, sizeof(log), nullptr, log);
-        cerr << "Shader Link Error:\n" << log << endl;
+        uniformStatsFrames = 0U;
+        uniformStatsCalls = 0UL;
+        uniformStatsUploads = 0UL;
     }
-    FlorbUtils::glCheck("glLinkProgram()");
-
-
-    // Free the memory used by both shader programs
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
 }
 
 
@@ -991,7 +750,6 @@ void Florb::initMotes(unsigned int count,
     // Randomize dust mote centers
     moteCount = count;
     motesCenters.resize(2 * moteCount);
-    motesPulsers.resize(moteCount);
     motesWinking.resize(moteCount);
     motesWinkTimes.resize(moteCount);
     for (auto i = 0UL; i < (2 * moteCount); i++) {
@@ -1008,13 +766,14 @@ void Florb::initMotes(unsigned int count,
         } else motesDirections.push_back(1.0f);
     }
 
+    motesMotion = motions.size();
+    motions.reserve(motesMotion + moteCount);
     for (auto i = 0UL; i < moteCount; i++) {
         auto winkAmplitude((k_MaxMoteWinkFrequency - k_MinMoteWinkFrequency) *
                            dist(gen) / 2.0f);
         auto winkFrequency(k_MinMoteWinkFrequency + winkAmplitude);
         
-        motesPulsers[i] =
-            make_shared<SinusoidalMotion>(true, 0.5f, 0.5f, winkFrequency, 0.0f);
+        motions.add(SinusoidalMotion(true, 0.5f, 0.5f, winkFrequency, 0.0f));
 
         motesWinking[i] = ((dist(gen) > 0.5) ? true : false);
         motesWinkTimes[i] = (k_MaxMoteWinkTime * dist(gen));
@@ -1044,7 +803,7 @@ void Florb::updateMotes(float timeSeconds) {
     // Update mote winking state and amplitudes for winking firefly effect
     for (auto i = 0UL; i < moteCount; i++) {
         if (motesWinking[i] == true) {           
-            motesAmplitudes[i] = motesPulsers[i]->evaluate(timeSeconds);
+            motesAmplitudes[i] = motionValues[motesMotion + i];
 
             if (motesAmplitudes[i] <= k_MoteWinkThreshold) {
                 motesWinkTimes[i] = (timeSeconds + (k_MaxMoteWinkTime * dist(gen)));
@@ -1059,94 +818,223 @@ void Florb::updateMotes(float timeSeconds) {
 
 // Physical effects methods
 
-void Florb::createBouncer() {
-    float phase(0.0f);
-
-    bool enabled(configs->getBounceEnabled());
-    float bias(enabled ? configs->getBounceAmplitude() : 0.0f);
-    float amplitude(bias);
-    bouncer = make_shared<SinusoidalMotion>(
-        enabled,
-        bias,
-        amplitude,
-        configs->getBounceFrequency(),
-        phase
-    );
+string Florb::compileMotionExpressions() {
+    const string sources[MAX_MOTIONS] = {
+        snapshot->bounceExpression,
+        snapshot->breatheExpression,
+        snapshot->rimExpression
+    };
+
+    ostringstream prelude;
+    prelude << "#define MOTION_EXPRESSIONS\n\n"
+            << MotionExpression::glslFunctions()
+            << "\nfloat motionExpression(int slot, float t) {\n";
+
+    bool expressions(false);
+    for (unsigned int slot = 0; slot < MAX_MOTIONS; slot++) {
+        // Only recompile expressions whose source has changed
+        if (sources[slot] != motionSources[slot]) {
+            motionSources[slot] = sources[slot];
+            motionExpressions[slot].reset();
+
+            if (!sources[slot].empty()) {
+                try {
+                    motionExpressions[slot] = make_shared<MotionExpression>(sources[slot]);
+                } catch (const exception &exc) {
+                    cerr << "[WARN] Motion expression ignored : " << exc.what() << endl;
+                }
+            }
+        }
+
+        if (motionExpressions[slot]) {
+            prelude << "    if (slot == "
+                    << slot
+                    << ") return "
+                    << motionExpressions[slot]->toGLSL("t")
+                    << ";\n";
+
+            expressions = true;
+        }
+    }
+
+    prelude << "    return 0.0;\n}\n";
+
+    // Shaders without any expression motions build from their sources unchanged
+    return (expressions ? prelude.str() : string());
+}
+
+void Florb::compileMotionCurves() {
+    const vector<pair<float, float>> *keyframes[MAX_MOTIONS] = {
+        &snapshot->bounceKeyframes,
+        &snapshot->breatheKeyframes,
+        &snapshot->rimKeyframes
+    };
+
+    // A viscous bounce takes precedence over any bounce keyframes
+    const bool enabled[MAX_MOTIONS] = {
+        (snapshot->bounceEnabled and !snapshot->bounceViscous),
+        snapshot->breatheEnabled,
+        true
+    };
+
+    for (unsigned int slot = 0; slot < MAX_MOTIONS; slot++) {
+        motionCurves[slot].reset();
+        if (!enabled[slot] or keyframes[slot]->empty()) continue;
+
+        try {
+            motionCurves[slot] = make_shared<KeyframeCurve>(*keyframes[slot]);
+        } catch (const exception &exc) {
+            cerr << "[WARN] Motion keyframes ignored : " << exc.what() << endl;
+        }
+    }
 }
 
-void Florb::createBreather() {
-    float phase(M_PI / 2);
+void Florb::updateMotionDescriptors() {
+    shaders->setPrelude(compileMotionExpressions());
+
+    auto &descriptors(motionsBlock->edit());
+
+    // Until a program compiled with the current expressions is live, which
+    // with background builds is some frames later, or never should the link
+    // fail, the live program cannot evaluate them; each motion keeps its type
+    MotionType previousTypes[MAX_MOTIONS];
+    for (unsigned int slot = 0; slot < MAX_MOTIONS; slot++) {
+        previousTypes[slot] = static_cast<MotionType>(descriptors.motions[slot].type);
+    }
+
+    // Bounce offset, held at zero when disabled
+    auto &bounce(descriptors.motions[BOUNCE_MOTION]);
+    bool bounceEnabled(snapshot->bounceEnabled);
+    bounce.bias = (bounceEnabled ? snapshot->bounceAmplitude : 0.0f);
+    bounce.amplitude = bounce.bias;
+    bounce.frequency = snapshot->bounceFrequency;
+    bounce.phase = 0.0f;
+    bounce.type = (bounceEnabled ? SINUSOIDAL_MOTION : CONSTANT_MOTION);
+    if (bounceEnabled and motionExpressions[BOUNCE_MOTION]) bounce.type = EXPRESSION_MOTION;
+
+    // A viscous bounce is integrated on the CPU, and fed to the shaders as a
+    // constant offset refreshed every frame
+    PhysicsWorld::Body bounceSpring;
+    bounceSpring.stiffness = snapshot->bounceStiffness;
+    bounceSpring.damping = snapshot->bounceDamping;
+    bounceSpring.drag = snapshot->bounceDrag;
+    bounceSpring.impulse = snapshot->bounceImpulse;
+    bounceSpring.period = snapshot->bounceImpulsePeriod;
+    physics.setBody(bounceBody, bounceSpring);
+
+    if (bounceEnabled and snapshot->bounceViscous) {
+        bounce.bias = physics.getPosition(bounceBody);
+        bounce.amplitude = 0.0f;
+        bounce.type = CONSTANT_MOTION;
+    }
 
-    const auto &breatheAmplitude(configs->getBreatheAmplitude());
+    // Breathing radius, oscillating between the configured minimum and maximum
+    auto &breathe(descriptors.motions[BREATHE_MOTION]);
+    const auto &breatheAmplitude(snapshot->breatheAmplitude);
     float minR = breatheAmplitude[0];
     float maxR = breatheAmplitude[1];
-    float bias = 0.5f * (minR + maxR);
-    float amplitude = 0.5f * (maxR - minR);
-
-    breather = make_shared<SinusoidalMotion>(
-        configs->getBreatheEnabled(),
-        bias,
-        amplitude,
-        configs->getBreatheFrequency(),
-        phase
-    );
+    breathe.bias = 0.5f * (minR + maxR);
+    breathe.amplitude = 0.5f * (maxR - minR);
+    breathe.frequency = snapshot->breatheFrequency;
+    breathe.phase = (M_PI / 2);
+    breathe.type = (snapshot->breatheEnabled ? SINUSOIDAL_MOTION : CONSTANT_MOTION);
+    if (snapshot->breatheEnabled and motionExpressions[BREATHE_MOTION]) {
+        breathe.type = EXPRESSION_MOTION;
+    }
+
+    // Rim light pulse
+    auto &rim(descriptors.motions[RIM_MOTION]);
+    rim.bias = snapshot->rimStrength;
+    rim.amplitude = snapshot->rimStrength;
+    rim.frequency = snapshot->rimFrequency;
+    rim.phase = 0.0f;
+    rim.type = (motionExpressions[RIM_MOTION] ? EXPRESSION_MOTION : SINUSOIDAL_MOTION);
+
+    if (!shaders->isPreludeLive()) {
+        for (unsigned int slot = 0; slot < MAX_MOTIONS; slot++) {
+            auto &type(descriptors.motions[slot].type);
+            if (type == EXPRESSION_MOTION) type = previousTypes[slot];
+        }
+    }
+
+    // Keyframed curves replace the regular motions of enabled effects
+    compileMotionCurves();
+    for (unsigned int slot = 0; slot < MAX_MOTIONS; slot++) {
+        if (motionCurves[slot]) {
+            descriptors.motions[slot].bias = motionCurves[slot]->evaluate(timeline.getTime());
+            descriptors.motions[slot].amplitude = 0.0f;
+            descriptors.motions[slot].type = CONSTANT_MOTION;
+        }
+    }
+
+    motionsBlock->upload();
 }
 
-void Florb::createRimPulser() {
-    bool enabled(true);
-    float phase(0.0f);
-
-    rimPulser = make_shared<SinusoidalMotion>(
-        enabled,
-        baseRimStrength,
-        baseRimStrength,
-        configs->getRimFrequency(),
-        phase
-    );
+
+// Late-latched uniforms method
+
+void Florb::latchUniforms() {
+    // Re-read the clock and camera immediately ahead of the draw, so that
+    // time-driven motion and interaction lag the display as little as possible
+    auto now(timeline.sample());
+    frameUniforms.time.set(Timeline::toSeconds(now));
+
+    updateTransition(now);
+
+    auto camera(cameras[0]->getState());
+    frameUniforms.viewPos.set(camera.view);
+    frameUniforms.zoom.set(camera.zoom);
+
+    // Keyframed and viscous motions are evaluated here, reaching the shaders
+    // as constant motion descriptors
+    bool cpuMotions(false);
+    auto &descriptors(motionsBlock->edit());
+
+    for (unsigned int slot = 0; slot < MAX_MOTIONS; slot++) {
+        if (motionCurves[slot]) {
+            descriptors.motions[slot].bias = motionCurves[slot]->evaluate(now);
+            cpuMotions = true;
+        }
+    }
+
+    if (snapshot->bounceEnabled and snapshot->bounceViscous) {
+        descriptors.motions[BOUNCE_MOTION].bias = physics.getPosition(bounceBody);
+        cpuMotions = true;
+    }
+
+    if (cpuMotions) motionsBlock->upload();
 }
 
 
 // Update physical effects method
 
 void Florb::updatePhysicalEffects(bool transition) {
-    // Update the time uniform for physical effects
-    static steady_clock::time_point startTime = steady_clock::now();
-    float timeMsec = duration_cast<milliseconds>(steady_clock::now() - startTime).count();
-    float timeSeconds = (timeMsec / 1000.0f);
+    // Frame time for CPU-side effects; shader time is latched just before the draw
+    auto now(timeline.getTime());
+    float timeSeconds(Timeline::toSeconds(now));
+
 
-    GLuint timeLoc = glGetUniformLocation(shaderProgram, "time");
-    glUniform1f(timeLoc, timeSeconds);
+    // Mark the start of any flower image transition
+    if (transition) transitionStart = now;
 
 
-    // Update flower image transition progress
-    updateTransition(transition, timeSeconds);
+    // Step stateful physics at its own fixed rate, however long the frame took
+    physics.advance(Timeline::toSeconds(now - physicsTime));
+    physicsTime = now;
 
 
     // Update spotlight motion
     for (auto &spotlight : spotlights) spotlight->updateMotion(timeSeconds);
 
 
-    // Update the sphere
-    bounceOffset = bouncer->evaluate(timeSeconds);
-    auto breatheRadius(breather->evaluate(timeSeconds));
-    configs->setVignetteRadius(breatheRadius);
-
-    GLuint vignetteRadiusLoc = glGetUniformLocation(shaderProgram, "vignetteRadius");
-    glUniform1f(vignetteRadiusLoc, vignetteRadius);
-
-    auto smoothness(configs->getSmoothness());
-    generateSphere(breatheRadius, smoothness, (smoothness / 2));
-
-    // Update current actual radius
-    configs->setRadius(breatheRadius);
+    // Evaluate every CPU-side scalar motion for this frame in one batch
+    motions.evaluate(timeSeconds, motionValues.data(), motionValues.size());
 
     
-    // Update rim light pulsing and color
-    configs->setRimStrength(rimPulser->evaluate(timeSeconds));
-
-    animatedRimColor = glm::make_vec3(configs->getRimColor().data());
-    if (configs->getRimAnimateEnabled()) {
-        float t = fmod(timeSeconds / configs->getRimAnimateFrequency(), 1.0f);
+    // Update rim light color; bounce, breathe and rim pulse run in the shaders
+    animatedRimColor = glm::make_vec3(snapshot->rimColor.data());
+    if (snapshot->rimAnimateEnabled) {
+        float t = fmod(timeSeconds / snapshot->rimAnimateFrequency, 1.0f);
         float r = 0.5f + 0.5f * sinf(2.0f * M_PI * t);
         float g = 0.5f + 0.5f * sinf(2.0f * M_PI * (t + 0.33f));
         float b = 0.5f + 0.5f * sinf(2.0f * M_PI * (t + 0.66f));
@@ -1155,5 +1043,6 @@ void Florb::updatePhysicalEffects(bool transition) {
 
 
     // Update dust motes
+    FrameProfiler::Scope scope(*profiler, MOTES_STAGE);
     updateMotes(timeSeconds);
 }
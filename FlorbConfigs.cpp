@@ -2,12 +2,15 @@
 #include <fstream>
 #include <iostream>
 #include <cmath>
+#include <sstream>
 
 #include "Camera.h"
+#include "ExpressionMotion.h"
 #include "FlorbConfigs.h"
 #include "FlorbUtils.h"
 #include "LinearMotion.h"
 #include "Spotlight.h"
+#include "Tracer.h"
 
 extern Display *display;
 extern Window window;
@@ -17,9 +20,10 @@ using std::cos;
 using std::endl;
 using std::exception;
 using std::ifstream;
-using std::lock_guard;
+using std::atomic_load;
+using std::atomic_store;
 using std::make_shared;
-using std::mutex;
+using std::ostringstream;
 using std::pair;
 using std::shared_ptr;
 using std::sin;
@@ -28,27 +32,38 @@ using std::vector;
 
 using json = nlohmann::json_abi_v3_12_0::json;
 
-#define LOCK_CONFIGS lock_guard<mutex> lock(stateMutex)
+#define UPDATE_CONFIGS Writer writer(*this); auto &state(writer.getState())
 
 
 // Implementation of class FlorbConfigs
 
 // Static member initialization
 
+const string FlorbConfigs::k_DefaultPath("florb.json");
+
 const string FlorbConfigs::k_DefaultImagePath("flowers");
 
 
 const string FlorbConfigs::k_DefaultTitle("Florb v0.3");
 
 
-const float FlorbConfigs::k_MaxVideoFrameRate(120.0f);
+const float FlorbConfigs::k_MaxVideoFrameRate(240.0f);
 
 const float FlorbConfigs::k_DefaultVideoFrameRate(60.0f);
 
+const unsigned int FlorbConfigs::k_MaxFramesInFlight(4U);
+
+const unsigned int FlorbConfigs::k_DefaultFramesInFlight(2U);
+
 
 const float FlorbConfigs::k_DefaultImageSwitch(5.0f);
 
 
+const string FlorbConfigs::k_DefaultVertexShaderPath("shaders/florb.vert");
+
+const string FlorbConfigs::k_DefaultFragmentShaderPath("shaders/florb.frag");
+
+
 const float FlorbConfigs::k_DefaultTransitionTime(1.0f);
 
 
@@ -61,83 +76,68 @@ const float FlorbConfigs::k_DefaultRadius(0.8f);
 const int FlorbConfigs::k_MaxMotes(256);
 
 
-// Constructor
+const string FlorbConfigs::k_DefaultProfilePath("florb-profile.csv");
 
-FlorbConfigs::FlorbConfigs() :
-    imagePaths(),
+const float FlorbConfigs::k_DefaultProfileInterval(5.0f);
 
-    videoFrameRate(k_DefaultVideoFrameRate),
-    imageSwitch(k_DefaultImageSwitch),
 
-    transitionMode(TransitionMode::FLIP),
-    transitionOrder(TransitionOrder::ALPHABETICAL),
-    transitionTime(k_DefaultTransitionTime),
+const float FlorbConfigs::k_DefaultRecorderWindow(10.0f);
 
-    cameras(),
-    
-    offsetX(0.0f),
-    offsetY(0.0f),
-    radius(k_DefaultRadius),
-    smoothness(7UL),
+const float FlorbConfigs::k_DefaultRecorderThreshold(2.0f);
 
-    shininess(1.0f),
-    spotlights(),
+const string FlorbConfigs::k_DefaultRecorderDirectory(".");
 
-    anisotropyEnabled(false),
-    anisotropyStrength(0.0f),
-    anisotropySharpness(0.0f),
 
-    bounceEnabled(false),
-    bounceAmplitude(0.0f),
-    bounceFrequency(0.0f),
+const string FlorbConfigs::k_DefaultResourcesPath("florb-resources.csv");
 
-    breatheEnabled(false),
-    breatheAmplitude(2, k_DefaultRadius),
-    breatheFrequency(0.0f),
-    
-    rimStrength(0.0f),
-    rimExponent(0.0f),
-    rimColor(3, 0.0f),
-    rimFrequency(0.0f),
-    rimAnimateEnabled(false),
-    rimAnimateFrequency(0.0f),
-
-    vignetteRadius(0.0f),
-    vignetteExponent(0.0f),
+const float FlorbConfigs::k_DefaultResourcesInterval(60.0f);
 
-    iridescenceStrength(0.0f),
-    iridescenceFrequency(0.0f),
-    iridescenceShift(0.0f),
 
-    moteCount(0ULL),
-    motesRadius(0.0f),
-    motesMaxStep(0.0f),
-    motesWinkingEnabled(false),
-    motesMaxOff(0.0f),
-    motesColor(3, 0.0f),
-
-    anisotropicMode(AnisotropicMode::NORMAL),
-    renderMode(RenderMode::FILL),
-    specularMode(SpecularMode::NORMAL),
+// Constructor
 
-    stateMutex() { }
+FlorbConfigs::FlorbConfigs() :
+    snapshot(make_shared<const Snapshot>()),
+    version(0UL),
+    pending(),
+    writerMutex() { }
 
 
 // Public member methods
 
-void FlorbConfigs::load() {
+void FlorbConfigs::load(const string &path) {
+    Tracer::Scope scope("configs", "load");
+
+    string document;
+    if (read(document, path)) parse(document);
+}
 
-    // TODO - Make into a default constant, with an overload which
-    //        accepts a filename (to be passed on the command line)
-    ifstream file("florb.json");
+bool FlorbConfigs::read(string &document, const string &path) {
+    ifstream file(path);
     if (!file.is_open()) {
-        cerr << "[WARN] Could not open florb.json for configuration" << endl;
-        return;
+        cerr << "[WARN] Could not open " << path << " for configuration" << endl;
+        return false;
     }
 
+    ostringstream contents;
+    contents << file.rdbuf();
+    document = contents.str();
+
+    return true;
+}
+
+void FlorbConfigs::parse(const string &document) {
+    // Publish the whole document as a single snapshot
+    UPDATE_CONFIGS;
+    state.document = document;
+
+    // The state is copied from the current snapshot; a document's cameras
+    // and spotlights replace those of the last, rather than adding to them
+    state.cameras.clear();
+    state.spotlights.clear();
+
     json config;
     try {
-        file >> config;
+        config = json::parse(document);
 
         // Title config
         if (config.contains("title") and config["title"].is_string()) {
@@ -175,6 +175,33 @@ void FlorbConfigs::load() {
             if (video.contains("image_switch") and video["image_switch"].is_number()) {
                 setImageSwitch(video["image_switch"]);
             }
+
+            if (video.contains("vsync") and video["vsync"].is_boolean()) {
+                setVsync(video["vsync"]);
+            }
+
+            if (video.contains("frames_in_flight") and
+                video["frames_in_flight"].is_number_unsigned()) {
+                setFramesInFlight(video["frames_in_flight"]);
+            }
+        }
+
+
+        // Shader configs
+        if (config.contains("shaders") and config["shaders"].is_object()) {
+            const auto &shaders(config["shaders"]);
+
+            if (shaders.contains("vertex") and shaders["vertex"].is_string()) {
+                setVertexShaderPath(shaders["vertex"]);
+            }
+
+            if (shaders.contains("fragment") and shaders["fragment"].is_string()) {
+                setFragmentShaderPath(shaders["fragment"]);
+            }
+
+            if (shaders.contains("hot_reload") and shaders["hot_reload"].is_boolean()) {
+                setShaderHotReload(shaders["hot_reload"]);
+            }
         }
 
 
@@ -268,7 +295,7 @@ void FlorbConfigs::load() {
                 }
 
                 // Create the new camera and push it onto our collection
-                this->cameras.push_back(make_shared<Camera>(name, view, zoom));
+                state.cameras.push_back(make_shared<Camera>(name, view, zoom));
                     
                 cameraNum++;
             }
@@ -304,7 +331,7 @@ void FlorbConfigs::load() {
                 setShininess(light["shininess"]);
             }
 
-            parseSpotlights(light);
+            parseSpotlights(light, state);
 
             // Rim lighting
             if (light.contains("rim") and light["rim"].is_object()) {
@@ -342,6 +369,14 @@ void FlorbConfigs::load() {
                         setRimAnimateFrequency(animate["frequency"]);
                     }
                 } // Animate configs
+
+                if (rim.contains("expression") and rim["expression"].is_string()) {
+                    setRimExpression(rim["expression"]);
+                }
+
+                if (rim.contains("keyframes") and rim["keyframes"].is_array()) {
+                    setRimKeyframes(parseKeyframes(rim["keyframes"]));
+                }
                 
             } // Rim configs
             
@@ -383,6 +418,43 @@ void FlorbConfigs::load() {
                 if (bounce.contains("frequency") and bounce["frequency"].is_number()) {
                     setBounceFrequency(bounce["frequency"]);
                 }
+
+                if (bounce.contains("expression") and bounce["expression"].is_string()) {
+                    setBounceExpression(bounce["expression"]);
+                }
+
+                if (bounce.contains("keyframes") and bounce["keyframes"].is_array()) {
+                    setBounceKeyframes(parseKeyframes(bounce["keyframes"]));
+                }
+
+                // Stateful spring bounce, excited by an impulse train
+                if (bounce.contains("viscous") and bounce["viscous"].is_object()) {
+                    const auto &viscous(bounce["viscous"]);
+
+                    if (viscous.contains("enabled") and viscous["enabled"].is_boolean()) {
+                        setBounceViscous(viscous["enabled"]);
+                    }
+
+                    if (viscous.contains("stiffness") and viscous["stiffness"].is_number()) {
+                        setBounceStiffness(viscous["stiffness"]);
+                    }
+
+                    if (viscous.contains("damping") and viscous["damping"].is_number()) {
+                        setBounceDamping(viscous["damping"]);
+                    }
+
+                    if (viscous.contains("drag") and viscous["drag"].is_number()) {
+                        setBounceDrag(viscous["drag"]);
+                    }
+
+                    if (viscous.contains("impulse") and viscous["impulse"].is_number()) {
+                        setBounceImpulse(viscous["impulse"]);
+                    }
+
+                    if (viscous.contains("period") and viscous["period"].is_number()) {
+                        setBounceImpulsePeriod(viscous["period"]);
+                    }
+                } // Viscous configs
             } // Bounce configs
 
             if (effects.contains("breathe") and effects["breathe"].is_object()) {
@@ -400,6 +472,14 @@ void FlorbConfigs::load() {
                 if (breathe.contains("frequency") and breathe["frequency"].is_number()) {
                     setBreatheFrequency(breathe["frequency"]);
                 }
+
+                if (breathe.contains("expression") and breathe["expression"].is_string()) {
+                    setBreatheExpression(breathe["expression"]);
+                }
+
+                if (breathe.contains("keyframes") and breathe["keyframes"].is_array()) {
+                    setBreatheKeyframes(parseKeyframes(breathe["keyframes"]));
+                }
             } // Breathe configs
 
             // Flutter configs
@@ -553,525 +633,890 @@ void FlorbConfigs::load() {
                          << endl;
                 }
             }
+
+            // Uniform statistics - periodic report of GL uniform traffic
+            if (debug.contains("uniform_stats") and debug["uniform_stats"].is_boolean()) {
+                setUniformStats(debug["uniform_stats"]);
+            }
+
+            // Frame statistics - periodic report of the frame interval histogram
+            if (debug.contains("frame_stats") and debug["frame_stats"].is_boolean()) {
+                setFrameStats(debug["frame_stats"]);
+            }
+
+            // GL counters - per-frame counts of GL calls, uploads and redundant state changes
+            if (debug.contains("gl_counters") and debug["gl_counters"].is_boolean()) {
+                setGLCounters(debug["gl_counters"]);
+            }
+
+            // GL debug output - errors and warnings through GL_KHR_debug, from a debug context
+            if (debug.contains("gl_debug") and debug["gl_debug"].is_boolean()) {
+                setGLDebug(debug["gl_debug"]);
+            }
+
+            // Synchronous GL error checking - each error reported within the call which caused it
+            if (debug.contains("gl_synchronous") and debug["gl_synchronous"].is_boolean()) {
+                setGLSynchronous(debug["gl_synchronous"]);
+            }
+
+            // Per-stage frame profiling, dumped periodically to CSV or JSON
+            if (debug.contains("profile") and debug["profile"].is_object()) {
+                const auto &profile(debug["profile"]);
+
+                if (profile.contains("enabled") and profile["enabled"].is_boolean()) {
+                    setProfileEnabled(profile["enabled"]);
+                }
+
+                if (profile.contains("path") and profile["path"].is_string()) {
+                    setProfilePath(profile["path"]);
+                }
+
+                if (profile.contains("interval") and profile["interval"].is_number()) {
+                    setProfileInterval(profile["interval"]);
+                }
+
+                if (profile.contains("counters") and profile["counters"].is_boolean()) {
+                    setProfileCounters(profile["counters"]);
+                }
+            }
+
+            // Flight recorder, snapshotting the recent past upon slow frames
+            if (debug.contains("flight_recorder") and debug["flight_recorder"].is_object()) {
+                const auto &recorder(debug["flight_recorder"]);
+
+                if (recorder.contains("enabled") and recorder["enabled"].is_boolean()) {
+                    setRecorderEnabled(recorder["enabled"]);
+                }
+
+                if (recorder.contains("window") and recorder["window"].is_number()) {
+                    setRecorderWindow(recorder["window"]);
+                }
+
+                if (recorder.contains("threshold") and recorder["threshold"].is_number()) {
+                    setRecorderThreshold(recorder["threshold"]);
+                }
+
+                if (recorder.contains("directory") and recorder["directory"].is_string()) {
+                    setRecorderDirectory(recorder["directory"]);
+                }
+            }
+
+            // Resource monitor, sampling what a long run holds on to
+            if (debug.contains("resources") and debug["resources"].is_object()) {
+                const auto &resources(debug["resources"]);
+
+                if (resources.contains("enabled") and resources["enabled"].is_boolean()) {
+                    setResourcesEnabled(resources["enabled"]);
+                }
+
+                if (resources.contains("path") and resources["path"].is_string()) {
+                    setResourcesPath(resources["path"]);
+                }
+
+                if (resources.contains("interval") and resources["interval"].is_number()) {
+                    setResourcesInterval(resources["interval"]);
+                }
+            }
         }
 
     } catch (const exception& exc) {
-        cerr << "[ERROR] Failed to parse \"florb.json\" : " << exc.what() << endl;
+        cerr << "[ERROR] Failed to parse the configuration : " << exc.what() << endl;
     }
 }
 
 
+// Snapshot accessors
+
+shared_ptr<const FlorbConfigs::Snapshot> FlorbConfigs::getSnapshot() const {
+    return atomic_load(&snapshot);
+}
+
+unsigned long FlorbConfigs::getVersion() const {
+    return version.load(std::memory_order_acquire);
+}
+
+bool FlorbConfigs::refresh(shared_ptr<const Snapshot> &current) const {
+    // Only touch the shared snapshot pointer when a newer version exists
+    if (current and (current->version == getVersion())) return false;
+
+    current = getSnapshot();
+    return true;
+}
+
+
 // Title mutator
 
-const string& FlorbConfigs::getTitle() const {
-    LOCK_CONFIGS;
-    return title;
+string FlorbConfigs::getTitle() const {
+    return getSnapshot()->title;
 }
   
 void FlorbConfigs::setTitle(const string &t) {
-    LOCK_CONFIGS;
-    title = t;
-    FlorbUtils::setWindowTitle(display, window, title);
+    UPDATE_CONFIGS;
+    state.title = t;
+    FlorbUtils::setWindowTitle(display, window, state.title);
 }
 
 
 // Image path accessor / mutator
 
-const vector<string>& FlorbConfigs::getImagePaths() const {
-    LOCK_CONFIGS;
-    return imagePaths;
+vector<string> FlorbConfigs::getImagePaths() const {
+    return getSnapshot()->imagePaths;
 }
   
 void FlorbConfigs::setImagePaths(const vector<string> &p) {
-    LOCK_CONFIGS;
-    imagePaths = p;
+    UPDATE_CONFIGS;
+    state.imagePaths = p;
 }
 
 
 // Video accessors / mutators
 
 float FlorbConfigs::getVideoFrameRate() const {
-    LOCK_CONFIGS;
-    return videoFrameRate;
+    return getSnapshot()->videoFrameRate;
 }
 
 void FlorbConfigs::setVideoFrameRate(float r) {
-    LOCK_CONFIGS;
+    UPDATE_CONFIGS;
 
-    if (videoFrameRate >= k_MaxVideoFrameRate) {
-        videoFrameRate = k_MaxVideoFrameRate;
-    } else {
-        videoFrameRate = r;
+    if (r >= k_MaxVideoFrameRate) {
+        state.videoFrameRate = k_MaxVideoFrameRate;
+    } else if (r > 0.0f) {
+        state.videoFrameRate = r;
     }
 }
 
 float FlorbConfigs::getImageSwitch() const {
-    LOCK_CONFIGS;
-    return imageSwitch;
+    return getSnapshot()->imageSwitch;
 }
 
 void FlorbConfigs::setImageSwitch(float s) {
-    LOCK_CONFIGS;
-    imageSwitch = s;
+    UPDATE_CONFIGS;
+    state.imageSwitch = s;
+}
+
+bool FlorbConfigs::getVsync() const {
+    return getSnapshot()->vsync;
+}
+
+void FlorbConfigs::setVsync(bool v) {
+    UPDATE_CONFIGS;
+    state.vsync = v;
+}
+
+unsigned int FlorbConfigs::getFramesInFlight() const {
+    return getSnapshot()->framesInFlight;
+}
+
+void FlorbConfigs::setFramesInFlight(unsigned int f) {
+    UPDATE_CONFIGS;
+    state.framesInFlight = ((f > k_MaxFramesInFlight) ? k_MaxFramesInFlight : f);
+}
+
+
+// Shader accessors / mutators
+
+string FlorbConfigs::getVertexShaderPath() const {
+    return getSnapshot()->vertexShaderPath;
+}
+
+void FlorbConfigs::setVertexShaderPath(const string &p) {
+    UPDATE_CONFIGS;
+    state.vertexShaderPath = p;
+}
+
+string FlorbConfigs::getFragmentShaderPath() const {
+    return getSnapshot()->fragmentShaderPath;
+}
+
+void FlorbConfigs::setFragmentShaderPath(const string &p) {
+    UPDATE_CONFIGS;
+    state.fragmentShaderPath = p;
+}
+
+bool FlorbConfigs::getShaderHotReload() const {
+    return getSnapshot()->shaderHotReload;
+}
+
+void FlorbConfigs::setShaderHotReload(bool h) {
+    UPDATE_CONFIGS;
+    state.shaderHotReload = h;
 }
 
 
 // Transition mode accessor / mutator
 
 FlorbConfigs::TransitionMode FlorbConfigs::getTransitionMode() const {
-    LOCK_CONFIGS;
-    return transitionMode;
+    return getSnapshot()->transitionMode;
 }
 
 void FlorbConfigs::setTransitionMode(TransitionMode t) {
-    LOCK_CONFIGS;
-    transitionMode = t;
+    UPDATE_CONFIGS;
+    state.transitionMode = t;
 }
 
 FlorbConfigs::TransitionOrder FlorbConfigs::getTransitionOrder() const {
-    LOCK_CONFIGS;
-    return transitionOrder;
+    return getSnapshot()->transitionOrder;
 }
 
 void FlorbConfigs::setTransitionOrder(TransitionOrder o) {
-    LOCK_CONFIGS;
-    transitionOrder = o;
+    UPDATE_CONFIGS;
+    state.transitionOrder = o;
 }
 
 float FlorbConfigs::getTransitionTime() const {
-    LOCK_CONFIGS;
-    return transitionTime;
+    return getSnapshot()->transitionTime;
 }
 
 void FlorbConfigs::setTransitionTime(float t) {
-    LOCK_CONFIGS;
-    transitionTime = t;
+    UPDATE_CONFIGS;
+    state.transitionTime = t;
 }
 
 
 // Cameras accessor
 
-const vector<shared_ptr<Camera>>& FlorbConfigs::getCameras() const {
-    LOCK_CONFIGS;
-    return cameras;
+vector<shared_ptr<Camera>> FlorbConfigs::getCameras() const {
+    return getSnapshot()->cameras;
 }
 
 
 // Geometry accessors / mutators
 
 pair<float, float> FlorbConfigs::getCenter() const {
-    LOCK_CONFIGS;
-    return {offsetX, offsetY};
+    auto current(getSnapshot());
+    return {current->offsetX, current->offsetY};
 }
 
 void FlorbConfigs::setCenter(float x, float y) {
-    LOCK_CONFIGS;
-    offsetX = x;
-    offsetY = y;
+    UPDATE_CONFIGS;
+    state.offsetX = x;
+    state.offsetY = y;
 }
 
 float FlorbConfigs::getRadius() const {
-    LOCK_CONFIGS;
-    return radius;
+    return getSnapshot()->radius;
 }
 
 void FlorbConfigs::setRadius(float r) {
-    LOCK_CONFIGS;
-    radius = r;
+    UPDATE_CONFIGS;
+    state.radius = r;
 }
 
 unsigned int FlorbConfigs::getSmoothness() const {
-    LOCK_CONFIGS;
-    return smoothness;
+    return getSnapshot()->smoothness;
 }
 
 void FlorbConfigs::setSmoothness(unsigned int s) {
-    LOCK_CONFIGS;
-    smoothness = s;
+    UPDATE_CONFIGS;
+    state.smoothness = s;
 }
 
 
 // Spotlights accessor
 
-const vector<shared_ptr<Spotlight>>& FlorbConfigs::getSpotlights() const {
-    LOCK_CONFIGS;
-    return spotlights;
+vector<shared_ptr<Spotlight>> FlorbConfigs::getSpotlights() const {
+    return getSnapshot()->spotlights;
 }
 
 
 // Anisotropy accessors / mutators
 
 bool FlorbConfigs::getAnisotropyEnabled() const {
-    return anisotropyEnabled;
+    return getSnapshot()->anisotropyEnabled;
 }
 
 void FlorbConfigs::setAnisotropyEnabled(bool e) {
-    anisotropyEnabled = e;
+    UPDATE_CONFIGS;
+    state.anisotropyEnabled = e;
 }
 
 float FlorbConfigs::getAnisotropyStrength() const {
-    return anisotropyStrength;
+    return getSnapshot()->anisotropyStrength;
 }
 
 void FlorbConfigs::setAnisotropyStrength(float s) {
-    anisotropyStrength = s;
+    UPDATE_CONFIGS;
+    state.anisotropyStrength = s;
 }
     
 float FlorbConfigs::getAnisotropySharpness() const {
-    return anisotropySharpness;
+    return getSnapshot()->anisotropySharpness;
 }
 
 void FlorbConfigs::setAnisotropySharpness(float s) {
-    anisotropySharpness = s;
+    UPDATE_CONFIGS;
+    state.anisotropySharpness = s;
 }
 
 
 // Bounce accessors / mutators
 
 bool FlorbConfigs::getBounceEnabled() const {
-    LOCK_CONFIGS;
-    return bounceEnabled;
+    return getSnapshot()->bounceEnabled;
 }
 
 void FlorbConfigs::setBounceEnabled(bool e) {
-    LOCK_CONFIGS;
-    bounceEnabled = e;
+    UPDATE_CONFIGS;
+    state.bounceEnabled = e;
 }
 
 float FlorbConfigs::getBounceAmplitude() const {
-    LOCK_CONFIGS;
-    return bounceAmplitude;
+    return getSnapshot()->bounceAmplitude;
 }
 
 void FlorbConfigs::setBounceAmplitude(float a) {
-    LOCK_CONFIGS;
-    bounceAmplitude = a;
+    UPDATE_CONFIGS;
+    state.bounceAmplitude = a;
 }
 
 float FlorbConfigs::getBounceFrequency() const {
-    LOCK_CONFIGS;
-    return bounceFrequency;
+    return getSnapshot()->bounceFrequency;
 }
 
 void FlorbConfigs::setBounceFrequency(float f) {
-    LOCK_CONFIGS;
-    bounceFrequency = f;
+    UPDATE_CONFIGS;
+    state.bounceFrequency = f;
+}
+
+string FlorbConfigs::getBounceExpression() const {
+    return getSnapshot()->bounceExpression;
+}
+
+void FlorbConfigs::setBounceExpression(const string &e) {
+    UPDATE_CONFIGS;
+    state.bounceExpression = e;
+}
+
+bool FlorbConfigs::getBounceViscous() const {
+    return getSnapshot()->bounceViscous;
+}
+
+void FlorbConfigs::setBounceViscous(bool v) {
+    UPDATE_CONFIGS;
+    state.bounceViscous = v;
+}
+
+float FlorbConfigs::getBounceStiffness() const {
+    return getSnapshot()->bounceStiffness;
+}
+
+void FlorbConfigs::setBounceStiffness(float s) {
+    UPDATE_CONFIGS;
+    state.bounceStiffness = s;
+}
+
+float FlorbConfigs::getBounceDamping() const {
+    return getSnapshot()->bounceDamping;
+}
+
+void FlorbConfigs::setBounceDamping(float d) {
+    UPDATE_CONFIGS;
+    state.bounceDamping = d;
+}
+
+float FlorbConfigs::getBounceDrag() const {
+    return getSnapshot()->bounceDrag;
+}
+
+void FlorbConfigs::setBounceDrag(float d) {
+    UPDATE_CONFIGS;
+    state.bounceDrag = d;
+}
+
+float FlorbConfigs::getBounceImpulse() const {
+    return getSnapshot()->bounceImpulse;
+}
+
+void FlorbConfigs::setBounceImpulse(float i) {
+    UPDATE_CONFIGS;
+    state.bounceImpulse = i;
+}
+
+float FlorbConfigs::getBounceImpulsePeriod() const {
+    return getSnapshot()->bounceImpulsePeriod;
+}
+
+void FlorbConfigs::setBounceImpulsePeriod(float p) {
+    UPDATE_CONFIGS;
+    state.bounceImpulsePeriod = p;
+}
+
+vector<pair<float, float>> FlorbConfigs::getBounceKeyframes() const {
+    return getSnapshot()->bounceKeyframes;
+}
+
+void FlorbConfigs::setBounceKeyframes(const vector<pair<float, float>> &k) {
+    UPDATE_CONFIGS;
+    state.bounceKeyframes = k;
 }
 
 
 // Breathe accessors / mutators
 
 bool FlorbConfigs::getBreatheEnabled() const {
-    LOCK_CONFIGS;
-    return breatheEnabled;
+    return getSnapshot()->breatheEnabled;
 }
 
 void FlorbConfigs::setBreatheEnabled(bool e) {
-    LOCK_CONFIGS;
-    breatheEnabled = e;
+    UPDATE_CONFIGS;
+    state.breatheEnabled = e;
 }
 
-const vector<float>& FlorbConfigs::getBreatheAmplitude() const {
-    LOCK_CONFIGS;
-    return breatheAmplitude;
+vector<float> FlorbConfigs::getBreatheAmplitude() const {
+    return getSnapshot()->breatheAmplitude;
 }
 
 void FlorbConfigs::setBreatheAmplitude(float min, float max) {
-    LOCK_CONFIGS;
-    breatheAmplitude[0] = min;
-    breatheAmplitude[1] = max;
+    UPDATE_CONFIGS;
+    state.breatheAmplitude[0] = min;
+    state.breatheAmplitude[1] = max;
 }
 
 float FlorbConfigs::getBreatheFrequency() const {
-    LOCK_CONFIGS;
-    return breatheFrequency;
+    return getSnapshot()->breatheFrequency;
 }
 
 void FlorbConfigs::setBreatheFrequency(float f) {
-    LOCK_CONFIGS;
-    breatheFrequency = f;
+    UPDATE_CONFIGS;
+    state.breatheFrequency = f;
+}
+
+string FlorbConfigs::getBreatheExpression() const {
+    return getSnapshot()->breatheExpression;
+}
+
+void FlorbConfigs::setBreatheExpression(const string &e) {
+    UPDATE_CONFIGS;
+    state.breatheExpression = e;
+}
+
+vector<pair<float, float>> FlorbConfigs::getBreatheKeyframes() const {
+    return getSnapshot()->breatheKeyframes;
+}
+
+void FlorbConfigs::setBreatheKeyframes(const vector<pair<float, float>> &k) {
+    UPDATE_CONFIGS;
+    state.breatheKeyframes = k;
 }
 
 
 // Shininess accessor / mutator
 
 float FlorbConfigs::getShininess() const {
-    LOCK_CONFIGS;
-    return shininess;
+    return getSnapshot()->shininess;
 }
 
 void FlorbConfigs::setShininess(float s) {
-    LOCK_CONFIGS;
-    shininess = s;
+    UPDATE_CONFIGS;
+    state.shininess = s;
 }
 
 
 // Rim light accessors / mutators
 
 float FlorbConfigs::getRimStrength() const {
-    LOCK_CONFIGS;
-    return rimStrength;
+    return getSnapshot()->rimStrength;
 }
 
 void FlorbConfigs::setRimStrength(float s) {
-    LOCK_CONFIGS;
-    rimStrength = s;
+    UPDATE_CONFIGS;
+    state.rimStrength = s;
 }
 
 float FlorbConfigs::getRimExponent() const {
-    LOCK_CONFIGS;
-    return rimExponent;
+    return getSnapshot()->rimExponent;
 }
 
 void FlorbConfigs::setRimExponent(float s) {
-    LOCK_CONFIGS;
-    rimExponent = s;
+    UPDATE_CONFIGS;
+    state.rimExponent = s;
 }
 
-const vector<float>& FlorbConfigs::getRimColor() const {
-    LOCK_CONFIGS;
-    return rimColor;
+vector<float> FlorbConfigs::getRimColor() const {
+    return getSnapshot()->rimColor;
 }
 
 void FlorbConfigs::setRimColor(float r, float g, float b) {
-    LOCK_CONFIGS;
-    rimColor[0] = r;
-    rimColor[1] = g;
-    rimColor[2] = b;
+    UPDATE_CONFIGS;
+    state.rimColor[0] = r;
+    state.rimColor[1] = g;
+    state.rimColor[2] = b;
 }
 
 float FlorbConfigs::getRimFrequency() const {
-    LOCK_CONFIGS;
-    return rimFrequency;
+    return getSnapshot()->rimFrequency;
 }
 
 void FlorbConfigs::setRimFrequency(float f) {
-    LOCK_CONFIGS;
-    rimFrequency = f;
+    UPDATE_CONFIGS;
+    state.rimFrequency = f;
 }
 
 bool FlorbConfigs::getRimAnimateEnabled() const {
-    LOCK_CONFIGS;
-    return rimAnimateEnabled;
+    return getSnapshot()->rimAnimateEnabled;
 }
 
 void FlorbConfigs::setRimAnimateEnabled(bool a) {
-    LOCK_CONFIGS;
-    rimAnimateEnabled = a;
+    UPDATE_CONFIGS;
+    state.rimAnimateEnabled = a;
 }
 
 float FlorbConfigs::getRimAnimateFrequency() const {
-    LOCK_CONFIGS;
-    return rimAnimateFrequency;
+    return getSnapshot()->rimAnimateFrequency;
 }
 
 void FlorbConfigs::setRimAnimateFrequency(float f) {
-    LOCK_CONFIGS;
-    rimAnimateFrequency = f;
+    UPDATE_CONFIGS;
+    state.rimAnimateFrequency = f;
+}
+
+string FlorbConfigs::getRimExpression() const {
+    return getSnapshot()->rimExpression;
+}
+
+void FlorbConfigs::setRimExpression(const string &e) {
+    UPDATE_CONFIGS;
+    state.rimExpression = e;
+}
+
+vector<pair<float, float>> FlorbConfigs::getRimKeyframes() const {
+    return getSnapshot()->rimKeyframes;
+}
+
+void FlorbConfigs::setRimKeyframes(const vector<pair<float, float>> &k) {
+    UPDATE_CONFIGS;
+    state.rimKeyframes = k;
 }
 
 
 // Iridescence accessors / mutators
 
 float FlorbConfigs::getIridescenceStrength() const {
-    LOCK_CONFIGS;
-    return iridescenceStrength;
+    return getSnapshot()->iridescenceStrength;
 }
 
 void FlorbConfigs::setIridescenceStrength(float s) {
-    LOCK_CONFIGS;
-    iridescenceStrength = s;
+    UPDATE_CONFIGS;
+    state.iridescenceStrength = s;
 }
 
 float FlorbConfigs::getIridescenceFrequency() const {
-    LOCK_CONFIGS;
-    return iridescenceFrequency;
+    return getSnapshot()->iridescenceFrequency;
 }
 
 void FlorbConfigs::setIridescenceFrequency(float f) {
-    LOCK_CONFIGS;
-    iridescenceFrequency = f;
+    UPDATE_CONFIGS;
+    state.iridescenceFrequency = f;
 }
 
 float FlorbConfigs::getIridescenceShift() const {
-    LOCK_CONFIGS;
-    return iridescenceShift;
+    return getSnapshot()->iridescenceShift;
 }
 
 void FlorbConfigs::setIridescenceShift(float s) {
-    LOCK_CONFIGS;
-    iridescenceShift = s;
+    UPDATE_CONFIGS;
+    state.iridescenceShift = s;
 }
 
 
 // Vignette accessors / mutators
 
 float FlorbConfigs::getVignetteRadius() const {
-    LOCK_CONFIGS;
-    return vignetteRadius;
+    return getSnapshot()->vignetteRadius;
 }
 
 void FlorbConfigs::setVignetteRadius(float r) {
-    LOCK_CONFIGS;
-    vignetteRadius = r;
+    UPDATE_CONFIGS;
+    state.vignetteRadius = r;
 }
 
 float FlorbConfigs::getVignetteExponent() const {
-    LOCK_CONFIGS;
-    return vignetteExponent;
+    return getSnapshot()->vignetteExponent;
 }
 
 void FlorbConfigs::setVignetteExponent(float r) {
-    LOCK_CONFIGS;
-    vignetteExponent = r;
+    UPDATE_CONFIGS;
+    state.vignetteExponent = r;
 }
 
 
 // Mote accessors / mutators
 
 unsigned int FlorbConfigs::getMoteCount() const {
-    LOCK_CONFIGS;
-    return moteCount;
+    return getSnapshot()->moteCount;
 }
 
 void FlorbConfigs::setMoteCount(unsigned int c) {
-    LOCK_CONFIGS;
-    moteCount = c;
+    UPDATE_CONFIGS;
+    state.moteCount = c;
 }
 
 float FlorbConfigs::getMotesRadius() const {
-    LOCK_CONFIGS;
-    return motesRadius;
+    return getSnapshot()->motesRadius;
 }
 
 void FlorbConfigs::setMotesRadius(float r) {
-    LOCK_CONFIGS;
-    motesRadius = r;
+    UPDATE_CONFIGS;
+    state.motesRadius = r;
 }    
 
 float FlorbConfigs::getMotesMaxStep() const {
-    LOCK_CONFIGS;
-    return motesMaxStep;
+    return getSnapshot()->motesMaxStep;
 }
 
 void FlorbConfigs::setMotesMaxStep(float s) {
-    LOCK_CONFIGS;
-    motesMaxStep = s;
+    UPDATE_CONFIGS;
+    state.motesMaxStep = s;
 }
 
 
 bool FlorbConfigs::getMotesWinkingEnabled() const {
-    LOCK_CONFIGS;
-    return motesWinkingEnabled;
+    return getSnapshot()->motesWinkingEnabled;
 }
 
 void FlorbConfigs::setMotesWinkingEnabled(bool e) {
-    LOCK_CONFIGS;
-    motesWinkingEnabled = e;
+    UPDATE_CONFIGS;
+    state.motesWinkingEnabled = e;
 }
 
 float FlorbConfigs::getMotesWinkingMaxOff() const {
-    LOCK_CONFIGS;
-    return motesMaxOff;
+    return getSnapshot()->motesMaxOff;
 }
 
 void FlorbConfigs::setMotesWinkingMaxOff(float m) {
-    LOCK_CONFIGS;
-    motesMaxOff = m;
+    UPDATE_CONFIGS;
+    state.motesMaxOff = m;
 }
 
-const vector<float>& FlorbConfigs::getMotesColor() const {
-    LOCK_CONFIGS;
-    return motesColor;
+vector<float> FlorbConfigs::getMotesColor() const {
+    return getSnapshot()->motesColor;
 }
 
 void FlorbConfigs::setMotesColor(float r, float g, float b) {
-    LOCK_CONFIGS;
-    motesColor[0] = r;
-    motesColor[1] = g;
-    motesColor[2] = b;
+    UPDATE_CONFIGS;
+    state.motesColor[0] = r;
+    state.motesColor[1] = g;
+    state.motesColor[2] = b;
 }
 
 
 // Flutter accessors / mutators
 
 bool FlorbConfigs::getFlutterEnabled(void) const {
-    LOCK_CONFIGS;
-    return flutterEnabled;
+    return getSnapshot()->flutterEnabled;
 }
 
 void FlorbConfigs::setFlutterEnabled(bool e) {
-    LOCK_CONFIGS;
-    flutterEnabled = e;
+    UPDATE_CONFIGS;
+    state.flutterEnabled = e;
 }
 
 float FlorbConfigs::getFlutterAmplitude(void) const {
-    LOCK_CONFIGS;
-    return flutterAmplitude;
+    return getSnapshot()->flutterAmplitude;
 }
 
 void FlorbConfigs::setFlutterAmplitude(float a) {
-    LOCK_CONFIGS;
-    flutterAmplitude = a;
+    UPDATE_CONFIGS;
+    state.flutterAmplitude = a;
 }
 
 float FlorbConfigs::getFlutterFrequency(void) const {
-    LOCK_CONFIGS;
-    return flutterFrequency;
+    return getSnapshot()->flutterFrequency;
 }
 
 void FlorbConfigs::setFlutterFrequency(float f) {
-    LOCK_CONFIGS;
-    flutterFrequency = f;
+    UPDATE_CONFIGS;
+    state.flutterFrequency = f;
 }
 
 float FlorbConfigs::getFlutterSpeed(void) const {
-    LOCK_CONFIGS;
-    return flutterSpeed;
+    return getSnapshot()->flutterSpeed;
 }
 
 void FlorbConfigs::setFlutterSpeed(float s) {
-    LOCK_CONFIGS;
-    flutterSpeed = s;
+    UPDATE_CONFIGS;
+    state.flutterSpeed = s;
 }
 
 
 // Debug accessors / mutators
 
 FlorbConfigs::AnisotropicMode FlorbConfigs::getAnisotropicMode() const {
-    LOCK_CONFIGS;
-    return anisotropicMode;
+    return getSnapshot()->anisotropicMode;
 }
 
 void FlorbConfigs::setAnisotropicMode(FlorbConfigs::AnisotropicMode m) {
-    LOCK_CONFIGS;
-    anisotropicMode = m;
+    UPDATE_CONFIGS;
+    state.anisotropicMode = m;
 }
 
 FlorbConfigs::RenderMode FlorbConfigs::getRenderMode() const {
-    LOCK_CONFIGS;
-    return renderMode;
+    return getSnapshot()->renderMode;
 }
 
 void FlorbConfigs::setRenderMode(FlorbConfigs::RenderMode r) {
-    LOCK_CONFIGS;
-    renderMode = r;
+    UPDATE_CONFIGS;
+    state.renderMode = r;
 }
 
 FlorbConfigs::SpecularMode FlorbConfigs::getSpecularMode() const {
-    LOCK_CONFIGS;
-    return specularMode;
+    return getSnapshot()->specularMode;
 }
 
 void FlorbConfigs::setSpecularMode(FlorbConfigs::SpecularMode s) {
-    LOCK_CONFIGS;
-    specularMode = s;
+    UPDATE_CONFIGS;
+    state.specularMode = s;
+}
+
+
+bool FlorbConfigs::getUniformStats() const {
+    return getSnapshot()->uniformStats;
+}
+
+void FlorbConfigs::setUniformStats(bool u) {
+    UPDATE_CONFIGS;
+    state.uniformStats = u;
+}
+
+bool FlorbConfigs::getFrameStats() const {
+    return getSnapshot()->frameStats;
+}
+
+void FlorbConfigs::setFrameStats(bool f) {
+    UPDATE_CONFIGS;
+    state.frameStats = f;
+}
+
+bool FlorbConfigs::getGLCounters() const {
+    return getSnapshot()->glCounters;
+}
+
+void FlorbConfigs::setGLCounters(bool g) {
+    UPDATE_CONFIGS;
+    state.glCounters = g;
+}
+
+bool FlorbConfigs::getGLDebug() const {
+    return getSnapshot()->glDebug;
+}
+
+void FlorbConfigs::setGLDebug(bool g) {
+    UPDATE_CONFIGS;
+    state.glDebug = g;
+}
+
+bool FlorbConfigs::getGLSynchronous() const {
+    return getSnapshot()->glSynchronous;
+}
+
+void FlorbConfigs::setGLSynchronous(bool g) {
+    UPDATE_CONFIGS;
+    state.glSynchronous = g;
+}
+
+bool FlorbConfigs::getProfileEnabled() const {
+    return getSnapshot()->profileEnabled;
+}
+
+void FlorbConfigs::setProfileEnabled(bool e) {
+    UPDATE_CONFIGS;
+    state.profileEnabled = e;
+}
+
+string FlorbConfigs::getProfilePath() const {
+    return getSnapshot()->profilePath;
+}
+
+void FlorbConfigs::setProfilePath(const string &p) {
+    UPDATE_CONFIGS;
+    state.profilePath = p;
+}
+
+float FlorbConfigs::getProfileInterval() const {
+    return getSnapshot()->profileInterval;
+}
+
+void FlorbConfigs::setProfileInterval(float i) {
+    UPDATE_CONFIGS;
+    if (i > 0.0f) state.profileInterval = i;
+}
+
+bool FlorbConfigs::getProfileCounters() const {
+    return getSnapshot()->profileCounters;
+}
+
+void FlorbConfigs::setProfileCounters(bool c) {
+    UPDATE_CONFIGS;
+    state.profileCounters = c;
+}
+
+bool FlorbConfigs::getRecorderEnabled() const {
+    return getSnapshot()->recorderEnabled;
+}
+
+void FlorbConfigs::setRecorderEnabled(bool e) {
+    UPDATE_CONFIGS;
+    state.recorderEnabled = e;
+}
+
+float FlorbConfigs::getRecorderWindow() const {
+    return getSnapshot()->recorderWindow;
+}
+
+void FlorbConfigs::setRecorderWindow(float w) {
+    UPDATE_CONFIGS;
+    if (w > 0.0f) state.recorderWindow = w;
+}
+
+float FlorbConfigs::getRecorderThreshold() const {
+    return getSnapshot()->recorderThreshold;
+}
+
+void FlorbConfigs::setRecorderThreshold(float t) {
+    UPDATE_CONFIGS;
+    if (t > 1.0f) state.recorderThreshold = t;
+}
+
+string FlorbConfigs::getRecorderDirectory() const {
+    return getSnapshot()->recorderDirectory;
+}
+
+void FlorbConfigs::setRecorderDirectory(const string &d) {
+    UPDATE_CONFIGS;
+    state.recorderDirectory = d;
+}
+
+bool FlorbConfigs::getResourcesEnabled() const {
+    return getSnapshot()->resourcesEnabled;
+}
+
+void FlorbConfigs::setResourcesEnabled(bool e) {
+    UPDATE_CONFIGS;
+    state.resourcesEnabled = e;
+}
+
+string FlorbConfigs::getResourcesPath() const {
+    return getSnapshot()->resourcesPath;
+}
+
+void FlorbConfigs::setResourcesPath(const string &p) {
+    UPDATE_CONFIGS;
+    state.resourcesPath = p;
+}
+
+float FlorbConfigs::getResourcesInterval() const {
+    return getSnapshot()->resourcesInterval;
+}
+
+void FlorbConfigs::setResourcesInterval(float i) {
+    UPDATE_CONFIGS;
+    if (i > 0.0f) state.resourcesInterval = i;
 }
 
 
 // Private methods
 
-void FlorbConfigs::parseSpotlights(const json &light) {            
+void FlorbConfigs::parseSpotlights(const json &light, Snapshot &state) {            
     if (light.contains("spotlights") and light["spotlights"].is_array()) {
         const auto &spotlights(light["spotlights"]);
     
@@ -1141,7 +1586,7 @@ void FlorbConfigs::parseSpotlights(const json &light) {
             }
 
             // Parse any optional movement object
-            shared_ptr<LinearMotion> motionPtr;
+            shared_ptr<MultiMotion> motionPtr;
             if (spotlight.contains("motion") and spotlight["motion"].is_object()) {
                 const auto &motion(spotlight["motion"]);
 
@@ -1169,6 +1614,26 @@ void FlorbConfigs::parseSpotlights(const json &light) {
                         }
 
                         motionPtr = make_shared<LinearMotion>(enabled, offsets, speeds);
+                    } else if (type == "expression") {
+                        vector<string> expressions(3, "0");
+
+                        if (motion.contains("expressions") and motion["expressions"].is_array()) {
+                            const auto &expressionsRef(motion["expressions"]);
+
+                            for (size_t i = 0; (i < expressionsRef.size()) and (i < 3); i++) {
+                                if (expressionsRef[i].is_string()) expressions[i] = expressionsRef[i];
+                            }
+                        }
+
+                        try {
+                            motionPtr = make_shared<ExpressionMotion>(enabled, expressions);
+                        } catch (const exception &exc) {
+                            cerr << "[WARN] Spotlight \""
+                                 << name
+                                 << "\" motion ignored: "
+                                 << exc.what()
+                                 << endl;
+                        }
                     } else {
                         cerr << "Unrecognized \"motion\" type \"" << type << "\"" << endl;
                     }
@@ -1176,7 +1641,7 @@ void FlorbConfigs::parseSpotlights(const json &light) {
             } // motion parsing
 
             // Create the new spotlight and push it onto our collection
-            this->spotlights.push_back(make_shared<Spotlight>(name,
+            state.spotlights.push_back(make_shared<Spotlight>(name,
                                                               direction,
                                                               intensity,
                                                               color,
@@ -1186,3 +1651,55 @@ void FlorbConfigs::parseSpotlights(const json &light) {
         }
     } // spotlight configs
 }
+
+
+vector<pair<float, float>> FlorbConfigs::parseKeyframes(const json &keyframes) {
+    vector<pair<float, float>> parsed;
+
+    // Keyframes are [time, value] pairs, in order of increasing time
+    for (const auto &keyframe : keyframes) {
+        if (keyframe.is_array() and (keyframe.size() == 2) and
+            keyframe[0].is_number() and keyframe[1].is_number()) {
+            parsed.emplace_back(keyframe[0], keyframe[1]);
+        } else {
+            cerr << "[WARN] Ignoring malformed keyframe " << keyframe.dump() << endl;
+        }
+    }
+
+    return parsed;
+}
+
+
+// Implementation of class FlorbConfigs::Writer
+
+FlorbConfigs::Writer::Writer(FlorbConfigs &configs) :
+    configs(configs),
+    owner(false) {
+
+    configs.writerMutex.lock();
+
+    // The outermost writer stages a private copy of the published snapshot
+    if (!configs.pending) {
+        configs.pending = make_shared<Snapshot>(*atomic_load(&configs.snapshot));
+        owner = true;
+    }
+}
+
+FlorbConfigs::Writer::~Writer() {
+    if (owner) {
+        auto published(configs.version.load(std::memory_order_relaxed) + 1UL);
+        configs.pending->version = published;
+
+        // Publish the snapshot before its version, so readers never miss it
+        atomic_store(&configs.snapshot, shared_ptr<const Snapshot>(configs.pending));
+        configs.version.store(published, std::memory_order_release);
+
+        configs.pending.reset();
+    }
+
+    configs.writerMutex.unlock();
+}
+
+FlorbConfigs::Snapshot& FlorbConfigs::Writer::getState() {
+    return *configs.pending;
+}
@@ -1,13 +1,17 @@
 #include <X11/Xlib.h>
 #include <X11/Xatom.h>
 #include <X11/Xutil.h>
+#include <EGL/egl.h>
 #include <GL/glew.h>
 #include <GL/glu.h>
+#include <GL/glx.h>
+#include <atomic>
 #include <iomanip>
 #include <string>
 #include <vector> 
 
 #include "FlorbUtils.h"
+#include "GLDebug.h"
 #include "stb_image.h"
 
 namespace chrono = std::chrono;
@@ -26,6 +30,8 @@ using std::time_t;
 using std::tm;
 using std::vector;
 
+static std::atomic<unsigned long> glErrors(0UL);
+
 GLuint FlorbUtils::createTexture(uint32_t r, uint32_t g, uint32_t b, uint32_t a) {
     GLuint textureID;
     unsigned char color[] = { r, g, b, a };
@@ -72,6 +78,9 @@ void FlorbUtils::dumpTexture(GLuint textureID,
 }
 
 void FlorbUtils::setWindowTitle(Display *display, Window window, const string &title) {
+    // Headless rendering has no window to title
+    if (!display) return;
+
     XStoreName(display, window, title.c_str());
 
     // Set modern window manager title
@@ -83,11 +92,22 @@ void FlorbUtils::setWindowTitle(Display *display, Window window, const string &t
     }
 }
 
+bool FlorbUtils::hasCurrentContext() {
+    return (glXGetCurrentContext() or (eglGetCurrentContext() != EGL_NO_CONTEXT));
+}
+
 void FlorbUtils::glCheck(const string &str) {
+    // Each glGetError may wait on the driver, so errors otherwise arrive
+    // through GLDebug, once a frame; its callback, where installed, reports
+    // each error itself, within the call when synchronous
+    if (!GLDebug::isSynchronous() or GLDebug::isAvailable()) return;
+
     GLenum err;
   
     while ((err = glGetError()) != GL_NO_ERROR) {
       const GLubyte* errStr = gluErrorString(err);
+
+      glErrors.fetch_add(1UL, std::memory_order_relaxed);
       
       cerr << "[" << str << " : GL ERROR (";
       
@@ -114,3 +134,7 @@ void FlorbUtils::glCheck(const string &str) {
            << endl;
     }
 }
+
+unsigned long FlorbUtils::glErrorCount() {
+    return (glErrors.load(std::memory_order_relaxed) + GLDebug::getErrorCount());
+}
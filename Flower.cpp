@@ -4,6 +4,8 @@
 
 #include "Flower.h"
 #include "FlorbUtils.h"
+#include "GLDebug.h"
+#include "Tracer.h"
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
@@ -24,17 +26,28 @@ Flower::~Flower() {
 }
 
 void Flower::loadImage() {
-    stbi_set_flip_vertically_on_load(false);
-    int width, height, channels;
-    unsigned char* data = stbi_load(filename.c_str(), &width, &height, &channels, 0);
+    unsigned char* data;
+    {
+        Tracer::Scope scope("flowers", "decode");
+
+        traceFlow = Tracer::newFlow();
+        Tracer::flowBegin("flowers", "texture", traceFlow);
+
+        stbi_set_flip_vertically_on_load(false);
+        data = stbi_load(filename.c_str(), &width, &height, &channels, 0);
+    }
     
     if (!data) {
         throw std::runtime_error("Failed to load image: " + filename);
     }
 
-    GLenum format;
+    Tracer::Scope scope("flowers", "upload");
+    Tracer::flowStep("flowers", "texture", traceFlow);
+
     if (channels == 1)
         format = GL_RED;
+    else if (channels == 2)
+        format = GL_RG;
     else if (channels == 3)
         format = GL_RGB;
     else if (channels == 4)
@@ -51,21 +64,27 @@ void Flower::loadImage() {
 
     glBindTexture(GL_TEXTURE_2D, textureID);
     FlorbUtils::glCheck("glBindTexture()");
+    GLDebug::label(GL_TEXTURE, textureID, filename);
 
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     
+    // Grey images, with or without alpha, are sampled as grey
+    if (channels == 1) {
+        const GLint swizzle[] = { GL_RED, GL_RED, GL_RED, GL_ONE };
+        glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+    } else if (channels == 2) {
+        const GLint swizzle[] = { GL_RED, GL_RED, GL_RED, GL_GREEN };
+        glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+    }
+
     glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 
     glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
     FlorbUtils::glCheck("glTexImage2D()");
 
-    GLint texWidth = 0, texHeight = 0;
-    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &texWidth);
-    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &texHeight);
-    
     glBindTexture(GL_TEXTURE_2D, 0);
 
     stbi_image_free(data);
@@ -110,6 +129,13 @@ GLenum Flower::getFormat() const {
     return format;
 }
 
+void Flower::markDisplayed() {
+    if (traceFlow == 0) return;
+
+    Tracer::flowEnd("flowers", "texture", traceFlow);
+    traceFlow = 0;
+}
+
 Flower& Flower::operator=(const Flower& other) {
     if (this != &other) {
         filename = other.filename;
@@ -0,0 +1,121 @@
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+
+#include "FrameHistogram.h"
+
+// Namespace using directives
+
+using std::int64_t;
+using std::max;
+using std::min;
+using std::ostream;
+using std::uint64_t;
+
+
+// Implementation of class FrameHistogram
+
+// Constructor
+
+FrameHistogram::FrameHistogram(int64_t binWidth, size_t binCount) :
+    binWidth(binWidth),
+    bins(binCount, 0U),
+    count(0U),
+    sum(0.0),
+    sumSquares(0.0),
+    minimum(std::numeric_limits<int64_t>::max()),
+    maximum(0) { }
+
+
+// Public methods
+
+void FrameHistogram::add(int64_t interval) {
+    interval = max(interval, static_cast<int64_t>(0));
+
+    auto bin(min(static_cast<size_t>(interval / binWidth), (bins.size() - 1)));
+    bins[bin]++;
+
+    count++;
+    sum += interval;
+    sumSquares += (static_cast<double>(interval) * interval);
+
+    minimum = min(minimum, interval);
+    maximum = max(maximum, interval);
+}
+
+void FrameHistogram::clear() {
+    std::fill(bins.begin(), bins.end(), 0U);
+
+    count = 0U;
+    sum = 0.0;
+    sumSquares = 0.0;
+    minimum = std::numeric_limits<int64_t>::max();
+    maximum = 0;
+}
+
+
+// Accessors
+
+uint64_t FrameHistogram::getCount() const {
+    return count;
+}
+
+double FrameHistogram::getMean() const {
+    return ((count > 0U) ? (sum / count) : 0.0);
+}
+
+double FrameHistogram::getStandardDeviation() const {
+    if (count < 2U) return 0.0;
+
+    double mean(getMean());
+
+    return std::sqrt(max(((sumSquares / count) - (mean * mean)), 0.0));
+}
+
+int64_t FrameHistogram::getMinimum() const {
+    return ((count > 0U) ? minimum : 0);
+}
+
+int64_t FrameHistogram::getMaximum() const {
+    return maximum;
+}
+
+int64_t FrameHistogram::getPercentile(double fraction) const {
+    if (count == 0U) return 0;
+
+    auto target(static_cast<uint64_t>(std::ceil(fraction * count)));
+    uint64_t seen(0U);
+
+    for (size_t i = 0; i < bins.size(); i++) {
+        seen += bins[i];
+        if (seen >= target) return min((static_cast<int64_t>(i + 1) * binWidth), maximum);
+    }
+
+    return maximum;
+}
+
+uint64_t FrameHistogram::countAbove(int64_t threshold) const {
+    uint64_t above(0U);
+
+    // Whole bins from the first starting at or beyond the threshold
+    auto first(max(((threshold + binWidth - 1) / binWidth), static_cast<int64_t>(0)));
+    for (size_t i = static_cast<size_t>(first); i < bins.size(); i++) above += bins[i];
+
+    return above;
+}
+
+void FrameHistogram::report(ostream &stream) const {
+    const double k_Millis(1.0e-6);
+
+    stream << std::fixed << std::setprecision(3)
+           << "frames " << count
+           << ", mean " << (getMean() * k_Millis)
+           << " ms, sd " << (getStandardDeviation() * k_Millis)
+           << " ms, min " << (getMinimum() * k_Millis)
+           << " ms, p50 " << (getPercentile(0.50) * k_Millis)
+           << " ms, p99 " << (getPercentile(0.99) * k_Millis)
+           << " ms, max " << (getMaximum() * k_Millis)
+           << " ms"
+           << std::defaultfloat;
+}
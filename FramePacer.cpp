@@ -0,0 +1,323 @@
+#include <GL/glew.h>
+#include <GL/glx.h>
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "FramePacer.h"
+
+// Namespace using directives
+
+using std::cout;
+using std::endl;
+using std::int32_t;
+using std::int64_t;
+using std::string;
+
+
+// Implementation of class FramePacer
+
+// Static attribute initialization
+
+// Final stretch before a deadline spent spinning rather than asleep, covering
+// the scheduler's wakeup latency
+const int64_t FramePacer::k_SpinTail(250000);
+
+const int64_t FramePacer::k_ReportInterval(5000000000);
+
+// Bound on a single wait for the GPU, so a lost context cannot hang the loop
+const GLuint64 FramePacer::k_FenceTimeout(1000000000);
+
+const float FramePacer::k_MaxRate(240.0f);
+
+
+// Constructor
+
+FramePacer::FramePacer(Display *display, GLXDrawable drawable) :
+    display(display),
+    drawable(drawable),
+    rate(0.0f),
+    vsync(false),
+    reporting(false),
+    period(0),
+    deadline(0),
+    lastPresent(0),
+    lastReport(now()),
+    refreshRate(0.0),
+    targetMsc(0),
+    histogram(),
+    framesInFlight(0U),
+    inputTime(0),
+    inFlight(),
+    latency(),
+    glXSwapIntervalEXT(nullptr),
+    glXSwapIntervalMESA(nullptr),
+    glXGetSyncValuesOML(nullptr),
+    glXGetMscRateOML(nullptr),
+    glXSwapBuffersMscOML(nullptr) {
+
+    if (display) initExtensions();
+    setRate(60.0f);
+    applySwapControl();
+}
+
+
+// Public methods
+
+void FramePacer::setRate(float r) {
+    r = std::min(std::max(r, 1.0f), k_MaxRate);
+    if (r == rate) return;
+
+    rate = r;
+    period = static_cast<int64_t>(std::llround(1.0e9 / rate));
+
+    // Restart the deadline sequence from the next present
+    deadline = 0;
+    targetMsc = 0;
+
+    if (vsync) applySwapControl();
+}
+
+void FramePacer::setVsync(bool v) {
+    if (v == vsync) return;
+
+    vsync = v;
+    deadline = 0;
+    targetMsc = 0;
+
+    applySwapControl();
+}
+
+void FramePacer::setReporting(bool r) {
+    reporting = r;
+}
+
+void FramePacer::setFramesInFlight(unsigned int frames) {
+    framesInFlight = frames;
+
+    if (framesInFlight == 0U) {
+        for (const auto &frame : inFlight) glDeleteSync(frame.fence);
+        inFlight.clear();
+    }
+}
+
+void FramePacer::markInput() {
+    inputTime = now();
+}
+
+void FramePacer::present() {
+    if (!display) {
+        // Offscreen; there is nothing to swap, and no reason to wait
+        glFlush();
+    } else if (vsync and glXSwapBuffersMscOML and (refreshRate > 0.0)) {
+        // Target an exact multiple of refresh intervals after the last swap
+        auto divisor(std::max(static_cast<int64_t>(std::llround(refreshRate / rate)),
+                              static_cast<int64_t>(1)));
+
+        int64_t ust(0);
+        int64_t msc(0);
+        int64_t sbc(0);
+        glXGetSyncValuesOML(display, drawable, &ust, &msc, &sbc);
+
+        // Resynchronize when a frame ran late and missed its target
+        if ((targetMsc == 0) or (targetMsc <= msc)) targetMsc = msc;
+        targetMsc += divisor;
+
+        glXSwapBuffersMscOML(display, drawable, targetMsc, 0, 0);
+    } else if (vsync) {
+        glXSwapBuffers(display, drawable);
+    } else {
+        // Let the GPU start on this frame while the CPU waits
+        glFlush();
+
+        auto current(now());
+        if ((deadline == 0) or (current > (deadline + period))) {
+            // First frame, or more than a whole period late; re-anchor
+            // instead of rushing a burst of frames to catch up
+            deadline = current;
+        } else {
+            deadline += period;
+            waitUntil(deadline);
+        }
+
+        glXSwapBuffers(display, drawable);
+    }
+
+    // Fence the frame, then hold the CPU back until no more than the allowed
+    // number of frames remain queued
+    if (framesInFlight > 0U) {
+        auto fence(glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+        if (fence) inFlight.push_back({ fence, ((inputTime != 0) ? inputTime : now()) });
+
+        retireFrames();
+    }
+
+    auto presented(now());
+    if (lastPresent != 0) histogram.add(presented - lastPresent);
+    lastPresent = presented;
+
+    // A hitch re-anchors the deadline sequence, rather than bunching up the
+    // frames which follow it
+    if (!vsync and ((presented - deadline) > (period / 2))) deadline = presented;
+
+    if (reporting and ((presented - lastReport) >= k_ReportInterval)) {
+        cout << "[INFO] Frame pacing ("
+             << (!display ? "offscreen" : (vsync ? "vsync" : "timer"));
+        if (display) cout << ", " << rate << " Hz";
+        cout << ") : ";
+        histogram.report(cout);
+        if (display) cout << ", late " << histogram.countAbove(period + (period / 2));
+        cout << endl;
+
+        if (latency.getCount() > 0) {
+            cout << "[INFO] Input latency ("
+                 << framesInFlight
+                 << " in flight) : ";
+            latency.report(cout);
+            cout << endl;
+        }
+
+        histogram.clear();
+        latency.clear();
+        lastReport = presented;
+    }
+}
+
+
+// Accessors
+
+const FrameHistogram& FramePacer::getHistogram() const {
+    return histogram;
+}
+
+const FrameHistogram& FramePacer::getLatencyHistogram() const {
+    return latency;
+}
+
+float FramePacer::getRate() const {
+    return rate;
+}
+
+bool FramePacer::getVsync() const {
+    return vsync;
+}
+
+int64_t FramePacer::now() {
+    timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    return ((static_cast<int64_t>(time.tv_sec) * 1000000000) + time.tv_nsec);
+}
+
+
+// Private methods
+
+void FramePacer::initExtensions() {
+    string extensions(glXQueryExtensionsString(display, DefaultScreen(display)));
+    auto supported = [&extensions](const char *name) {
+        return (extensions.find(name) != string::npos);
+    };
+
+    auto address = [](const char *name) {
+        return glXGetProcAddress(reinterpret_cast<const GLubyte*>(name));
+    };
+
+    if (supported("GLX_EXT_swap_control")) {
+        glXSwapIntervalEXT = (glXSwapIntervalEXTProc)address("glXSwapIntervalEXT");
+    }
+
+    if (supported("GLX_MESA_swap_control")) {
+        glXSwapIntervalMESA = (glXSwapIntervalMESAProc)address("glXSwapIntervalMESA");
+    }
+
+    if (supported("GLX_OML_sync_control")) {
+        glXGetSyncValuesOML = (glXGetSyncValuesOMLProc)address("glXGetSyncValuesOML");
+        glXGetMscRateOML = (glXGetMscRateOMLProc)address("glXGetMscRateOML");
+        glXSwapBuffersMscOML = (glXSwapBuffersMscOMLProc)address("glXSwapBuffersMscOML");
+
+        int32_t numerator(0);
+        int32_t denominator(0);
+        if (glXGetSyncValuesOML and glXGetMscRateOML and glXSwapBuffersMscOML and
+            glXGetMscRateOML(display, drawable, &numerator, &denominator) and
+            (denominator > 0)) {
+            refreshRate = (static_cast<double>(numerator) / denominator);
+        } else {
+            glXSwapBuffersMscOML = nullptr;
+        }
+    }
+}
+
+void FramePacer::applySwapControl() {
+    if (!display) {
+        cout << "[INFO] Frame pacing unthrottled (offscreen)" << endl;
+        return;
+    }
+
+    // OML swaps are scheduled explicitly, so the swap interval stays at zero
+    int interval(0);
+    if (vsync and !glXSwapBuffersMscOML) {
+        interval = 1;
+
+        if (refreshRate > 0.0) {
+            interval = std::max(static_cast<int>(std::lround(refreshRate / rate)), 1);
+        }
+    }
+
+    if (glXSwapIntervalEXT) {
+        glXSwapIntervalEXT(display, drawable, interval);
+    } else if (glXSwapIntervalMESA) {
+        glXSwapIntervalMESA(interval);
+    }
+
+    cout << "[INFO] Frame pacing "
+         << (!vsync ? "by timer" :
+             (glXSwapBuffersMscOML ? "locked to vsync (OML)" : "locked to vsync"))
+         << endl;
+}
+
+void FramePacer::retireFrames() {
+    // Collect frames the GPU has already finished, without blocking
+    while (!inFlight.empty()) {
+        auto status(glClientWaitSync(inFlight.front().fence, 0, 0));
+        if ((status != GL_ALREADY_SIGNALED) and (status != GL_CONDITION_SATISFIED)) break;
+
+        retire(inFlight.front());
+        inFlight.pop_front();
+    }
+
+    // Block on the oldest frames while too many remain queued
+    while (inFlight.size() > framesInFlight) {
+        glClientWaitSync(inFlight.front().fence, GL_SYNC_FLUSH_COMMANDS_BIT, k_FenceTimeout);
+
+        retire(inFlight.front());
+        inFlight.pop_front();
+    }
+}
+
+void FramePacer::retire(const InFlight &frame) {
+    // Completion is observed no later than now, and no earlier than the last
+    // poll, so the latency is an upper bound within one frame
+    latency.add(now() - frame.input);
+
+    glDeleteSync(frame.fence);
+}
+
+void FramePacer::waitUntil(int64_t target) const {
+    // Sleep to just short of the deadline, absorbing signal interruptions
+    auto wake(toTimespec(target - k_SpinTail));
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake, nullptr) == EINTR) { }
+
+    // Spin away the remainder for sub-scheduler-tick precision
+    while (now() < target) { }
+}
+
+timespec FramePacer::toTimespec(int64_t time) {
+    timespec result;
+    result.tv_sec = static_cast<time_t>(time / 1000000000);
+    result.tv_nsec = static_cast<long>(time % 1000000000);
+
+    return result;
+}
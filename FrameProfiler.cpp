@@ -0,0 +1,512 @@
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <time.h>
+
+#include "FrameProfiler.h"
+#include "Tracer.h"
+
+// Namespace using directives
+
+namespace chrono = std::chrono;
+namespace fs = std::filesystem;
+
+using std::cerr;
+using std::endl;
+using std::error_code;
+using std::int64_t;
+using std::lock_guard;
+using std::mutex;
+using std::ofstream;
+using std::string;
+using std::thread;
+using std::uint64_t;
+using std::unique_lock;
+using std::vector;
+
+
+// Implementation of class FrameProfiler
+
+// Static attribute initialization
+
+const unsigned int FrameProfiler::k_NoStage(~0U);
+
+
+// Scoped timers
+
+FrameProfiler::Scope::Scope(FrameProfiler &profiler, unsigned int stage) :
+    profiler(profiler),
+    stage(stage),
+    counted(profiler.counting and profiler.counters.read(counts)),
+    start(now()) { }
+
+FrameProfiler::Scope::~Scope() {
+    profiler.endStage(stage, start);
+
+    if (counted) profiler.addCounts(stage, counts);
+}
+
+FrameProfiler::GpuScope::GpuScope(FrameProfiler &profiler, unsigned int stage) :
+    profiler(profiler),
+    active(profiler.beginGpu(stage)) { }
+
+FrameProfiler::GpuScope::~GpuScope() {
+    if (active) profiler.endGpu();
+}
+
+
+// Constructor / destructor
+
+FrameProfiler::FrameProfiler() :
+    enabled(false),
+    stageCount(0U),
+    current(),
+    last(),
+    frame(0UL),
+    gpuTimers(),
+    activeGpu(k_NoStage),
+    counters(),
+    counting(false),
+    countersFailed(false),
+    ring(),
+    valueCount(0U),
+    stageNames(),
+    valueNames(),
+    valueUnits(),
+    dumpPath(),
+    dumpInterval(5000),
+    running(true),
+    undumped(false),
+    undumpedFrame(0UL),
+    cpuWindows(k_MaxStages, Window { vector<int64_t>(), 0, 0UL }),
+    gpuWindows(k_MaxStages, Window { vector<int64_t>(), 0, 0UL }),
+    counterWindows((k_MaxStages * k_MaxCounters), Window { vector<int64_t>(), 0, 0UL }),
+    valueWindows(k_MaxValues, Window { vector<int64_t>(), 0, 0UL }),
+    counterNames(),
+    wakeMutex(),
+    wake(),
+    dumper() {
+
+    std::fill(current.cpu, (current.cpu + k_MaxStages), -1);
+    std::fill(current.gpu, (current.gpu + k_MaxStages), -1);
+    std::fill(&current.counters[0][0], (&current.counters[0][0] + (k_MaxStages * k_MaxCounters)), -1);
+    std::fill(current.values, (current.values + k_MaxValues), -1);
+    last = current;
+
+    // Stage names are handed to the tracer by pointer, so must never move
+    stageNames.reserve(k_MaxStages);
+
+    dumper = thread(&FrameProfiler::dump, this);
+}
+
+FrameProfiler::~FrameProfiler() {
+    {
+        lock_guard<mutex> lock(wakeMutex);
+        running = false;
+    }
+
+    wake.notify_all();
+    dumper.join();
+
+    // The frames since the last dump are written out too, so that a run's
+    // final summary covers it to the end, whether the dump thread or this
+    // drained them
+    FrameRecord record;
+    while (ring.pop(record)) {
+        accumulate(record);
+        undumpedFrame = record.frame;
+        undumped = true;
+    }
+
+    if (undumped and !dumpPath.empty()) write(dumpPath, undumpedFrame);
+
+    for (auto &timer : gpuTimers) {
+        if (timer.queries[0] != 0) glDeleteQueries(k_QueryBuffers, timer.queries);
+    }
+}
+
+
+// Public methods
+
+unsigned int FrameProfiler::addStage(const string &name) {
+    if (stageCount >= k_MaxStages) {
+        cerr << "[WARN] Too many profiler stages, ignoring \"" << name << "\"" << endl;
+        return k_NoStage;
+    }
+
+    {
+        lock_guard<mutex> lock(wakeMutex);
+        stageNames.push_back(name);
+    }
+
+    GpuTimer timer = {};
+    gpuTimers.push_back(timer);
+
+    return stageCount++;
+}
+
+unsigned int FrameProfiler::addValue(const string &name, const char *unit) {
+    if (valueCount >= k_MaxValues) {
+        cerr << "[WARN] Too many profiler values, ignoring \"" << name << "\"" << endl;
+        return k_NoStage;
+    }
+
+    {
+        lock_guard<mutex> lock(wakeMutex);
+        valueNames.push_back(name);
+        valueUnits.push_back(unit);
+    }
+
+    return valueCount++;
+}
+
+void FrameProfiler::setValue(unsigned int value, int64_t sample) {
+    if (value < valueCount) current.values[value] = sample;
+}
+
+void FrameProfiler::setEnabled(bool e) {
+    enabled = e;
+}
+
+void FrameProfiler::setCounters(bool c) {
+    if (!c) {
+        counting = false;
+        return;
+    }
+
+    // Counters which could not be opened are not retried every frame
+    if (!counters.isOpen() and !countersFailed) {
+        countersFailed = !counters.open();
+
+        lock_guard<mutex> lock(wakeMutex);
+        for (size_t i = 0; i < counters.getCount(); i++) {
+            counterNames.push_back(counters.getName(i));
+        }
+    }
+
+    counting = counters.isOpen();
+}
+
+void FrameProfiler::setDump(const string &path, float interval) {
+    auto milliseconds(chrono::milliseconds(static_cast<long>(std::max(interval, 0.1f) * 1000.0f)));
+
+    lock_guard<mutex> lock(wakeMutex);
+    if ((path == dumpPath) and (milliseconds == dumpInterval)) return;
+
+    dumpPath = path;
+    dumpInterval = milliseconds;
+    wake.notify_all();
+}
+
+void FrameProfiler::beginFrame() {
+    if (!enabled) return;
+
+    // Pick up GPU times which have become available since the last frame
+    collectGpu();
+}
+
+void FrameProfiler::endFrame() {
+    current.frame = frame++;
+    last = current;
+
+    if (enabled) ring.push(current);
+
+    std::fill(current.cpu, (current.cpu + k_MaxStages), -1);
+    std::fill(current.gpu, (current.gpu + k_MaxStages), -1);
+    std::fill(&current.counters[0][0], (&current.counters[0][0] + (k_MaxStages * k_MaxCounters)), -1);
+    std::fill(current.values, (current.values + k_MaxValues), -1);
+}
+
+void FrameProfiler::endStage(unsigned int stage, int64_t start) {
+    if (stage >= stageCount) return;
+
+    auto time(now() - start);
+
+    // Stage names are only ever appended, by this thread
+    if (Tracer::isEnabled()) Tracer::complete("frame", stageNames[stage], start, time);
+
+    auto &total(current.cpu[stage]);
+    total = ((total < 0) ? time : (total + time));
+}
+
+bool FrameProfiler::beginGpu(unsigned int stage) {
+    if (!enabled or (stage >= stageCount) or (activeGpu != k_NoStage)) return false;
+
+    auto &timer(gpuTimers[stage]);
+    if (timer.queries[0] == 0) glGenQueries(k_QueryBuffers, timer.queries);
+
+    // Skip this frame rather than stall if the buffer's last result is still pending
+    if (timer.pending[timer.next]) return false;
+
+    glBeginQuery(GL_TIME_ELAPSED, timer.queries[timer.next]);
+    activeGpu = stage;
+
+    return true;
+}
+
+void FrameProfiler::endGpu() {
+    if (activeGpu == k_NoStage) return;
+
+    glEndQuery(GL_TIME_ELAPSED);
+
+    auto &timer(gpuTimers[activeGpu]);
+    timer.pending[timer.next] = true;
+    timer.next = ((timer.next + 1) % k_QueryBuffers);
+
+    activeGpu = k_NoStage;
+}
+
+
+// Accessors
+
+bool FrameProfiler::getEnabled() const {
+    return enabled;
+}
+
+const FrameProfiler::FrameRecord& FrameProfiler::getLastFrame() const {
+    return last;
+}
+
+unsigned int FrameProfiler::getStageCount() const {
+    return stageCount;
+}
+
+const string& FrameProfiler::getStageName(unsigned int stage) const {
+    return stageNames[stage];
+}
+
+size_t FrameProfiler::getCounterCount() const {
+    return counters.getCount();
+}
+
+const char* FrameProfiler::getCounterName(size_t counter) const {
+    return counters.getName(counter);
+}
+
+int64_t FrameProfiler::now() {
+    timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    return ((static_cast<int64_t>(time.tv_sec) * 1000000000) + time.tv_nsec);
+}
+
+
+// Private methods
+
+void FrameProfiler::collectGpu() {
+    for (unsigned int stage = 0; stage < stageCount; stage++) {
+        auto &timer(gpuTimers[stage]);
+
+        for (unsigned int i = 0; i < k_QueryBuffers; i++) {
+            if (!timer.pending[i]) continue;
+
+            GLint available(GL_FALSE);
+            glGetQueryObjectiv(timer.queries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (available == GL_FALSE) continue;
+
+            GLuint64 elapsed(0);
+            glGetQueryObjectui64v(timer.queries[i], GL_QUERY_RESULT, &elapsed);
+            timer.pending[i] = false;
+
+            auto &total(current.gpu[stage]);
+            total = ((total < 0) ? static_cast<int64_t>(elapsed) :
+                     (total + static_cast<int64_t>(elapsed)));
+        }
+    }
+}
+
+void FrameProfiler::addCounts(unsigned int stage, const uint64_t *begin) {
+    if (stage >= stageCount) return;
+
+    uint64_t end[k_MaxCounters];
+    if (!counters.read(end)) return;
+
+    for (size_t i = 0; i < counters.getCount(); i++) {
+        auto &total(current.counters[stage][i]);
+        // Estimates scaled for multiplexing may step back a little
+        auto delta(std::max(static_cast<int64_t>(end[i] - begin[i]), static_cast<int64_t>(0)));
+
+        total = ((total < 0) ? delta : (total + delta));
+    }
+}
+
+void FrameProfiler::dump() {
+    unique_lock<mutex> lock(wakeMutex);
+
+    auto lastDump(chrono::steady_clock::now());
+
+    while (running) {
+        // Drain often enough that the ring never fills between dumps
+        wake.wait_for(lock, chrono::milliseconds(100));
+        if (!running) break;
+
+        FrameRecord record;
+        while (ring.pop(record)) {
+            accumulate(record);
+            undumpedFrame = record.frame;
+            undumped = true;
+        }
+
+        auto timeNow(chrono::steady_clock::now());
+        if (!undumped or dumpPath.empty() or ((timeNow - lastDump) < dumpInterval)) continue;
+
+        lastDump = timeNow;
+        undumped = false;
+
+        // File output happens without holding up the render thread's setters
+        auto path(dumpPath);
+        lock.unlock();
+        write(path, undumpedFrame);
+        lock.lock();
+    }
+}
+
+void FrameProfiler::accumulate(const FrameRecord &record) {
+    for (unsigned int stage = 0; stage < k_MaxStages; stage++) {
+        if (record.cpu[stage] >= 0) addSample(cpuWindows[stage], record.cpu[stage]);
+        if (record.gpu[stage] >= 0) addSample(gpuWindows[stage], record.gpu[stage]);
+
+        for (size_t i = 0; i < k_MaxCounters; i++) {
+            if (record.counters[stage][i] >= 0) {
+                addSample(counterWindows[(i * k_MaxStages) + stage], record.counters[stage][i]);
+            }
+        }
+    }
+
+    for (unsigned int value = 0; value < k_MaxValues; value++) {
+        if (record.values[value] >= 0) addSample(valueWindows[value], record.values[value]);
+    }
+}
+
+void FrameProfiler::write(const string &path, uint64_t lastFrame) {
+    vector<string> names;
+    vector<const char*> countNames;
+    vector<string> values;
+    vector<const char*> units;
+    {
+        lock_guard<mutex> lock(wakeMutex);
+        names = stageNames;
+        countNames = counterNames;
+        values = valueNames;
+        units = valueUnits;
+    }
+
+    bool json((fs::path(path).extension() == ".json"));
+
+    error_code error;
+    bool fresh(json or !fs::exists(path, error) or (fs::file_size(path, error) == 0));
+
+    ofstream file(path, (json ? std::ios::trunc : std::ios::app));
+    if (!file) {
+        cerr << "[WARN] Could not open profile dump \"" << path << "\"" << endl;
+        return;
+    }
+
+    file << std::fixed << std::setprecision(4);
+
+    if (json) {
+        file << "{\n  \"frame\" : " << lastFrame
+             << ",\n  \"dropped\" : " << ring.getDropped()
+             << ",\n  \"stages\" : [";
+    } else if (fresh) {
+        file << "frame,stage,source,unit,count,min,avg,p50,p90,p99,max\n";
+    }
+
+    // Times are reported in milliseconds, counters as raw counts per frame
+    bool first(true);
+    for (size_t stage = 0; stage < names.size(); stage++) {
+        writeSummary(file, json, first, lastFrame, names[stage], "cpu", "ms", 1.0e-6, cpuWindows[stage]);
+        writeSummary(file, json, first, lastFrame, names[stage], "gpu", "ms", 1.0e-6, gpuWindows[stage]);
+
+        for (size_t i = 0; i < countNames.size(); i++) {
+            writeSummary(file, json, first, lastFrame, names[stage], countNames[i], "count", 1.0,
+                         counterWindows[(i * k_MaxStages) + stage]);
+        }
+    }
+
+    // Other values are reported per frame, as they were set
+    for (size_t value = 0; value < values.size(); value++) {
+        writeSummary(file, json, first, lastFrame, values[value], "value", units[value], 1.0, valueWindows[value]);
+    }
+
+    if (json) file << "\n  ]\n}\n";
+}
+
+void FrameProfiler::writeSummary(std::ostream &file,
+                                 bool json,
+                                 bool &first,
+                                 uint64_t lastFrame,
+                                 const string &stage,
+                                 const char *source,
+                                 const char *unit,
+                                 double scale,
+                                 const Window &window) const {
+    if (window.count == 0UL) return;
+
+    auto summary(summarize(window, scale));
+
+    if (json) {
+        file << (first ? "\n" : ",\n")
+             << "    { \"stage\" : \"" << stage
+             << "\", \"source\" : \"" << source
+             << "\", \"unit\" : \"" << unit
+             << "\", \"count\" : " << summary.count
+             << ", \"min\" : " << summary.minimum
+             << ", \"avg\" : " << summary.average
+             << ", \"p50\" : " << summary.p50
+             << ", \"p90\" : " << summary.p90
+             << ", \"p99\" : " << summary.p99
+             << ", \"max\" : " << summary.maximum
+             << " }";
+    } else {
+        file << lastFrame << ','
+             << stage << ','
+             << source << ','
+             << unit << ','
+             << summary.count << ','
+             << summary.minimum << ','
+             << summary.average << ','
+             << summary.p50 << ','
+             << summary.p90 << ','
+             << summary.p99 << ','
+             << summary.maximum << '\n';
+    }
+
+    first = false;
+}
+
+void FrameProfiler::addSample(Window &window, int64_t sample) {
+    // Windows are only allocated once they have something to hold
+    if (window.samples.empty()) window.samples.resize(k_Window);
+
+    window.samples[window.next] = sample;
+    window.next = ((window.next + 1) % window.samples.size());
+    window.count++;
+}
+
+FrameProfiler::Summary FrameProfiler::summarize(const Window &window, double scale) {
+    auto count(std::min(static_cast<size_t>(window.count), window.samples.size()));
+    vector<int64_t> sorted(window.samples.begin(), (window.samples.begin() + count));
+
+    std::sort(sorted.begin(), sorted.end());
+
+    double total(0.0);
+    for (auto sample : sorted) total += sample;
+
+    auto percentile([&sorted, count, scale](double fraction) {
+        return (sorted[std::min(static_cast<size_t>(count * fraction), (count - 1))] * scale);
+    });
+
+    Summary summary;
+    summary.count = count;
+    summary.minimum = (sorted.front() * scale);
+    summary.average = ((total / count) * scale);
+    summary.p50 = percentile(0.50);
+    summary.p90 = percentile(0.90);
+    summary.p99 = percentile(0.99);
+    summary.maximum = (sorted.back() * scale);
+
+    return summary;
+}
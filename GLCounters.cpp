@@ -0,0 +1,453 @@
+#include <GL/glew.h>
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstring>
+#include <map>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "GLCounters.h"
+
+// Namespace using directives
+
+using std::map;
+using std::pair;
+using std::uint64_t;
+using std::vector;
+
+
+// The driver's OpenGL 1.1 entry points, wrapped at link time by
+// -Wl,--wrap=<name>; see GL_WRAPS in the Makefile
+extern "C" {
+    void __real_glBindTexture(GLenum target, GLuint texture);
+    void __real_glClear(GLbitfield mask);
+    void __real_glDrawArrays(GLenum mode, GLint first, GLsizei count);
+    void __real_glDrawElements(GLenum mode, GLsizei count, GLenum type, const void *indices);
+    void __real_glTexImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height,
+                             GLint border, GLenum format, GLenum type, const void *pixels);
+    void __real_glTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width,
+                                GLsizei height, GLenum format, GLenum type, const void *pixels);
+}
+
+
+// Counts and bound state, on the render thread
+
+// The thread which enabled counting; calls from any other, such as the
+// shader compile thread, pass straight through to the driver
+static std::atomic<std::thread::id> renderThread;
+
+static GLCounters::Counts counts = {};
+
+static const GLuint k_Unknown(~0U);
+
+static const GLuint k_MaxUnits(32U);
+
+static GLuint activeUnit(k_Unknown);
+static GLuint textures[k_MaxUnits];
+static GLuint program(k_Unknown);
+static GLuint vertexArray(k_Unknown);
+static GLuint renderbuffer(k_Unknown);
+static map<GLenum, GLuint> buffers;
+static map<pair<GLenum, GLuint>, GLuint> bufferBases;
+static map<GLenum, GLuint> framebuffers;
+
+// The last value set at each uniform location of each program, forgotten
+// when the program is deleted, since its name may then be reused
+static map<pair<GLuint, GLint>, vector<unsigned char>> uniforms;
+
+// The driver's entry points, while their GLEW pointers are swapped
+static struct {
+    PFNGLACTIVETEXTUREPROC ActiveTexture;
+    PFNGLBINDBUFFERPROC BindBuffer;
+    PFNGLBINDBUFFERBASEPROC BindBufferBase;
+    PFNGLBINDFRAMEBUFFERPROC BindFramebuffer;
+    PFNGLBINDRENDERBUFFERPROC BindRenderbuffer;
+    PFNGLBINDVERTEXARRAYPROC BindVertexArray;
+    PFNGLBUFFERDATAPROC BufferData;
+    PFNGLBUFFERSUBDATAPROC BufferSubData;
+    PFNGLDELETEPROGRAMPROC DeleteProgram;
+    PFNGLUNIFORM1FPROC Uniform1f;
+    PFNGLUNIFORM1IPROC Uniform1i;
+    PFNGLUNIFORM2FPROC Uniform2f;
+    PFNGLUNIFORM3FPROC Uniform3f;
+    PFNGLUNIFORMMATRIX4FVPROC UniformMatrix4fv;
+    PFNGLUSEPROGRAMPROC UseProgram;
+} driver;
+
+
+// Whether a call is to be counted, being on the render thread while enabled
+static bool counting() {
+    return ((std::this_thread::get_id() == renderThread.load(std::memory_order_relaxed)) and
+            GLCounters::isEnabled());
+}
+
+// Tally one call in a category, and whether it changed nothing
+static void count(GLCounters::Count category, bool redundant = false) {
+    counts[GLCounters::CALLS]++;
+    counts[category]++;
+    if (redundant) counts[GLCounters::REDUNDANT]++;
+}
+
+// Record a bind, returning whether it rebound what was already bound
+static bool rebind(GLuint &bound, GLuint name) {
+    bool redundant(bound == name);
+    bound = name;
+
+    return redundant;
+}
+
+// Record a uniform's value, returning whether it already held it
+static bool setUniform(GLint location, const void *value, size_t size) {
+    counts[GLCounters::UPLOAD_BYTES] += size;
+
+    const auto *bytes(static_cast<const unsigned char*>(value));
+    auto &last(uniforms[{ program, location }]);
+    bool redundant((program != k_Unknown) and (last.size() == size) and (std::memcmp(last.data(), bytes, size) == 0));
+    last.assign(bytes, (bytes + size));
+
+    return redundant;
+}
+
+// Bytes in a client-side image of the given format and type, as tightly packed
+static uint64_t imageBytes(GLsizei width, GLsizei height, GLenum format, GLenum type) {
+    uint64_t components(4);
+    switch (format) {
+    case GL_RED:
+    case GL_RED_INTEGER:
+    case GL_DEPTH_COMPONENT:
+    case GL_STENCIL_INDEX:
+        components = 1;
+        break;
+
+    case GL_RG:
+    case GL_RG_INTEGER:
+    case GL_DEPTH_STENCIL:
+        components = 2;
+        break;
+
+    case GL_RGB:
+    case GL_BGR:
+    case GL_RGB_INTEGER:
+        components = 3;
+        break;
+    }
+
+    uint64_t size(4);
+    switch (type) {
+    case GL_UNSIGNED_BYTE:
+    case GL_BYTE:
+        size = 1;
+        break;
+
+    case GL_UNSIGNED_SHORT:
+    case GL_SHORT:
+    case GL_HALF_FLOAT:
+        size = 2;
+        break;
+
+    case GL_UNSIGNED_INT:
+    case GL_INT:
+    case GL_FLOAT:
+        break;
+
+    default:
+        // Packed types hold a whole pixel
+        components = 1;
+    }
+
+    return (static_cast<uint64_t>(width) * height * components * size);
+}
+
+
+// Counting wrappers over GLEW's entry points
+
+static void GLAPIENTRY activeTexture(GLenum unit) {
+    if (!counting()) return driver.ActiveTexture(unit);
+
+    count(GLCounters::BINDS, rebind(activeUnit, (unit - GL_TEXTURE0)));
+    driver.ActiveTexture(unit);
+}
+
+static void GLAPIENTRY bindBuffer(GLenum target, GLuint buffer) {
+    if (!counting()) return driver.BindBuffer(target, buffer);
+
+    auto bound(buffers.emplace(target, k_Unknown).first);
+    count(GLCounters::BINDS, rebind(bound->second, buffer));
+    driver.BindBuffer(target, buffer);
+}
+
+static void GLAPIENTRY bindBufferBase(GLenum target, GLuint index, GLuint buffer) {
+    if (!counting()) return driver.BindBufferBase(target, index, buffer);
+
+    auto bound(bufferBases.emplace(pair<GLenum, GLuint>(target, index), k_Unknown).first);
+    count(GLCounters::BINDS, rebind(bound->second, buffer));
+
+    // The generic binding point is bound too
+    buffers[target] = buffer;
+    driver.BindBufferBase(target, index, buffer);
+}
+
+static void GLAPIENTRY bindFramebuffer(GLenum target, GLuint framebuffer) {
+    if (!counting()) return driver.BindFramebuffer(target, framebuffer);
+
+    auto bound(framebuffers.emplace(target, k_Unknown).first);
+    count(GLCounters::BINDS, rebind(bound->second, framebuffer));
+
+    if (target == GL_FRAMEBUFFER) {
+        framebuffers[GL_DRAW_FRAMEBUFFER] = framebuffers[GL_READ_FRAMEBUFFER] = framebuffer;
+    }
+    driver.BindFramebuffer(target, framebuffer);
+}
+
+static void GLAPIENTRY bindRenderbuffer(GLenum target, GLuint name) {
+    if (!counting()) return driver.BindRenderbuffer(target, name);
+
+    count(GLCounters::BINDS, rebind(renderbuffer, name));
+    driver.BindRenderbuffer(target, name);
+}
+
+static void GLAPIENTRY bindVertexArray(GLuint array) {
+    if (!counting()) return driver.BindVertexArray(array);
+
+    bool redundant(rebind(vertexArray, array));
+    count(GLCounters::BINDS, redundant);
+
+    // The element array binding belongs to the vertex array
+    if (!redundant) buffers.erase(GL_ELEMENT_ARRAY_BUFFER);
+    driver.BindVertexArray(array);
+}
+
+static void GLAPIENTRY bufferData(GLenum target, GLsizeiptr size, const void *data, GLenum usage) {
+    if (!counting()) return driver.BufferData(target, size, data, usage);
+
+    count(GLCounters::BUFFER_UPLOADS);
+    if (data) counts[GLCounters::UPLOAD_BYTES] += size;
+    driver.BufferData(target, size, data, usage);
+}
+
+static void GLAPIENTRY bufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void *data) {
+    if (!counting()) return driver.BufferSubData(target, offset, size, data);
+
+    count(GLCounters::BUFFER_UPLOADS);
+    counts[GLCounters::UPLOAD_BYTES] += size;
+    driver.BufferSubData(target, offset, size, data);
+}
+
+static void GLAPIENTRY deleteProgram(GLuint name) {
+    if (!counting()) return driver.DeleteProgram(name);
+
+    counts[GLCounters::CALLS]++;
+
+    uniforms.erase(uniforms.lower_bound({ name, INT_MIN }), uniforms.upper_bound({ name, INT_MAX }));
+
+    // A program deleted while in use stays in use only until unbound
+    if (program == name) program = k_Unknown;
+    driver.DeleteProgram(name);
+}
+
+static void GLAPIENTRY uniform1f(GLint location, GLfloat v0) {
+    if (!counting()) return driver.Uniform1f(location, v0);
+
+    count(GLCounters::UNIFORMS, setUniform(location, &v0, sizeof(v0)));
+    driver.Uniform1f(location, v0);
+}
+
+static void GLAPIENTRY uniform1i(GLint location, GLint v0) {
+    if (!counting()) return driver.Uniform1i(location, v0);
+
+    count(GLCounters::UNIFORMS, setUniform(location, &v0, sizeof(v0)));
+    driver.Uniform1i(location, v0);
+}
+
+static void GLAPIENTRY uniform2f(GLint location, GLfloat v0, GLfloat v1) {
+    if (!counting()) return driver.Uniform2f(location, v0, v1);
+
+    const GLfloat value[] = { v0, v1 };
+    count(GLCounters::UNIFORMS, setUniform(location, value, sizeof(value)));
+    driver.Uniform2f(location, v0, v1);
+}
+
+static void GLAPIENTRY uniform3f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2) {
+    if (!counting()) return driver.Uniform3f(location, v0, v1, v2);
+
+    const GLfloat value[] = { v0, v1, v2 };
+    count(GLCounters::UNIFORMS, setUniform(location, value, sizeof(value)));
+    driver.Uniform3f(location, v0, v1, v2);
+}
+
+static void GLAPIENTRY uniformMatrix4fv(GLint location, GLsizei n, GLboolean transpose, const GLfloat *value) {
+    if (!counting()) return driver.UniformMatrix4fv(location, n, transpose, value);
+
+    count(GLCounters::UNIFORMS, setUniform(location, value, (n * 16 * sizeof(GLfloat))));
+    driver.UniformMatrix4fv(location, n, transpose, value);
+}
+
+static void GLAPIENTRY useProgram(GLuint name) {
+    if (!counting()) return driver.UseProgram(name);
+
+    count(GLCounters::BINDS, rebind(program, name));
+    driver.UseProgram(name);
+}
+
+
+// Link-time wrappers over the OpenGL 1.1 entry points
+
+extern "C" void __wrap_glBindTexture(GLenum target, GLuint texture) {
+    if (counting()) {
+        bool redundant(false);
+        if ((target == GL_TEXTURE_2D) and (activeUnit < k_MaxUnits)) redundant = rebind(textures[activeUnit], texture);
+
+        count(GLCounters::BINDS, redundant);
+    }
+
+    __real_glBindTexture(target, texture);
+}
+
+extern "C" void __wrap_glClear(GLbitfield mask) {
+    if (counting()) count(GLCounters::CLEARS);
+
+    __real_glClear(mask);
+}
+
+extern "C" void __wrap_glDrawArrays(GLenum mode, GLint first, GLsizei n) {
+    if (counting()) count(GLCounters::DRAWS);
+
+    __real_glDrawArrays(mode, first, n);
+}
+
+extern "C" void __wrap_glDrawElements(GLenum mode, GLsizei n, GLenum type, const void *indices) {
+    if (counting()) count(GLCounters::DRAWS);
+
+    __real_glDrawElements(mode, n, type, indices);
+}
+
+extern "C" void __wrap_glTexImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width,
+                                    GLsizei height, GLint border, GLenum format, GLenum type,
+                                    const void *pixels) {
+    if (counting()) {
+        count(GLCounters::TEXTURE_UPLOADS);
+        if (pixels) counts[GLCounters::UPLOAD_BYTES] += imageBytes(width, height, format, type);
+    }
+
+    __real_glTexImage2D(target, level, internalFormat, width, height, border, format, type, pixels);
+}
+
+extern "C" void __wrap_glTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset,
+                                       GLsizei width, GLsizei height, GLenum format, GLenum type,
+                                       const void *pixels) {
+    if (counting()) {
+        count(GLCounters::TEXTURE_UPLOADS);
+        if (pixels) counts[GLCounters::UPLOAD_BYTES] += imageBytes(width, height, format, type);
+    }
+
+    __real_glTexSubImage2D(target, level, xoffset, yoffset, width, height, format, type, pixels);
+}
+
+
+// Implementation of class GLCounters
+
+// Static attribute initialization
+
+bool GLCounters::enabled(false);
+
+const char *const GLCounters::k_Names[MAX_COUNTS] = {
+    "gl_calls",
+    "gl_uniforms",
+    "gl_binds",
+    "gl_draws",
+    "gl_clears",
+    "gl_buffer_uploads",
+    "gl_texture_uploads",
+    "gl_upload_bytes",
+    "gl_redundant"
+};
+
+// Swap one of GLEW's entry points for its wrapper, keeping the driver's
+#define INTERCEPT(entry, wrapper) { driver.entry = __glew##entry; __glew##entry = wrapper; }
+
+#define RESTORE(entry) { __glew##entry = driver.entry; }
+
+
+// Public methods
+
+void GLCounters::setEnabled(bool e) {
+    if (e == enabled) return;
+
+    if (e) {
+        renderThread.store(std::this_thread::get_id(), std::memory_order_relaxed);
+        reset();
+
+        INTERCEPT(ActiveTexture, activeTexture);
+        INTERCEPT(BindBuffer, bindBuffer);
+        INTERCEPT(BindBufferBase, bindBufferBase);
+        INTERCEPT(BindFramebuffer, bindFramebuffer);
+        INTERCEPT(BindRenderbuffer, bindRenderbuffer);
+        INTERCEPT(BindVertexArray, bindVertexArray);
+        INTERCEPT(BufferData, bufferData);
+        INTERCEPT(BufferSubData, bufferSubData);
+        INTERCEPT(DeleteProgram, deleteProgram);
+        INTERCEPT(Uniform1f, uniform1f);
+        INTERCEPT(Uniform1i, uniform1i);
+        INTERCEPT(Uniform2f, uniform2f);
+        INTERCEPT(Uniform3f, uniform3f);
+        INTERCEPT(UniformMatrix4fv, uniformMatrix4fv);
+        INTERCEPT(UseProgram, useProgram);
+    } else {
+        RESTORE(ActiveTexture);
+        RESTORE(BindBuffer);
+        RESTORE(BindBufferBase);
+        RESTORE(BindFramebuffer);
+        RESTORE(BindRenderbuffer);
+        RESTORE(BindVertexArray);
+        RESTORE(BufferData);
+        RESTORE(BufferSubData);
+        RESTORE(DeleteProgram);
+        RESTORE(Uniform1f);
+        RESTORE(Uniform1i);
+        RESTORE(Uniform2f);
+        RESTORE(Uniform3f);
+        RESTORE(UniformMatrix4fv);
+        RESTORE(UseProgram);
+    }
+
+    enabled = e;
+}
+
+bool GLCounters::isEnabled() {
+    return enabled;
+}
+
+GLCounters::Counts GLCounters::endFrame() {
+    auto frame(counts);
+    counts.fill(0UL);
+
+    return frame;
+}
+
+const char* GLCounters::getName(Count count) {
+    return k_Names[count];
+}
+
+const char* GLCounters::getUnit(Count count) {
+    return ((count == UPLOAD_BYTES) ? "bytes" : "count");
+}
+
+
+// Private methods
+
+void GLCounters::reset() {
+    counts.fill(0UL);
+
+    // Whatever was bound before counting began is unknown
+    activeUnit = k_Unknown;
+    std::fill(textures, (textures + k_MaxUnits), k_Unknown);
+    program = k_Unknown;
+    vertexArray = k_Unknown;
+    renderbuffer = k_Unknown;
+    buffers.clear();
+    bufferBases.clear();
+    framebuffers.clear();
+    uniforms.clear();
+}
@@ -0,0 +1,216 @@
+#include <GL/glew.h>
+#include <GL/glu.h>
+#include <algorithm>
+#include <iostream>
+#include <utility>
+
+#include "GLDebug.h"
+
+// Namespace using directives
+
+using std::cerr;
+using std::cout;
+using std::endl;
+using std::lock_guard;
+using std::map;
+using std::size_t;
+using std::string;
+using std::vector;
+
+
+// Implementation of class GLDebug
+
+// Static attribute initialization
+
+bool GLDebug::available(false);
+
+std::atomic<bool> GLDebug::synchronous(false);
+
+std::mutex GLDebug::queueMutex;
+
+vector<GLDebug::Message> GLDebug::queue;
+
+unsigned long GLDebug::dropped(0UL);
+
+std::atomic<unsigned long> GLDebug::errors(0UL);
+
+map<GLuint, unsigned long> GLDebug::reported;
+
+// Messages beyond these, between flushes, are counted but not kept
+const size_t GLDebug::k_MaxQueued(256);
+
+// A message repeated every frame is reported only so many times
+const unsigned long GLDebug::k_MaxRepeats(10UL);
+
+// GL_KHR_debug guarantees labels of at least this many characters
+static const size_t k_MaxLabel(255);
+
+
+// Group constructor / destructor
+
+GLDebug::Group::Group(const char *name) {
+    if (available) glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, -1, name);
+}
+
+GLDebug::Group::~Group() {
+    if (available) glPopDebugGroup();
+}
+
+
+// Public methods
+
+void GLDebug::initialize(bool enabled) {
+    if (!enabled) {
+        cout << "[INFO] OpenGL debug output disabled; OpenGL errors are polled once a frame" << endl;
+        return;
+    }
+
+    available = (GLEW_KHR_debug and glDebugMessageCallback);
+
+    if (!available) {
+        cout << "[INFO] GL_KHR_debug is not available; OpenGL errors are polled once a frame" << endl;
+        return;
+    }
+
+    glDebugMessageCallback(callback, nullptr);
+
+    // Notifications, such as buffer placement hints and our own debug
+    // groups, are too frequent to be worth reporting
+    glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_NOTIFICATION, 0, nullptr, GL_FALSE);
+
+    glEnable(GL_DEBUG_OUTPUT);
+    if (synchronous) glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+}
+
+bool GLDebug::isAvailable() {
+    return available;
+}
+
+void GLDebug::setSynchronous(bool s) {
+    if (s == synchronous) return;
+
+    synchronous = s;
+    if (!available) return;
+
+    // Anything queued asynchronously is reported first
+    if (synchronous) {
+        flush();
+        glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+    } else {
+        glDisable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+    }
+}
+
+bool GLDebug::isSynchronous() {
+    return synchronous;
+}
+
+void GLDebug::flush() {
+    if (!available) {
+        // Synchronous checking polls after each call instead
+        if (synchronous) return;
+
+        GLenum error;
+        while ((error = glGetError()) != GL_NO_ERROR) {
+            errors.fetch_add(1UL, std::memory_order_relaxed);
+            cerr << "[frame : GL ERROR (" << error << ")] : \"" << gluErrorString(error) << "\"" << endl;
+        }
+        return;
+    }
+
+    vector<Message> messages;
+    unsigned long lost(0UL);
+    {
+        lock_guard<std::mutex> lock(queueMutex);
+        if (queue.empty()) return;
+
+        messages.swap(queue);
+        lost = dropped;
+        dropped = 0UL;
+    }
+
+    for (const auto &message : messages) report(message);
+
+    if (lost > 0) cerr << "[WARN] " << lost << " further OpenGL debug messages were dropped" << endl;
+}
+
+void GLDebug::label(GLenum identifier, GLuint name, const string &text) {
+    if (!available) return;
+
+    auto length(std::min(text.size(), k_MaxLabel));
+    glObjectLabel(identifier, name, static_cast<GLsizei>(length), text.c_str());
+}
+
+unsigned long GLDebug::getErrorCount() {
+    return errors.load(std::memory_order_relaxed);
+}
+
+
+// Private methods
+
+void APIENTRY GLDebug::callback(GLenum source,
+                                GLenum type,
+                                GLuint id,
+                                GLenum severity,
+                                GLsizei length,
+                                const GLchar *message,
+                                const void *userParam) {
+
+    // The callback is the only reporter of errors while it is installed
+    if (type == GL_DEBUG_TYPE_ERROR) errors.fetch_add(1UL, std::memory_order_relaxed);
+
+    Message m = { source, type, id, severity,
+                  ((length < 0) ? string(message) : string(message, length)) };
+
+    // Synchronous messages arrive on the render thread, within the call
+    if (synchronous) {
+        report(m);
+        return;
+    }
+
+    lock_guard<std::mutex> lock(queueMutex);
+    if (queue.size() < k_MaxQueued) {
+        queue.push_back(std::move(m));
+    } else {
+        dropped++;
+    }
+}
+
+void GLDebug::report(const Message &message) {
+    auto repeats(++reported[message.id]);
+    if (repeats > k_MaxRepeats) return;
+
+    bool error((message.type == GL_DEBUG_TYPE_ERROR) or (message.severity == GL_DEBUG_SEVERITY_HIGH));
+    auto &stream(error ? cerr : cout);
+
+    stream << (error ? "[WARN] " : "[INFO] ") << "OpenGL ";
+
+    switch (message.type) {
+    case GL_DEBUG_TYPE_ERROR:
+        stream << "error";
+        break;
+
+    case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR:
+        stream << "deprecated behaviour";
+        break;
+
+    case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR:
+        stream << "undefined behaviour";
+        break;
+
+    case GL_DEBUG_TYPE_PERFORMANCE:
+        stream << "performance warning";
+        break;
+
+    case GL_DEBUG_TYPE_PORTABILITY:
+        stream << "portability warning";
+        break;
+
+    default:
+        stream << "message";
+    }
+
+    stream << " " << message.id << " : \"" << message.text << "\"";
+    if (repeats == k_MaxRepeats) stream << " (repeated; no longer reported)";
+    stream << endl;
+}
@@ -0,0 +1,174 @@
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+#include "HeadlessContext.h"
+
+// Namespace using directives
+
+using std::cout;
+using std::endl;
+using std::runtime_error;
+
+
+// Implementation of class HeadlessContext
+
+// Constructor / destructor
+
+HeadlessContext::HeadlessContext(int width, int height, bool debug) :
+    display(openDisplay()),
+    context(EGL_NO_CONTEXT),
+    surface(EGL_NO_SURFACE) {
+
+    if (display == EGL_NO_DISPLAY) throw runtime_error("Cannot open an EGL display");
+
+    EGLint major(0);
+    EGLint minor(0);
+    if (!eglInitialize(display, &major, &minor)) {
+        throw runtime_error("Cannot initialize EGL");
+    }
+
+    if (!eglBindAPI(EGL_OPENGL_API)) {
+        release();
+        throw runtime_error("EGL does not support desktop OpenGL");
+    }
+
+    // Surfaceless contexts need no pbuffer support from the configuration
+    auto surfaceless(hasExtension(eglQueryString(display, EGL_EXTENSIONS),
+                                  "EGL_KHR_surfaceless_context"));
+
+    EGLint configAttribs[] = {
+        EGL_SURFACE_TYPE, (surfaceless ? 0 : EGL_PBUFFER_BIT),
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8,
+        EGL_GREEN_SIZE, 8,
+        EGL_BLUE_SIZE, 8,
+        EGL_ALPHA_SIZE, 8,
+        EGL_DEPTH_SIZE, 24,
+        EGL_NONE
+    };
+
+    EGLConfig config;
+    EGLint configCount(0);
+    if (!eglChooseConfig(display, configAttribs, &config, 1, &configCount) or (configCount == 0)) {
+        release();
+        throw runtime_error("No appropriate EGL configuration found");
+    }
+
+    // Some drivers only send debug output from a debug context; EGL before
+    // 1.5 rejects the attribute, so is asked without it
+    EGLint contextAttribs[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_CONTEXT_OPENGL_DEBUG, (debug ? EGL_TRUE : EGL_FALSE),
+        EGL_NONE
+    };
+
+    if (!debug or (((major * 10) + minor) < 15)) contextAttribs[6] = EGL_NONE;
+
+    context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttribs);
+    if (context == EGL_NO_CONTEXT) {
+        release();
+        throw runtime_error("Failed to create an OpenGL 3.3 core EGL context");
+    }
+
+    if (!surfaceless) {
+        EGLint surfaceAttribs[] = {
+            EGL_WIDTH, width,
+            EGL_HEIGHT, height,
+            EGL_NONE
+        };
+
+        surface = eglCreatePbufferSurface(display, config, surfaceAttribs);
+        if (surface == EGL_NO_SURFACE) {
+            release();
+            throw runtime_error("Failed to create an EGL pbuffer surface");
+        }
+    }
+
+    if (!eglMakeCurrent(display, surface, surface, context)) {
+        release();
+        throw runtime_error("Failed to make the EGL context current");
+    }
+
+    cout << "[INFO] Headless EGL "
+         << major
+         << "."
+         << minor
+         << " context ("
+         << getVendor()
+         << ", "
+         << (surfaceless ? "surfaceless" : "pbuffer")
+         << ")"
+         << endl;
+}
+
+HeadlessContext::~HeadlessContext() {
+    release();
+}
+
+
+// Accessors
+
+bool HeadlessContext::isSurfaceless() const {
+    return (surface == EGL_NO_SURFACE);
+}
+
+const char* HeadlessContext::getVendor() const {
+    auto vendor(eglQueryString(display, EGL_VENDOR));
+    return (vendor ? vendor : "unknown vendor");
+}
+
+
+// Private methods
+
+void HeadlessContext::release() {
+    if (display == EGL_NO_DISPLAY) return;
+
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+
+    if (surface != EGL_NO_SURFACE) eglDestroySurface(display, surface);
+    if (context != EGL_NO_CONTEXT) eglDestroyContext(display, context);
+
+    eglTerminate(display);
+
+    surface = EGL_NO_SURFACE;
+    context = EGL_NO_CONTEXT;
+    display = EGL_NO_DISPLAY;
+}
+
+EGLDisplay HeadlessContext::openDisplay() {
+    // Client extensions are queried without a display
+    auto clientExtensions(eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS));
+
+    if (hasExtension(clientExtensions, "EGL_MESA_platform_surfaceless") and
+        hasExtension(clientExtensions, "EGL_EXT_platform_base")) {
+        auto getPlatformDisplay(reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+            eglGetProcAddress("eglGetPlatformDisplayEXT")));
+
+        if (getPlatformDisplay) {
+            auto display(getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr));
+            if (display != EGL_NO_DISPLAY) return display;
+        }
+    }
+
+    return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+}
+
+bool HeadlessContext::hasExtension(const char *extensions, const char *name) {
+    if (!extensions) return false;
+
+    // Match whole names only, as some are prefixes of others
+    auto length(strlen(name));
+    for (auto found(strstr(extensions, name)); found; found = strstr(found + length, name)) {
+        if (((found == extensions) or (found[-1] == ' ')) and
+            ((found[length] == ' ') or (found[length] == '\0'))) {
+            return true;
+        }
+    }
+
+    return false;
+}
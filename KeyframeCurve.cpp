@@ -0,0 +1,184 @@
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "KeyframeCurve.h"
+
+// Namespace using directives
+
+namespace chrono = std::chrono;
+
+using std::max;
+using std::min;
+using std::ostringstream;
+using std::runtime_error;
+using std::string;
+using std::vector;
+
+
+// Implementation of class KeyframeCurve
+
+// Constructor
+
+KeyframeCurve::KeyframeCurve(const vector<Keyframe> &keyframes,
+                             bool loop,
+                             size_t resolution) :
+    keyframes(keyframes),
+    tangents(),
+    table(),
+    loop(loop),
+    start(0.0f),
+    duration(0.0f),
+    scale(0.0f),
+    period(0) {
+    static const string k_Context(__PRETTY_FUNCTION__);
+
+    if (keyframes.empty()) {
+        throw runtime_error(k_Context + " : Curve has no keyframes");
+    }
+
+    for (size_t i = 1; i < keyframes.size(); i++) {
+        if (keyframes[i].first <= keyframes[i - 1].first) {
+            ostringstream excStream;
+            excStream << k_Context
+                      << " : Keyframe ["
+                      << i
+                      << "] time ("
+                      << keyframes[i].first
+                      << ") does not follow the previous keyframe";
+
+            throw runtime_error(excStream.str());
+        }
+    }
+
+    start = keyframes.front().first;
+    duration = (keyframes.back().first - start);
+
+    // A lone keyframe is a constant, tabulated as a single flat segment
+    if (keyframes.size() == 1) {
+        table.push_back({0.0f, 0.0f, 0.0f, keyframes.front().second});
+        return;
+    }
+
+    tangents.resize(keyframes.size());
+    for (size_t i = 0; i < keyframes.size(); i++) tangents[i] = tangent(i);
+
+    scale = (resolution / duration);
+    period = chrono::duration_cast<chrono::nanoseconds>(chrono::duration<double>(duration));
+
+    // Bake Hermite segments which match the spline's value and slope at both
+    // ends; segments lying within one keyframe interval reproduce it exactly
+    float width(duration / resolution);
+    table.resize(resolution);
+
+    for (size_t i = 0; i < resolution; i++) {
+        float slope0(0.0f);
+        float slope1(0.0f);
+        float p0(spline((start + (i * width)), false, slope0));
+        float p1(spline((start + ((i + 1) * width)), true, slope1));
+        float m0(slope0 * width);
+        float m1(slope1 * width);
+
+        table[i].a = ((2.0f * (p0 - p1)) + m0 + m1);
+        table[i].b = ((3.0f * (p1 - p0)) - (2.0f * m0) - m1);
+        table[i].c = m0;
+        table[i].d = p0;
+    }
+}
+
+
+// Public methods
+
+float KeyframeCurve::evaluate(float seconds) const {
+    float offset(seconds - start);
+
+    if (loop and (duration > 0.0f)) {
+        offset -= (duration * std::floor(offset / duration));
+    }
+
+    float position(min(max((offset * scale), 0.0f), static_cast<float>(table.size())));
+    size_t index(min(static_cast<size_t>(position), (table.size() - 1)));
+    float u(position - index);
+
+    const auto &segment(table[index]);
+
+    return (((((segment.a * u) + segment.b) * u) + segment.c) * u) + segment.d;
+}
+
+float KeyframeCurve::evaluate(chrono::nanoseconds time) const {
+    if (!loop or (period.count() <= 0)) {
+        return evaluate(static_cast<float>(chrono::duration<double>(time).count()));
+    }
+
+    // Wrap in integer nanoseconds before converting to single precision
+    auto offset(time - chrono::duration_cast<chrono::nanoseconds>(chrono::duration<double>(start)));
+    auto wrapped(offset % period);
+    if (wrapped.count() < 0) wrapped += period;
+
+    return evaluate(start + static_cast<float>(chrono::duration<double>(wrapped).count()));
+}
+
+
+// Accessors
+
+float KeyframeCurve::getDuration() const {
+    return duration;
+}
+
+
+// Private methods
+
+float KeyframeCurve::tangent(size_t index) const {
+    size_t last(keyframes.size() - 1);
+
+    // Catmull-Rom slope through the neighboring keyframes; looping curves
+    // treat the last keyframe as the first one again
+    if (loop and ((index == 0) or (index == last))) {
+        float span((keyframes[1].first - keyframes[0].first) +
+                   (keyframes[last].first - keyframes[last - 1].first));
+
+        return ((keyframes[1].second - keyframes[last - 1].second) / span);
+    }
+
+    size_t before((index == 0) ? 0 : (index - 1));
+    size_t after((index == last) ? last : (index + 1));
+
+    return ((keyframes[after].second - keyframes[before].second) /
+            (keyframes[after].first - keyframes[before].first));
+}
+
+float KeyframeCurve::spline(float time, bool leftSide, float &slope) const {
+    // Locate the keyframe interval, preferring the earlier one at a keyframe
+    // when approaching from the left
+    auto upper(leftSide ?
+               std::lower_bound(keyframes.begin(), keyframes.end(), time,
+                                [](const Keyframe &k, float t) { return (k.first < t); }) :
+               std::upper_bound(keyframes.begin(), keyframes.end(), time,
+                                [](float t, const Keyframe &k) { return (t < k.first); }));
+
+    size_t interval(min(max(static_cast<size_t>(upper - keyframes.begin()), size_t(1)),
+                        (keyframes.size() - 1)) - 1);
+
+    const auto &k0(keyframes[interval]);
+    const auto &k1(keyframes[interval + 1]);
+    float h(k1.first - k0.first);
+    float u((time - k0.first) / h);
+
+    float m0(tangents[interval] * h);
+    float m1(tangents[interval + 1] * h);
+
+    float u2(u * u);
+    float u3(u2 * u);
+
+    slope = ((((6.0f * u2) - (6.0f * u)) * k0.second) +
+             (((3.0f * u2) - (4.0f * u) + 1.0f) * m0) +
+             (((6.0f * u) - (6.0f * u2)) * k1.second) +
+             (((3.0f * u2) - (2.0f * u)) * m1)) / h;
+
+    return ((((2.0f * u3) - (3.0f * u2) + 1.0f) * k0.second) +
+            ((u3 - (2.0f * u2) + u) * m0) +
+            (((3.0f * u2) - (2.0f * u3)) * k1.second) +
+            ((u3 - u2) * m1));
+}
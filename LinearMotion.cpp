@@ -41,12 +41,14 @@ LinearMotion::LinearMotion(bool enabled,
     }
 }
 
-vector<float> LinearMotion::vectorEvaluate(float time) const {
-    vector<float> results;
-    
-    for (size_t i = 0; i < offsets.size(); i++) {
-        results.push_back(offsets[i] + (speeds[i] * time));
+void LinearMotion::evaluate(float time, float *results, size_t count) const {
+    auto dimensions(count < offsets.size() ? count : offsets.size());
+
+    for (size_t i = 0; i < dimensions; i++) {
+        results[i] = (offsets[i] + (speeds[i] * time));
     }
-    
-    return results;
+}
+
+size_t LinearMotion::getDimensions() const {
+    return offsets.size();
 }
@@ -0,0 +1,541 @@
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+#include "MotionExpression.h"
+
+// Namespace using directives
+
+using std::isalpha;
+using std::isalnum;
+using std::isdigit;
+using std::isspace;
+using std::max;
+using std::min;
+using std::ostringstream;
+using std::runtime_error;
+using std::string;
+using std::vector;
+
+
+// Implementation of class MotionExpression
+
+// Static attribute initialization
+
+const MotionExpression::Function MotionExpression::k_Functions[] = {
+    { "sin",        Op::SIN,        1, "sin" },
+    { "cos",        Op::COS,        1, "cos" },
+    { "tan",        Op::TAN,        1, "tan" },
+    { "abs",        Op::ABS,        1, "abs" },
+    { "exp",        Op::EXP,        1, "exp" },
+    { "log",        Op::LOG,        1, "log" },
+    { "sqrt",       Op::SQRT,       1, "sqrt" },
+    { "floor",      Op::FLOOR,      1, "floor" },
+    { "fract",      Op::FRACT,      1, "fract" },
+    { "noise",      Op::NOISE,      1, "motion_noise" },
+    { "min",        Op::MIN,        2, "min" },
+    { "max",        Op::MAX,        2, "max" },
+    { "mod",        Op::MOD,        2, "mod" },
+    { "pow",        Op::POW,        2, "pow" },
+    { "step",       Op::STEP,       2, "step" },
+    { "impulse",    Op::IMPULSE,    3, "motion_impulse" },
+    { "clamp",      Op::CLAMP,      3, "clamp" },
+    { "mix",        Op::MIX,        3, "mix" },
+    { "smoothstep", Op::SMOOTHSTEP, 3, "smoothstep" }
+};
+
+
+// Constructor
+
+MotionExpression::MotionExpression(const string &source) :
+    source(source),
+    tree(),
+    code(),
+    constants(),
+    maxDepth(0U) {
+
+    size_t position(0);
+    tree = parseSum(position);
+
+    skipSpace(position);
+    if (position < source.size()) fail(position, "unexpected trailing input");
+
+    // Fold constant subtrees, then flatten into postfix bytecode
+    tree = fold(tree);
+    emit(tree, 0U);
+
+    if (maxDepth > k_MaxDepth) fail(0, "expression nests too deeply");
+}
+
+
+// Public methods
+
+float MotionExpression::evaluate(float time) const {
+    float stack[k_MaxDepth];
+    size_t top(0);
+
+    for (const auto &instruction : code) {
+        switch (instruction.op) {
+        case Op::CONSTANT:
+            stack[top++] = constants[instruction.operand];
+            break;
+
+        case Op::TIME:
+            stack[top++] = time;
+            break;
+
+        default:
+            top -= arity(instruction.op);
+            stack[top] = apply(instruction.op, &stack[top]);
+            top++;
+            break;
+        }
+    }
+
+    return stack[0];
+}
+
+void MotionExpression::evaluate(const float *times, float *results, size_t count) const {
+    float stack[k_MaxDepth][k_Lanes];
+
+    for (size_t base = 0; base < count; base += k_Lanes) {
+        size_t lanes(min(k_Lanes, (count - base)));
+        size_t top(0);
+
+        // Each instruction runs across a block of lanes, so the common
+        // arithmetic operations compile to straight-line vector code
+        for (const auto &instruction : code) {
+            switch (instruction.op) {
+            case Op::CONSTANT: {
+                float value(constants[instruction.operand]);
+                for (size_t l = 0; l < k_Lanes; l++) stack[top][l] = value;
+                top++;
+                break;
+            }
+
+            case Op::TIME:
+                for (size_t l = 0; l < k_Lanes; l++) {
+                    stack[top][l] = times[base + min(l, (lanes - 1))];
+                }
+                top++;
+                break;
+
+            case Op::ADD:
+                top--;
+                for (size_t l = 0; l < k_Lanes; l++) stack[top - 1][l] += stack[top][l];
+                break;
+
+            case Op::SUB:
+                top--;
+                for (size_t l = 0; l < k_Lanes; l++) stack[top - 1][l] -= stack[top][l];
+                break;
+
+            case Op::MUL:
+                top--;
+                for (size_t l = 0; l < k_Lanes; l++) stack[top - 1][l] *= stack[top][l];
+                break;
+
+            case Op::DIV:
+                top--;
+                for (size_t l = 0; l < k_Lanes; l++) stack[top - 1][l] /= stack[top][l];
+                break;
+
+            case Op::NEG:
+                for (size_t l = 0; l < k_Lanes; l++) stack[top - 1][l] = -stack[top - 1][l];
+                break;
+
+            default: {
+                auto n(arity(instruction.op));
+                top -= n;
+
+                for (size_t l = 0; l < k_Lanes; l++) {
+                    float args[3];
+                    for (unsigned int a = 0; a < n; a++) args[a] = stack[top + a][l];
+
+                    stack[top][l] = apply(instruction.op, args);
+                }
+
+                top++;
+                break;
+            }
+            }
+        }
+
+        for (size_t l = 0; l < lanes; l++) results[base + l] = stack[0][l];
+    }
+}
+
+
+// Accessors
+
+const string& MotionExpression::getSource() const {
+    return source;
+}
+
+size_t MotionExpression::getInstructionCount() const {
+    return code.size();
+}
+
+
+// GLSL emission
+
+string MotionExpression::toGLSL(const string &timeName) const {
+    return emitGLSL(tree, timeName);
+}
+
+string MotionExpression::glslFunctions() {
+    return
+        "float motion_hash(float n) {\n"
+        "    return fract(sin(n * 127.1) * 43758.5453);\n"
+        "}\n"
+        "\n"
+        "float motion_noise(float x) {\n"
+        "    float i = floor(x);\n"
+        "    float f = x - i;\n"
+        "    float u = f * f * (3.0 - 2.0 * f);\n"
+        "    return mix(motion_hash(i), motion_hash(i + 1.0), u) * 2.0 - 1.0;\n"
+        "}\n"
+        "\n"
+        "float motion_impulse(float t, float period, float decay) {\n"
+        "    return exp(-decay * mod(t, period));\n"
+        "}\n";
+}
+
+
+// Private methods
+
+MotionExpression::Node MotionExpression::parseSum(size_t &position) const {
+    Node node(parseProduct(position));
+
+    while (true) {
+        skipSpace(position);
+        if (position >= source.size()) break;
+
+        char symbol(source[position]);
+        if ((symbol != '+') and (symbol != '-')) break;
+
+        size_t at(position++);
+        Node rhs(parseProduct(position));
+        node = Node{ ((symbol == '+') ? Op::ADD : Op::SUB), 0.0f, { node, rhs }, at };
+    }
+
+    return node;
+}
+
+MotionExpression::Node MotionExpression::parseProduct(size_t &position) const {
+    Node node(parseUnary(position));
+
+    while (true) {
+        skipSpace(position);
+        if (position >= source.size()) break;
+
+        char symbol(source[position]);
+        if ((symbol != '*') and (symbol != '/')) break;
+
+        size_t at(position++);
+        Node rhs(parseUnary(position));
+        node = Node{ ((symbol == '*') ? Op::MUL : Op::DIV), 0.0f, { node, rhs }, at };
+    }
+
+    return node;
+}
+
+MotionExpression::Node MotionExpression::parseUnary(size_t &position) const {
+    skipSpace(position);
+
+    if ((position < source.size()) and (source[position] == '-')) {
+        size_t at(position++);
+        return Node{ Op::NEG, 0.0f, { parseUnary(position) }, at };
+    }
+
+    if ((position < source.size()) and (source[position] == '+')) {
+        position++;
+        return parseUnary(position);
+    }
+
+    return parsePower(position);
+}
+
+MotionExpression::Node MotionExpression::parsePower(size_t &position) const {
+    Node node(parsePrimary(position));
+
+    // Exponentiation is right-associative and binds tighter than negation
+    skipSpace(position);
+    if ((position < source.size()) and (source[position] == '^')) {
+        size_t at(position++);
+        Node exponent(parseUnary(position));
+        node = Node{ Op::POW, 0.0f, { node, exponent }, at };
+    }
+
+    return node;
+}
+
+MotionExpression::Node MotionExpression::parsePrimary(size_t &position) const {
+    skipSpace(position);
+    if (position >= source.size()) fail(position, "unexpected end of expression");
+
+    char symbol(source[position]);
+
+    // Parenthesized subexpression
+    if (symbol == '(') {
+        position++;
+        Node node(parseSum(position));
+
+        skipSpace(position);
+        if ((position >= source.size()) or (source[position] != ')')) {
+            fail(position, "expected ')'");
+        }
+
+        position++;
+        return node;
+    }
+
+    // Numeric literal
+    if (isdigit(static_cast<unsigned char>(symbol)) or (symbol == '.')) {
+        const char *start(source.c_str() + position);
+        char *end(nullptr);
+        float value(std::strtof(start, &end));
+
+        if (end == start) fail(position, "malformed number");
+        if (!std::isfinite(value)) fail(position, "number out of range");
+
+        position += (end - start);
+        return Node{ Op::CONSTANT, value, {} };
+    }
+
+    // Variable, constant or function call
+    if (isalpha(static_cast<unsigned char>(symbol)) or (symbol == '_')) {
+        size_t begin(position);
+        while ((position < source.size()) and
+               (isalnum(static_cast<unsigned char>(source[position])) or
+                (source[position] == '_'))) {
+            position++;
+        }
+
+        string name(source.substr(begin, (position - begin)));
+
+        if (name == "t") return Node{ Op::TIME, 0.0f, {} };
+        if (name == "pi") return Node{ Op::CONSTANT, static_cast<float>(M_PI), {} };
+
+        for (const auto &function : k_Functions) {
+            if (name != function.name) continue;
+
+            skipSpace(position);
+            if ((position >= source.size()) or (source[position] != '(')) {
+                fail(position, "expected '(' after \"" + name + "\"");
+            }
+            position++;
+
+            Node node{ function.op, 0.0f, {}, begin };
+            for (unsigned int i = 0; i < function.arity; i++) {
+                if (i > 0) {
+                    skipSpace(position);
+                    if ((position >= source.size()) or (source[position] != ',')) {
+                        fail(position, "\"" + name + "\" expects " +
+                                       std::to_string(function.arity) + " arguments");
+                    }
+                    position++;
+                }
+
+                node.args.push_back(parseSum(position));
+            }
+
+            skipSpace(position);
+            if ((position >= source.size()) or (source[position] != ')')) {
+                fail(position, "expected ')' to close \"" + name + "\"");
+            }
+            position++;
+
+            return node;
+        }
+
+        fail(begin, "unknown identifier \"" + name + "\"");
+    }
+
+    fail(position, string("unexpected character '") + symbol + "'");
+}
+
+void MotionExpression::skipSpace(size_t &position) const {
+    while ((position < source.size()) and
+           isspace(static_cast<unsigned char>(source[position]))) {
+        position++;
+    }
+}
+
+void MotionExpression::fail(size_t position, const string &reason) const {
+    static const string k_Context(__PRETTY_FUNCTION__);
+
+    ostringstream excStream;
+    excStream << k_Context
+              << " : Motion expression \""
+              << source
+              << "\", column "
+              << (position + 1)
+              << " : "
+              << reason;
+
+    throw runtime_error(excStream.str());
+}
+
+MotionExpression::Node MotionExpression::fold(Node node) const {
+    bool constant(node.op != Op::TIME);
+
+    for (auto &arg : node.args) {
+        arg = fold(arg);
+        constant &= (arg.op == Op::CONSTANT);
+    }
+
+    if (constant and (node.op != Op::CONSTANT)) {
+        float args[3];
+        for (size_t i = 0; i < node.args.size(); i++) args[i] = node.args[i].value;
+
+        // Infinities and NaNs have no GLSL literal, and would break the
+        // shared prelude of the whole shader program
+        float value(apply(node.op, args));
+        if (!std::isfinite(value)) fail(node.position, "constant subexpression is not finite");
+
+        return Node{ Op::CONSTANT, value, {} };
+    }
+
+    return node;
+}
+
+void MotionExpression::emit(const Node &node, unsigned int depth) {
+    for (size_t i = 0; i < node.args.size(); i++) {
+        emit(node.args[i], (depth + i));
+    }
+
+    maxDepth = max(maxDepth, (depth + 1U));
+
+    if (node.op == Op::CONSTANT) {
+        code.push_back({ Op::CONSTANT, static_cast<std::uint32_t>(constants.size()) });
+        constants.push_back(node.value);
+    } else {
+        code.push_back({ node.op, 0U });
+    }
+}
+
+string MotionExpression::emitGLSL(const Node &node, const string &timeName) const {
+    switch (node.op) {
+    case Op::CONSTANT: {
+        ostringstream literal;
+        literal << std::setprecision(9) << node.value;
+
+        // GLSL literals need a decimal point or exponent to be floats
+        string text(literal.str());
+        if (text.find_first_of(".e") == string::npos) text += ".0";
+
+        return ((node.value < 0.0f) ? ("(" + text + ")") : text);
+    }
+
+    case Op::TIME:
+        return timeName;
+
+    case Op::NEG:
+        return ("(-" + emitGLSL(node.args[0], timeName) + ")");
+
+    case Op::ADD:
+    case Op::SUB:
+    case Op::MUL:
+    case Op::DIV: {
+        const char *symbol((node.op == Op::ADD) ? " + " :
+                           (node.op == Op::SUB) ? " - " :
+                           (node.op == Op::MUL) ? " * " : " / ");
+
+        return ("(" + emitGLSL(node.args[0], timeName) + symbol +
+                emitGLSL(node.args[1], timeName) + ")");
+    }
+
+    default:
+        break;
+    }
+
+    string call;
+    for (const auto &function : k_Functions) {
+        if (function.op == node.op) {
+            call = function.glslName;
+            break;
+        }
+    }
+
+    call += "(";
+    for (size_t i = 0; i < node.args.size(); i++) {
+        if (i > 0) call += ", ";
+        call += emitGLSL(node.args[i], timeName);
+    }
+    call += ")";
+
+    return call;
+}
+
+unsigned int MotionExpression::arity(Op op) {
+    if (op < Op::NEG) return 0U;
+    if (op < Op::ADD) return 1U;
+    if (op < Op::IMPULSE) return 2U;
+
+    return 3U;
+}
+
+float MotionExpression::apply(Op op, const float *args) {
+    switch (op) {
+    case Op::NEG:        return -args[0];
+    case Op::SIN:        return sinf(args[0]);
+    case Op::COS:        return cosf(args[0]);
+    case Op::TAN:        return tanf(args[0]);
+    case Op::ABS:        return fabsf(args[0]);
+    case Op::EXP:        return expf(args[0]);
+    case Op::LOG:        return logf(args[0]);
+    case Op::SQRT:       return sqrtf(args[0]);
+    case Op::FLOOR:      return floorf(args[0]);
+    case Op::FRACT:      return (args[0] - floorf(args[0]));
+    case Op::NOISE:      return noise(args[0]);
+
+    case Op::ADD:        return (args[0] + args[1]);
+    case Op::SUB:        return (args[0] - args[1]);
+    case Op::MUL:        return (args[0] * args[1]);
+    case Op::DIV:        return (args[0] / args[1]);
+    case Op::POW:        return powf(args[0], args[1]);
+    case Op::MIN:        return min(args[0], args[1]);
+    case Op::MAX:        return max(args[0], args[1]);
+    case Op::MOD:        return (args[0] - (args[1] * floorf(args[0] / args[1])));
+    case Op::STEP:       return ((args[1] < args[0]) ? 0.0f : 1.0f);
+
+    case Op::IMPULSE: {
+        float phase(args[0] - (args[1] * floorf(args[0] / args[1])));
+        return expf(-args[2] * phase);
+    }
+
+    case Op::CLAMP:      return min(max(args[0], args[1]), args[2]);
+    case Op::MIX:        return ((args[0] * (1.0f - args[2])) + (args[1] * args[2]));
+
+    case Op::SMOOTHSTEP: {
+        float x((args[2] - args[0]) / (args[1] - args[0]));
+        x = min(max(x, 0.0f), 1.0f);
+        return (x * x * (3.0f - (2.0f * x)));
+    }
+
+    default:
+        return 0.0f;
+    }
+}
+
+float MotionExpression::noise(float x) {
+    // Smoothed value noise, matching motion_noise() in the emitted GLSL
+    auto hash = [](float n) {
+        float h(sinf(n * 127.1f) * 43758.5453f);
+        return (h - floorf(h));
+    };
+
+    float i(floorf(x));
+    float f(x - i);
+    float u(f * f * (3.0f - (2.0f * f)));
+
+    float a(hash(i));
+    float b(hash(i + 1.0f));
+
+    return ((((a * (1.0f - u)) + (b * u)) * 2.0f) - 1.0f);
+}
@@ -2,7 +2,11 @@
 
 #include "MultiMotion.h"
 
-// Implementation of class LinearMotion
+// Namespace using directives
+using std::vector;
+
+
+// Implementation of class MultiMotion
 
 // Constructor
 
@@ -11,14 +15,33 @@ MultiMotion::MultiMotion(bool enabled) :
 
 
 float MultiMotion::evaluate(float time) const {
+    auto dimensions(getDimensions());
+
+    // Common low-dimensional motions evaluate into a stack buffer
+    float stackResults[k_MaxStackDimensions];
+    vector<float> heapResults;
+    float *results(stackResults);
+
+    if (dimensions > k_MaxStackDimensions) {
+        heapResults.resize(dimensions);
+        results = heapResults.data();
+    }
+
     // Polymorphically invoke our subclass' multi-dimensional overload
-    auto vectorResult(vectorEvaluate(time));
+    evaluate(time, results, dimensions);
 
     // Return the two-norm (Euclidean distance) of the vector quantity
     float sum(0.0f);
-    for (size_t i = 0; i < vectorResult.size(); i++) {
-        sum += vectorResult[i];
+    for (size_t i = 0; i < dimensions; i++) {
+        sum += results[i];
     }
     
     return sqrt(sum);
 }
+
+vector<float> MultiMotion::vectorEvaluate(float time) const {
+    vector<float> results(getDimensions());
+    evaluate(time, results.data(), results.size());
+
+    return results;
+}
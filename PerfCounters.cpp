@@ -0,0 +1,198 @@
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "PerfCounters.h"
+
+// Namespace using directives
+
+using std::cerr;
+using std::cout;
+using std::endl;
+using std::uint64_t;
+
+
+// Implementation of class PerfCounters
+
+// Static attribute initialization
+
+const PerfCounters::Counter PerfCounters::k_HardwareCounters[] = {
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, "instructions" },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, "cycles" },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, "cache_misses" },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, "branch_misses" }
+};
+
+const PerfCounters::Counter PerfCounters::k_SoftwareCounters[] = {
+    { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS, "page_faults" },
+    { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES, "context_switches" },
+    { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CPU_MIGRATIONS, "cpu_migrations" }
+};
+
+
+// Constructor / destructor
+
+PerfCounters::PerfCounters() :
+    descriptors(),
+    count(0),
+    names(),
+    hardware(false),
+    multiplexed(false) { }
+
+PerfCounters::~PerfCounters() {
+    close();
+}
+
+
+// Public methods
+
+bool PerfCounters::open() {
+    if (isOpen()) return true;
+
+    if (openGroup(k_HardwareCounters, (sizeof(k_HardwareCounters) / sizeof(Counter)))) {
+        hardware = true;
+    } else if (openGroup(k_SoftwareCounters, (sizeof(k_SoftwareCounters) / sizeof(Counter)))) {
+        cout << "[INFO] Hardware performance counters unavailable, using software counters"
+             << endl;
+    } else {
+        cerr << "[WARN] Performance counters unavailable : " << strerror(errno) << endl;
+        return false;
+    }
+
+    ioctl(descriptors[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(descriptors[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+
+    // A hardware group which the PMU cannot fit, such as beside a watchdog
+    // holding a counter, opens but is never scheduled, and counts nothing
+    if (hardware and !isScheduled()) {
+        close();
+
+        if (!openGroup(k_SoftwareCounters, (sizeof(k_SoftwareCounters) / sizeof(Counter)))) {
+            cerr << "[WARN] Performance counters unavailable : " << strerror(errno) << endl;
+            return false;
+        }
+
+        cout << "[INFO] Hardware performance counters never scheduled, using software counters"
+             << endl;
+
+        ioctl(descriptors[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(descriptors[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+
+    return true;
+}
+
+void PerfCounters::close() {
+    // Members first, then the group leader
+    for (size_t i = count; i > 0; i--) ::close(descriptors[i - 1]);
+
+    count = 0;
+    hardware = false;
+    multiplexed = false;
+}
+
+bool PerfCounters::read(uint64_t *values) const {
+    if (!isOpen()) return false;
+
+    // PERF_FORMAT_GROUP yields the member count, the times the group was
+    // enabled and running, then each value in order
+    uint64_t buffer[k_MaxCounters + 3];
+    auto bytes(::read(descriptors[0], buffer, sizeof(buffer)));
+    if ((bytes < static_cast<ssize_t>((count + 3) * sizeof(uint64_t))) or (buffer[0] != count)) return false;
+
+    auto enabled(buffer[1]);
+    auto running(buffer[2]);
+
+    // A group not yet scheduled has counted nothing, so has no counts to give
+    if (running == 0) return false;
+
+    // A group sharing the PMU with others is multiplexed, counting for only
+    // part of the time, so its counts are scaled up to estimate the whole
+    if (running < enabled) {
+        if (!multiplexed) {
+            multiplexed = true;
+            cout << "[INFO] Performance counters multiplexed; counts are scaled estimates" << endl;
+        }
+
+        auto scale(static_cast<double>(enabled) / running);
+        for (size_t i = 0; i < count; i++) values[i] = static_cast<uint64_t>(buffer[i + 3] * scale);
+    } else {
+        for (size_t i = 0; i < count; i++) values[i] = buffer[i + 3];
+    }
+
+    return true;
+}
+
+
+// Accessors
+
+bool PerfCounters::isOpen() const {
+    return (count > 0);
+}
+
+bool PerfCounters::isHardware() const {
+    return hardware;
+}
+
+size_t PerfCounters::getCount() const {
+    return count;
+}
+
+const char* PerfCounters::getName(size_t counter) const {
+    return names[counter];
+}
+
+
+// Private methods
+
+bool PerfCounters::isScheduled() const {
+    uint64_t buffer[k_MaxCounters + 3];
+    auto bytes(::read(descriptors[0], buffer, sizeof(buffer)));
+
+    return ((bytes >= static_cast<ssize_t>(3 * sizeof(uint64_t))) and (buffer[2] > 0));
+}
+
+bool PerfCounters::openGroup(const Counter *counters, size_t counterCount) {
+    for (size_t i = 0; i < counterCount; i++) {
+        auto descriptor(openCounter(counters[i], ((i == 0) ? -1 : descriptors[0])));
+
+        if (descriptor < 0) {
+            // A group is all or nothing; a partial group would mislead
+            auto error(errno);
+            close();
+            errno = error;
+
+            return false;
+        }
+
+        descriptors[count] = descriptor;
+        names[count] = counters[i].name;
+        count++;
+    }
+
+    return true;
+}
+
+int PerfCounters::openCounter(const Counter &counter, int group) {
+    perf_event_attr attributes;
+    memset(&attributes, 0, sizeof(attributes));
+
+    attributes.size = sizeof(attributes);
+    attributes.type = counter.type;
+    attributes.config = counter.config;
+    attributes.read_format = (PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING);
+    attributes.exclude_hv = 1;
+
+    // Software events are raised within the kernel on the thread's behalf
+    attributes.exclude_kernel = (counter.type == PERF_TYPE_HARDWARE) ? 1 : 0;
+
+    // The leader starts disabled, and enables the whole group at once
+    attributes.disabled = (group < 0) ? 1 : 0;
+
+    // This thread, on whichever CPU it runs
+    return static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, group, 0));
+}
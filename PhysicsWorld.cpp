@@ -0,0 +1,146 @@
+#include <algorithm>
+#include <cmath>
+
+#include "PhysicsWorld.h"
+
+// Namespace using directives
+
+using std::max;
+using std::min;
+
+
+// Implementation of class PhysicsWorld
+
+// Static attribute initialization
+
+const float PhysicsWorld::k_DefaultStepRate(240.0f);
+
+// Steps run per advance before falling behind, e.g. after a suspend or stall
+const unsigned int PhysicsWorld::k_MaxSteps(64U);
+
+
+// Constructor
+
+PhysicsWorld::PhysicsWorld(float stepRate) :
+    stepSeconds(1.0f / stepRate),
+    accumulator(0.0f),
+    alpha(0.0f),
+    positions(),
+    previous(),
+    velocities(),
+    phases(),
+    rests(),
+    stiffnesses(),
+    dampings(),
+    drags(),
+    impulses(),
+    periods() { }
+
+
+// Public methods
+
+size_t PhysicsWorld::addBody(const Body &body) {
+    positions.push_back(body.rest);
+    previous.push_back(body.rest);
+    velocities.push_back(0.0f);
+    phases.push_back(0.0f);
+
+    rests.push_back(0.0f);
+    stiffnesses.push_back(0.0f);
+    dampings.push_back(0.0f);
+    drags.push_back(0.0f);
+    impulses.push_back(0.0f);
+    periods.push_back(0.0f);
+
+    auto index(positions.size() - 1);
+    setBody(index, body);
+
+    return index;
+}
+
+void PhysicsWorld::setBody(size_t index, const Body &body) {
+    // Symplectic Euler is stable for springs with (omega * step) < 2; clamp
+    // stiffness a little inside that bound so no configuration can explode
+    float maxOmega(1.9f / stepSeconds);
+
+    rests[index] = body.rest;
+    stiffnesses[index] = min(max(body.stiffness, 0.0f), (maxOmega * maxOmega));
+    dampings[index] = max(body.damping, 0.0f);
+    drags[index] = max(body.drag, 0.0f);
+    impulses[index] = body.impulse;
+    periods[index] = max(body.period, 0.0f);
+
+    // Keep the rhythm of a changed period, without a backlog of kicks
+    phases[index] = ((periods[index] > 0.0f) ? std::fmod(phases[index], periods[index]) : 0.0f);
+}
+
+void PhysicsWorld::kick(size_t index, float velocity) {
+    velocities[index] += velocity;
+}
+
+void PhysicsWorld::advance(float elapsed) {
+    accumulator += max(elapsed, 0.0f);
+
+    // Discard time which could not be caught up without a burst of steps
+    accumulator = min(accumulator, (k_MaxSteps * stepSeconds));
+
+    while (accumulator >= stepSeconds) {
+        step();
+        accumulator -= stepSeconds;
+    }
+
+    alpha = (accumulator / stepSeconds);
+}
+
+float PhysicsWorld::getPosition(size_t index) const {
+    return (previous[index] + (alpha * (positions[index] - previous[index])));
+}
+
+void PhysicsWorld::interpolate(float *results, size_t count) const {
+    count = min(count, positions.size());
+
+    for (size_t i = 0; i < count; i++) {
+        results[i] = (previous[i] + (alpha * (positions[i] - previous[i])));
+    }
+}
+
+
+// Accessors
+
+size_t PhysicsWorld::size() const {
+    return positions.size();
+}
+
+float PhysicsWorld::getStepSeconds() const {
+    return stepSeconds;
+}
+
+
+// Private methods
+
+void PhysicsWorld::step() {
+    const float dt(stepSeconds);
+    const size_t count(positions.size());
+
+    // Branch-free over parallel arrays, so the loop vectorizes across bodies
+    for (size_t i = 0; i < count; i++) {
+        previous[i] = positions[i];
+
+        // Spring force updates velocity first (semi-implicit Euler)
+        float velocity(velocities[i] - (stiffnesses[i] * (positions[i] - rests[i]) * dt));
+
+        // Impulse train excitation, its phase only running while it has a period
+        float armed((periods[i] > 0.0f) ? 1.0f : 0.0f);
+        float phase(phases[i] + (armed * dt));
+        float fire((phase >= periods[i]) ? armed : 0.0f);
+        velocity += (fire * impulses[i]);
+        phases[i] = (phase - (fire * periods[i]));
+
+        // Exponential decay, with a rate which rises with speed; being exact
+        // over the step it is unconditionally stable for any coefficients
+        velocity *= std::exp(-(dampings[i] + (drags[i] * std::fabs(velocity))) * dt);
+
+        velocities[i] = velocity;
+        positions[i] += (velocity * dt);
+    }
+}
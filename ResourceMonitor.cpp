@@ -0,0 +1,218 @@
+#include <unistd.h>
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+#include "ResourceMonitor.h"
+
+// Namespace using directives
+
+using std::cerr;
+using std::endl;
+using std::ifstream;
+using std::int64_t;
+using std::string;
+using std::uint64_t;
+
+
+// Implementation of class ResourceMonitor
+
+// Static attribute initialization
+
+// Names are searched at least this far, and to twice the highest live name
+const GLuint ResourceMonitor::k_MinimumSearch(1024U);
+
+
+// Constructor / destructor
+
+ResourceMonitor::ResourceMonitor() :
+    path(),
+    file(),
+    interval(60.0),
+    nextSample(0.0),
+    frames(0UL),
+    frameTotal(0),
+    frameLongest(0),
+    highestTexture(0U),
+    highestBuffer(0U),
+    highestVertexArray(0U),
+    highestFramebuffer(0U),
+    highestRenderbuffer(0U),
+    highestShader(0U),
+    highestQuery(0U) { }
+
+
+// Public methods
+
+void ResourceMonitor::setPath(const string &p) {
+    if (p == path) return;
+
+    path = p;
+    if (file.is_open()) file.close();
+    if (path.empty()) return;
+
+    file.open(path, std::ios::trunc);
+    if (!file) {
+        cerr << "[WARN] Cannot write resource samples to \"" << path << "\"" << endl;
+        return;
+    }
+
+    file << "frame,seconds,rss_kb,textures,texture_kb,buffers,vertex_arrays,"
+         << "framebuffers,renderbuffers,programs,shaders,queries,frame_ms_avg,frame_ms_max"
+         << endl;
+}
+
+void ResourceMonitor::setInterval(float seconds) {
+    if (seconds > 0.0f) interval = seconds;
+}
+
+void ResourceMonitor::addFrame(int64_t duration) {
+    frames++;
+    frameTotal += duration;
+    frameLongest = std::max(frameLongest, duration);
+}
+
+void ResourceMonitor::update(uint64_t frame, double seconds) {
+    if (!file.is_open() or (seconds < nextSample)) return;
+
+    // The next sample falls an interval on, however late this one was
+    nextSample = (seconds + interval);
+
+    auto sample(measure());
+
+    file << frame << ','
+         << std::fixed << std::setprecision(3)
+         << seconds << ','
+         << sample.rssKb << ','
+         << sample.textures << ','
+         << sample.textureKb << ','
+         << sample.buffers << ','
+         << sample.vertexArrays << ','
+         << sample.framebuffers << ','
+         << sample.renderbuffers << ','
+         << sample.programs << ','
+         << sample.shaders << ','
+         << sample.queries << ','
+         << ((frames > 0) ? ((frameTotal / 1.0e6) / frames) : 0.0) << ','
+         << (frameLongest / 1.0e6)
+         << endl;
+
+    frames = 0UL;
+    frameTotal = 0;
+    frameLongest = 0;
+}
+
+ResourceMonitor::Sample ResourceMonitor::measure() {
+    Sample sample = {};
+
+    sample.rssKb = residentKb();
+
+    // A newly generated name bounds the live names, where a driver hands
+    // out names in increasing order; the probe itself is never bound
+    GLuint probe(0U);
+
+    glGenTextures(1, &probe);
+    glDeleteTextures(1, &probe);
+    sample.textures = countNames(glIsTexture, probe, highestTexture);
+
+    // Texture bytes are read from each live texture in turn
+    GLint bound(0);
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &bound);
+
+    int64_t bytes(0);
+    for (GLuint texture = 1; texture <= highestTexture; texture++) {
+        if (glIsTexture(texture)) bytes += textureBytes(texture);
+    }
+    sample.textureKb = static_cast<long>(bytes / 1024);
+
+    glBindTexture(GL_TEXTURE_2D, bound);
+
+    glGenBuffers(1, &probe);
+    glDeleteBuffers(1, &probe);
+    sample.buffers = countNames(glIsBuffer, probe, highestBuffer);
+
+    glGenVertexArrays(1, &probe);
+    glDeleteVertexArrays(1, &probe);
+    sample.vertexArrays = countNames(glIsVertexArray, probe, highestVertexArray);
+
+    glGenFramebuffers(1, &probe);
+    glDeleteFramebuffers(1, &probe);
+    sample.framebuffers = countNames(glIsFramebuffer, probe, highestFramebuffer);
+
+    glGenRenderbuffers(1, &probe);
+    glDeleteRenderbuffers(1, &probe);
+    sample.renderbuffers = countNames(glIsRenderbuffer, probe, highestRenderbuffer);
+
+    glGenQueries(1, &probe);
+    glDeleteQueries(1, &probe);
+    sample.queries = countNames(glIsQuery, probe, highestQuery);
+
+    // Shaders and programs share one namespace
+    probe = glCreateShader(GL_VERTEX_SHADER);
+    glDeleteShader(probe);
+
+    auto highestProgram(highestShader);
+    sample.shaders = countNames(glIsShader, probe, highestShader);
+    sample.programs = countNames(glIsProgram, probe, highestProgram);
+    highestShader = std::max(highestShader, highestProgram);
+
+    return sample;
+}
+
+
+// Private methods
+
+long ResourceMonitor::countNames(GLboolean (*isName)(GLuint), GLuint probe, GLuint &highest) {
+    auto search(std::max({ probe, (2 * highest), k_MinimumSearch }));
+
+    long count(0L);
+    for (GLuint name = 1; name <= search; name++) {
+        if (isName(name)) {
+            count++;
+            highest = std::max(highest, name);
+        }
+    }
+
+    return count;
+}
+
+int64_t ResourceMonitor::textureBytes(GLuint texture) {
+    glBindTexture(GL_TEXTURE_2D, texture);
+
+    // The driver's own storage sizes, which may be padded beyond the data given
+    const GLenum sizes[] = {
+        GL_TEXTURE_RED_SIZE, GL_TEXTURE_GREEN_SIZE, GL_TEXTURE_BLUE_SIZE,
+        GL_TEXTURE_ALPHA_SIZE, GL_TEXTURE_DEPTH_SIZE, GL_TEXTURE_STENCIL_SIZE
+    };
+
+    int64_t bytes(0);
+    for (GLint level = 0; level < 16; level++) {
+        GLint width(0);
+        GLint height(0);
+        glGetTexLevelParameteriv(GL_TEXTURE_2D, level, GL_TEXTURE_WIDTH, &width);
+        glGetTexLevelParameteriv(GL_TEXTURE_2D, level, GL_TEXTURE_HEIGHT, &height);
+        if ((width == 0) or (height == 0)) break;
+
+        GLint bits(0);
+        for (auto size : sizes) {
+            GLint channelBits(0);
+            glGetTexLevelParameteriv(GL_TEXTURE_2D, level, size, &channelBits);
+            bits += channelBits;
+        }
+
+        bytes += ((static_cast<int64_t>(width) * height * bits) / 8);
+    }
+
+    return bytes;
+}
+
+long ResourceMonitor::residentKb() {
+    // The second field of statm is the resident set, in pages
+    ifstream statm("/proc/self/statm");
+    long pages(0L);
+    long resident(0L);
+    if (!(statm >> pages >> resident)) return -1L;
+
+    return ((resident * sysconf(_SC_PAGESIZE)) / 1024L);
+}
@@ -0,0 +1,484 @@
+#include <GL/glew.h>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include "FileWatcher.h"
+#include "FlorbUtils.h"
+#include "GLDebug.h"
+#include "ShaderProgram.h"
+#include "Tracer.h"
+
+// Parallel shader compile tokens, for GLEW builds which predate them
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+// Namespace using directives
+
+namespace chrono = std::chrono;
+
+using std::cerr;
+using std::cout;
+using std::endl;
+using std::ifstream;
+using std::lock_guard;
+using std::make_shared;
+using std::mutex;
+using std::ostringstream;
+using std::runtime_error;
+using std::string;
+using std::thread;
+using std::unique_lock;
+using std::vector;
+
+
+// Implementation of class ShaderProgram
+
+// Static attribute initialization
+
+const chrono::milliseconds ShaderProgram::k_WatchInterval(500);
+
+
+// Constructor / destructor
+
+ShaderProgram::ShaderProgram(const string &vertexPath,
+                             const string &fragmentPath,
+                             bool hotReload) :
+    vertexPath(vertexPath),
+    fragmentPath(fragmentPath),
+    prelude(),
+    preludeChanged(false),
+    buildPrelude(),
+    livePrelude(),
+    program(0),
+    generation(0U),
+    compileMode(CompileMode::SYNCHRONOUS),
+    watcher(),
+    watchedGeneration(0U),
+    pending(),
+    building(false),
+    threadDisplay(nullptr),
+    threadContext(nullptr),
+    compiler(),
+    compileMutex(),
+    compileWake(),
+    compileRunning(false),
+    compileRequested(false),
+    requestedVertex(),
+    requestedFragment(),
+    compiledProgram(0),
+    compileDone(false),
+    compileFailed(false) {
+
+    if (hotReload) {
+        initCompileMode();
+
+        watcher = make_shared<FileWatcher>(vector<string>{vertexPath, fragmentPath},
+                                           k_WatchInterval);
+        watchedGeneration = watcher->getGeneration();
+    }
+}
+
+ShaderProgram::~ShaderProgram() {
+    // Stop watching before tearing down the compiler
+    watcher.reset();
+
+    if (compiler.joinable()) {
+        {
+            lock_guard<mutex> lock(compileMutex);
+            compileRunning = false;
+        }
+
+        compileWake.notify_all();
+        compiler.join();
+
+        if (compileDone and (compiledProgram != 0)) glDeleteProgram(compiledProgram);
+        glXDestroyContext(threadDisplay, threadContext);
+    }
+
+    if (building and (compileMode != CompileMode::THREAD)) {
+        finishBuild(pending);
+        glDeleteProgram(pending.program);
+    }
+
+    glDeleteProgram(program);
+}
+
+
+// Public methods
+
+void ShaderProgram::build() {
+    preludeChanged = false;
+    buildPrelude = prelude;
+
+    Build initial(startBuild(loadSource(vertexPath), loadSource(fragmentPath)));
+
+    if (finishBuild(initial)) {
+        swap(initial.program);
+    } else {
+        cerr << "[ERROR] Shader program \""
+             << vertexPath
+             << "\" / \""
+             << fragmentPath
+             << "\" failed to build"
+             << endl;
+    }
+}
+
+bool ShaderProgram::update() {
+    if (!watcher and !preludeChanged) return false;
+
+    // A shared-context compiler which could not start degrades to synchronous,
+    // re-issuing any build it had been handed
+    bool retry(false);
+    if ((compileMode == CompileMode::THREAD) and compileFailed) {
+        cerr << "[WARN] Shader compile thread unavailable, compiling synchronously" << endl;
+        compileMode = CompileMode::SYNCHRONOUS;
+        retry = building;
+        building = false;
+    }
+
+    bool swapped(false);
+
+    if (building) {
+        // Poll the in-flight build without ever blocking the frame
+        if (compileMode == CompileMode::THREAD) {
+            if (compileDone.exchange(false, std::memory_order_acquire)) {
+                building = false;
+
+                if (compiledProgram != 0) {
+                    swap(compiledProgram);
+                    swapped = true;
+                }
+            }
+        } else if (isComplete(pending)) {
+            building = false;
+
+            if (finishBuild(pending)) {
+                swap(pending.program);
+                swapped = true;
+            }
+        }
+    } else if (retry or
+               preludeChanged or
+               (watcher and (watcher->getGeneration() != watchedGeneration))) {
+        if (watcher) watchedGeneration = watcher->getGeneration();
+        preludeChanged = false;
+        requestBuild();
+
+        // Synchronous builds complete within the request itself
+        if (building and (compileMode == CompileMode::SYNCHRONOUS)) {
+            building = false;
+
+            if (finishBuild(pending)) {
+                swap(pending.program);
+                swapped = true;
+            }
+        }
+    }
+
+    return swapped;
+}
+
+
+void ShaderProgram::setPrelude(const string &p) {
+    if (p == prelude) return;
+
+    prelude = p;
+    preludeChanged = true;
+}
+
+bool ShaderProgram::isPreludeLive() const {
+    return ((program != 0) and (livePrelude == prelude));
+}
+
+
+// Accessors
+
+GLuint ShaderProgram::getProgram() const {
+    return program;
+}
+
+unsigned int ShaderProgram::getGeneration() const {
+    return generation;
+}
+
+
+// Private methods
+
+string ShaderProgram::readSource(const string &path) {
+    static const string k_Context(__PRETTY_FUNCTION__);
+
+    ifstream file(path);
+    if (!file.is_open()) {
+        ostringstream excStream;
+        excStream << k_Context
+                  << " : Could not open shader source \""
+                  << path
+                  << "\"";
+
+        throw runtime_error(excStream.str());
+    }
+
+    ostringstream source;
+    source << file.rdbuf();
+
+    return source.str();
+}
+
+string ShaderProgram::loadSource(const string &path) const {
+    string source(readSource(path));
+    if (prelude.empty()) return source;
+
+    // The prelude must follow the #version directive; #line keeps compiler
+    // diagnostics pointing at the lines of the file on disk
+    size_t insert(0);
+    if (source.compare(0, 8, "#version") == 0) {
+        insert = source.find('\n');
+        insert = ((insert == string::npos) ? source.size() : (insert + 1));
+    }
+
+    ostringstream lineDirective;
+    lineDirective << "#line " << (insert == 0 ? 1 : 2) << "\n";
+
+    return source.substr(0, insert) + prelude + "\n" + lineDirective.str() + source.substr(insert);
+}
+
+ShaderProgram::Build ShaderProgram::startBuild(const string &vertexSource,
+                                               const string &fragmentSource) {
+    Tracer::Scope scope("shaders", "compile");
+
+    Build build;
+
+    // Issue compilation and linkage without querying any status, permitting
+    // drivers with parallel compilation to do the work asynchronously
+    const char *vertexText(vertexSource.c_str());
+    build.vertexShader = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(build.vertexShader, 1, &vertexText, nullptr);
+    glCompileShader(build.vertexShader);
+
+    const char *fragmentText(fragmentSource.c_str());
+    build.fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(build.fragmentShader, 1, &fragmentText, nullptr);
+    glCompileShader(build.fragmentShader);
+
+    build.program = glCreateProgram();
+    glAttachShader(build.program, build.vertexShader);
+    glAttachShader(build.program, build.fragmentShader);
+    glLinkProgram(build.program);
+    FlorbUtils::glCheck("glLinkProgram()");
+
+    return build;
+}
+
+bool ShaderProgram::finishBuild(Build &build) {
+    Tracer::Scope scope("shaders", "link");
+
+    GLint vertexStatus(0);
+    glGetShaderiv(build.vertexShader, GL_COMPILE_STATUS, &vertexStatus);
+    if (vertexStatus != GL_TRUE) {
+        char infoLog[2048];
+        glGetShaderInfoLog(build.vertexShader, sizeof(infoLog), nullptr, infoLog);
+        cerr << "[Vertex Shader Compile Error]\n" << infoLog << endl;
+    }
+
+    GLint fragmentStatus(0);
+    glGetShaderiv(build.fragmentShader, GL_COMPILE_STATUS, &fragmentStatus);
+    if (fragmentStatus != GL_TRUE) {
+        char infoLog[2048];
+        glGetShaderInfoLog(build.fragmentShader, sizeof(infoLog), nullptr, infoLog);
+        cerr << "[Fragment Shader Compile Error]\n" << infoLog << endl;
+    }
+
+    GLint linkStatus(0);
+    glGetProgramiv(build.program, GL_LINK_STATUS, &linkStatus);
+    if (linkStatus != GL_TRUE) {
+        char log[2048];
+        glGetProgramInfoLog(build.program, sizeof(log), nullptr, log);
+        cerr << "Shader Link Error:\n" << log << endl;
+    }
+
+    // Free the memory used by both shader objects
+    glDetachShader(build.program, build.vertexShader);
+    glDetachShader(build.program, build.fragmentShader);
+    glDeleteShader(build.vertexShader);
+    glDeleteShader(build.fragmentShader);
+    FlorbUtils::glCheck("glDeleteShader()");
+
+    // Failed programs are discarded, leaving any live program in place
+    if (linkStatus != GL_TRUE) {
+        glDeleteProgram(build.program);
+        build.program = 0;
+        return false;
+    }
+
+    return true;
+}
+
+bool ShaderProgram::isComplete(const Build &build) const {
+    if (compileMode != CompileMode::PARALLEL) return true;
+
+    GLint complete(GL_FALSE);
+    glGetProgramiv(build.program, GL_COMPLETION_STATUS_KHR, &complete);
+
+    return (complete == GL_TRUE);
+}
+
+void ShaderProgram::initCompileMode() {
+    typedef void (*glMaxShaderCompilerThreadsProc)(GLuint);
+
+    // Prefer driver-side parallel compilation, polled once per frame
+    const char *maxThreadsName(nullptr);
+    if (glewIsSupported("GL_KHR_parallel_shader_compile")) {
+        maxThreadsName = "glMaxShaderCompilerThreadsKHR";
+    } else if (glewIsSupported("GL_ARB_parallel_shader_compile")) {
+        maxThreadsName = "glMaxShaderCompilerThreadsARB";
+    }
+
+    if (maxThreadsName != nullptr) {
+        auto glMaxShaderCompilerThreads = (glMaxShaderCompilerThreadsProc)
+            glXGetProcAddress((const GLubyte*)maxThreadsName);
+
+        // Let the driver choose its own compiler thread count
+        if (glMaxShaderCompilerThreads) glMaxShaderCompilerThreads(0xFFFFFFFFU);
+
+        compileMode = CompileMode::PARALLEL;
+        cout << "[INFO] Shader hot reload using parallel shader compilation" << endl;
+    } else if (initCompileThread()) {
+        compileMode = CompileMode::THREAD;
+        cout << "[INFO] Shader hot reload using a shared-context compile thread" << endl;
+    } else {
+        compileMode = CompileMode::SYNCHRONOUS;
+        cerr << "[WARN] Shader hot reload compiling synchronously" << endl;
+    }
+}
+
+bool ShaderProgram::initCompileThread() {
+    typedef GLXContext (*glXCreateContextAttribsARBProc)(Display*, GLXFBConfig, GLXContext, Bool, const int*);
+
+    GLXContext sharedContext(glXGetCurrentContext());
+    threadDisplay = glXGetCurrentDisplay();
+    if (!sharedContext or !threadDisplay) return false;
+
+    auto glXCreateContextAttribsARB = (glXCreateContextAttribsARBProc)
+        glXGetProcAddress((const GLubyte*)"glXCreateContextAttribsARB");
+    if (!glXCreateContextAttribsARB) return false;
+
+    // Recover the framebuffer configuration of the rendering context
+    int configID(0);
+    int screen(0);
+    glXQueryContext(threadDisplay, sharedContext, GLX_FBCONFIG_ID, &configID);
+    glXQueryContext(threadDisplay, sharedContext, GLX_SCREEN, &screen);
+
+    int configAttribs[] = { GLX_FBCONFIG_ID, configID, None };
+    int configCount(0);
+    GLXFBConfig *configs(glXChooseFBConfig(threadDisplay, screen, configAttribs, &configCount));
+    if (!configs or (configCount == 0)) return false;
+
+    int contextAttribs[] = {
+        GLX_CONTEXT_MAJOR_VERSION_ARB, 3,
+        GLX_CONTEXT_MINOR_VERSION_ARB, 3,
+        GLX_CONTEXT_PROFILE_MASK_ARB, GLX_CONTEXT_CORE_PROFILE_BIT_ARB,
+        None
+    };
+
+    // Share object names with the rendering context so linked programs transfer
+    threadContext = glXCreateContextAttribsARB(threadDisplay,
+                                               configs[0],
+                                               sharedContext,
+                                               True,
+                                               contextAttribs);
+    XFree(configs);
+    if (!threadContext) return false;
+
+    compileRunning = true;
+    compiler = thread(&ShaderProgram::compileLoop, this);
+
+    return true;
+}
+
+void ShaderProgram::compileLoop() {
+    Tracer::setThreadName("shader compiler");
+
+    // GL 3.0+ contexts may be made current without any drawable
+    if (!glXMakeContextCurrent(threadDisplay, None, None, threadContext)) {
+        compileFailed = true;
+        return;
+    }
+
+    unique_lock<mutex> lock(compileMutex);
+    while (true) {
+        compileWake.wait(lock, [this] { return (compileRequested or !compileRunning); });
+        if (!compileRunning) break;
+
+        string vertexSource(std::move(requestedVertex));
+        string fragmentSource(std::move(requestedFragment));
+        compileRequested = false;
+        lock.unlock();
+
+        Build build(startBuild(vertexSource, fragmentSource));
+        bool linked(finishBuild(build));
+
+        // Ensure the program is complete before the render thread adopts it
+        glFinish();
+
+        compiledProgram = (linked ? build.program : 0);
+        compileDone.store(true, std::memory_order_release);
+
+        lock.lock();
+    }
+
+    glXMakeContextCurrent(threadDisplay, None, None, nullptr);
+}
+
+void ShaderProgram::requestBuild() {
+    string vertexSource;
+    string fragmentSource;
+
+    try {
+        vertexSource = loadSource(vertexPath);
+        fragmentSource = loadSource(fragmentPath);
+    } catch (const std::exception &exc) {
+        cerr << "[WARN] Shader reload skipped : " << exc.what() << endl;
+        return;
+    }
+
+    cout << "[INFO] Recompiling shader program \""
+         << vertexPath
+         << "\" / \""
+         << fragmentPath
+         << "\""
+         << endl;
+
+    building = true;
+    buildPrelude = prelude;
+    Tracer::instant("shaders", "reload");
+
+    if (compileMode == CompileMode::THREAD) {
+        {
+            lock_guard<mutex> lock(compileMutex);
+            requestedVertex = vertexSource;
+            requestedFragment = fragmentSource;
+            compileRequested = true;
+        }
+
+        compileWake.notify_one();
+    } else {
+        pending = startBuild(vertexSource, fragmentSource);
+    }
+}
+
+void ShaderProgram::swap(GLuint linked) {
+    if (program != 0) glDeleteProgram(program);
+
+    program = linked;
+    generation++;
+
+    // Only one build is ever in flight, so this is the prelude it was given
+    livePrelude = buildPrelude;
+
+    // Captures name the live program after its sources
+    GLDebug::label(GL_PROGRAM, program, (vertexPath + " / " + fragmentPath));
+}
@@ -0,0 +1,322 @@
+#include <GL/glew.h>
+#include <glm/gtc/type_ptr.hpp>
+#include <cstring>
+#include <iostream>
+
+#include "FlorbUtils.h"
+#include "GLDebug.h"
+#include "ShaderProgram.h"
+#include "ShaderUniforms.h"
+
+// Namespace using directives
+
+using std::cerr;
+using std::endl;
+using std::memcmp;
+using std::memcpy;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+
+// Implementation of class UniformBuffer
+
+// Constructor / destructor
+
+UniformBuffer::UniformBuffer(const string &name, GLuint binding, size_t size) :
+    name(name),
+    binding(binding),
+    size(size),
+    buffer(0),
+    shadow(size, 0),
+    valid(false),
+    uploads(0U) {
+
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+    GLDebug::label(GL_BUFFER, buffer, name);
+    glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+    glBindBufferBase(GL_UNIFORM_BUFFER, binding, buffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    FlorbUtils::glCheck("UniformBuffer()");
+}
+
+UniformBuffer::~UniformBuffer() {
+    glDeleteBuffers(1, &buffer);
+}
+
+
+// Accessors
+
+const string& UniformBuffer::getName() const {
+    return name;
+}
+
+GLuint UniformBuffer::getBinding() const {
+    return binding;
+}
+
+
+// Public methods
+
+bool UniformBuffer::bind(GLuint program) {
+    GLuint index(glGetUniformBlockIndex(program, name.c_str()));
+    if (index == GL_INVALID_INDEX) return false;
+
+    // Verify the CPU-side mirror covers the std140 layout the linker chose
+    GLint dataSize(0);
+    glGetActiveUniformBlockiv(program, index, GL_UNIFORM_BLOCK_DATA_SIZE, &dataSize);
+    if (static_cast<size_t>(dataSize) > size) {
+        cerr << "[WARN] Uniform block \""
+             << name
+             << "\" is "
+             << dataSize
+             << " bytes in the shader, but "
+             << size
+             << " bytes on the host"
+             << endl;
+    }
+
+    glUniformBlockBinding(program, index, binding);
+    FlorbUtils::glCheck("glUniformBlockBinding()");
+
+    return true;
+}
+
+bool UniformBuffer::upload(const void *data) {
+    const auto *bytes(static_cast<const unsigned char*>(data));
+
+    // Locate the span of bytes which differ from the last upload
+    size_t first(0);
+    size_t last(size);
+    if (valid) {
+        while ((first < size) and (bytes[first] == shadow[first])) first++;
+        if (first == size) return false;
+
+        while (bytes[last - 1] == shadow[last - 1]) last--;
+    }
+
+    glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+    glBufferSubData(GL_UNIFORM_BUFFER, first, (last - first), (bytes + first));
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    memcpy(shadow.data() + first, bytes + first, (last - first));
+    valid = true;
+    uploads++;
+
+    return true;
+}
+
+void UniformBuffer::invalidate() {
+    valid = false;
+}
+
+unsigned int UniformBuffer::takeUploads() {
+    unsigned int taken(uploads);
+    uploads = 0U;
+
+    return taken;
+}
+
+
+// Implementation of class ShaderUniforms
+
+// Constructor
+
+ShaderUniforms::ShaderUniforms(shared_ptr<ShaderProgram> shaders) :
+    shaders(shaders),
+    program(0),
+    generation(0U),
+    actives(),
+    slots(),
+    blocks(),
+    frameCalls(0U),
+    lastFrameCalls(0U),
+    lastFrameUploads(0U) {
+
+    // Force reflection of whichever program is already linked
+    generation = (shaders->getGeneration() - 1U);
+    update();
+}
+
+
+// Public methods
+
+bool ShaderUniforms::update() {
+    if (shaders->getGeneration() == generation) return false;
+
+    program = shaders->getProgram();
+    generation = shaders->getGeneration();
+
+    reflect();
+
+    for (auto &slot : slots) resolve(slot);
+
+    for (auto &block : blocks) {
+        block->bind(program);
+        frameCalls++;
+    }
+
+    return true;
+}
+
+void ShaderUniforms::endFrame() {
+    unsigned int uploads(0U);
+    for (auto &block : blocks) uploads += block->takeUploads();
+
+    lastFrameCalls = (frameCalls + uploads);
+    lastFrameUploads = uploads;
+
+    frameCalls = 0U;
+}
+
+
+// Accessors
+
+unsigned int ShaderUniforms::getFrameCalls() const {
+    return lastFrameCalls;
+}
+
+unsigned int ShaderUniforms::getFrameUploads() const {
+    return lastFrameUploads;
+}
+
+
+// Typed setters
+
+void ShaderUniforms::set(size_t slot, GLint value) {
+    auto &target(slots[slot]);
+    if ((target.location < 0) or unchanged(target, &value, sizeof(value))) return;
+
+    glUniform1i(target.location, value);
+    frameCalls++;
+}
+
+void ShaderUniforms::set(size_t slot, GLfloat value) {
+    auto &target(slots[slot]);
+    if ((target.location < 0) or unchanged(target, &value, sizeof(value))) return;
+
+    glUniform1f(target.location, value);
+    frameCalls++;
+}
+
+void ShaderUniforms::set(size_t slot, const glm::vec2 &value) {
+    auto &target(slots[slot]);
+    if ((target.location < 0) or unchanged(target, &value, sizeof(value))) return;
+
+    glUniform2f(target.location, value[0], value[1]);
+    frameCalls++;
+}
+
+void ShaderUniforms::set(size_t slot, const glm::vec3 &value) {
+    auto &target(slots[slot]);
+    if ((target.location < 0) or unchanged(target, &value, sizeof(value))) return;
+
+    glUniform3f(target.location, value[0], value[1], value[2]);
+    frameCalls++;
+}
+
+void ShaderUniforms::set(size_t slot, const glm::mat4 &value) {
+    auto &target(slots[slot]);
+    if ((target.location < 0) or unchanged(target, &value, sizeof(value))) return;
+
+    glUniformMatrix4fv(target.location, 1, GL_FALSE, glm::value_ptr(value));
+    frameCalls++;
+}
+
+
+// Private methods
+
+void ShaderUniforms::reflect() {
+    actives.clear();
+    if (program == 0) return;
+
+    GLint count(0);
+    GLint maxLength(0);
+    glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+
+    vector<char> nameBuffer(maxLength + 1, '\0');
+    for (GLint i = 0; i < count; i++) {
+        Active active;
+        GLsizei length(0);
+
+        glGetActiveUniform(program,
+                           i,
+                           nameBuffer.size(),
+                           &length,
+                           &active.size,
+                           &active.type,
+                           nameBuffer.data());
+        active.name.assign(nameBuffer.data(), length);
+
+        // Uniform block members report no location, and are handled by blocks
+        active.location = glGetUniformLocation(program, nameBuffer.data());
+        if (active.location < 0) continue;
+
+        // Arrays are reported by their first element
+        auto bracket(active.name.find('['));
+        if (bracket != string::npos) active.name.erase(bracket);
+
+        actives.push_back(active);
+    }
+
+    FlorbUtils::glCheck("ShaderUniforms::reflect()");
+}
+
+size_t ShaderUniforms::addSlot(const string &name, GLenum expectedType) {
+    for (size_t i = 0; i < slots.size(); i++) {
+        if (slots[i].name == name) return i;
+    }
+
+    slots.push_back({name, expectedType, -1, false, {}});
+    resolve(slots.back());
+
+    return (slots.size() - 1);
+}
+
+void ShaderUniforms::resolve(Slot &slot) {
+    slot.location = -1;
+    slot.cached = false;
+
+    for (const auto &active : actives) {
+        if (active.name != slot.name) continue;
+
+        // Integer handles also drive boolean and sampler uniforms
+        bool matches(active.type == slot.expectedType);
+        if (slot.expectedType == GL_INT) {
+            matches |= ((active.type == GL_BOOL) or
+                        (active.type == GL_SAMPLER_2D));
+        }
+
+        if (matches) {
+            slot.location = active.location;
+        } else {
+            cerr << "[WARN] Uniform \""
+                 << slot.name
+                 << "\" has GL type 0x"
+                 << std::hex
+                 << active.type
+                 << ", expected 0x"
+                 << slot.expectedType
+                 << std::dec
+                 << endl;
+        }
+
+        break;
+    }
+}
+
+bool ShaderUniforms::unchanged(Slot &slot, const void *value, size_t size) {
+    if (slot.cached and
+        (slot.value.size() == size) and
+        (memcmp(slot.value.data(), value, size) == 0)) {
+        return true;
+    }
+
+    const auto *bytes(static_cast<const unsigned char*>(value));
+    slot.value.assign(bytes, bytes + size);
+    slot.cached = true;
+
+    return false;
+}
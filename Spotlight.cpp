@@ -1,15 +1,14 @@
+#include <glm/gtc/type_ptr.hpp>
 #include <iostream>
 #include <math.h>
 
-#include "LinearMotion.h"
+#include "MultiMotion.h"
 #include "Spotlight.h"
 
 // Namespace using directives
 
 using std::cerr;
 using std::endl;
-using std::lock_guard;
-using std::mutex;
 using std::shared_ptr;
 using std::string;
 using std::vector;
@@ -24,71 +23,63 @@ Spotlight::Spotlight(const string &name,
                      float intensity,
                      const vector<float> &color) :
     name(name),
-    direction(direction),
-    intensity(intensity),
-    color(color),
-    linear() { }
+    state({glm::make_vec3(direction.data()), intensity, glm::make_vec3(color.data())}),
+    motion() { }
 
 Spotlight::Spotlight(const string &name,
                      const vector<float> &direction,
                      float intensity,
                      const vector<float> &color,
-                     shared_ptr<LinearMotion> linear) :
+                     shared_ptr<MultiMotion> motion) :
   Spotlight(name, direction, intensity, color) {
-    this->linear = linear;
+    this->motion = motion;
 }
 
 
 // Accessors / mutators
 
-const vector<float>& Spotlight::getDirection() const {
-    lock_guard<mutex> lock(stateMutex);
-    return direction;
+Spotlight::State Spotlight::getState() const {
+    return state.load();
+}
+
+glm::vec3 Spotlight::getDirection() const {
+    return state.load().direction;
 }
 
 void Spotlight::setDirection(float alpha, float beta, float phi) {
-    lock_guard<mutex> lock(stateMutex);
-    direction[0] = alpha;
-    direction[1] = beta;
-    direction[2] = phi;
+    state.modify([&](State &s) { s.direction = glm::vec3(alpha, beta, phi); });
 }
 
 float Spotlight::getIntensity() const {
-    lock_guard<mutex> lock(stateMutex);
-    return intensity;
+    return state.load().intensity;
 }
 
 void Spotlight::setIntensity(float i) {
-    lock_guard<mutex> lock(stateMutex);
-    intensity = i;
+    state.modify([&](State &s) { s.intensity = i; });
 }
 
-const vector<float>& Spotlight::getColor() const {
-    lock_guard<mutex> lock(stateMutex);
-    return color;
+glm::vec3 Spotlight::getColor() const {
+    return state.load().color;
 }
 
 void Spotlight::setColor(float r, float g, float b) {
-    lock_guard<mutex> lock(stateMutex);
-    color[0] = r;
-    color[1] = g;
-    color[2] = b;
+    state.modify([&](State &s) { s.color = glm::vec3(r, g, b); });
 }
 
 
 // Motion update method
 
 void Spotlight::updateMotion(float time) {
-    if (linear and linear->getEnabled()) {
-        vector<float> wrapped;
+    if (motion and motion->getEnabled()) {
+        glm::vec3 wrapped(0.0f, 0.0f, 0.0f);
         
-        auto result(linear->vectorEvaluate(time));
+        motion->evaluate(time, glm::value_ptr(wrapped), 3);
         const float TWO_PI(2.0f * M_PI);
         
-        for (size_t i = 0; i < result.size(); i++) {
-            wrapped.push_back(fmod(result[i] + TWO_PI, 2.0f * TWO_PI) - TWO_PI);
+        for (int i = 0; i < 3; i++) {
+            wrapped[i] = (fmod(wrapped[i] + TWO_PI, 2.0f * TWO_PI) - TWO_PI);
         }
 
-        setDirection(wrapped[0], wrapped[1], wrapped[2]);
+        state.modify([&](State &s) { s.direction = wrapped; });
     }
 }
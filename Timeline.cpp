@@ -0,0 +1,165 @@
+#include <algorithm>
+
+#include "Timeline.h"
+
+// Namespace using directives
+
+namespace chrono = std::chrono;
+
+using std::int64_t;
+using std::make_shared;
+using std::shared_ptr;
+using std::vector;
+
+
+// Implementation of class Timeline
+
+// Static attribute initialization
+
+// Wheel granularity and size; events further out than one revolution simply
+// remain in their slot until a later pass finds them due
+const Timeline::Duration Timeline::k_Tick(chrono::milliseconds(1));
+
+const size_t Timeline::k_Slots(1024);
+
+
+// Constructor
+
+Timeline::Timeline() :
+    clock(make_shared<Clock>()),
+    now(0),
+    tick(0),
+    wheel(k_Slots),
+    due(),
+    nextId(1UL),
+    pending(0) { }
+
+
+// Public methods
+
+unsigned long Timeline::schedule(Duration at, Action action) {
+    return scheduleEvery(at, Duration(0), action);
+}
+
+unsigned long Timeline::scheduleEvery(Duration first, Duration period, Action action) {
+    auto id(nextId++);
+
+    insert({first, period, id, action});
+
+    return id;
+}
+
+void Timeline::cancel(unsigned long id) {
+    for (auto &slot : wheel) {
+        for (size_t i = 0; i < slot.size(); i++) {
+            if (slot[i].id == id) {
+                if ((i + 1) < slot.size()) slot[i] = std::move(slot.back());
+                slot.pop_back();
+                pending--;
+                return;
+            }
+        }
+    }
+
+    // An event may cancel itself, or a later one, while events are firing
+    for (auto &event : due) {
+        if (event.id == id) {
+            event.action = nullptr;
+            event.period = Duration(0);
+        }
+    }
+}
+
+void Timeline::advance() {
+    clock->tick();
+    advance(sample());
+}
+
+void Timeline::advance(Duration time) {
+    // Time only ever moves forward
+    if (time < now) return;
+
+    now = time;
+    int64_t target(now / k_Tick);
+
+    // Visit the current slot and each one passed since, or every slot once
+    // after a long gap such as a suspend
+    int64_t slots(std::min((target - tick + 1), static_cast<int64_t>(k_Slots)));
+    for (int64_t i = 0; i < slots; i++) {
+        collect(wheel[(tick + i) % k_Slots]);
+    }
+
+    tick = target;
+    if (due.empty()) return;
+
+    // Fire in deadline order, re-arming periodic events on their own grid
+    std::stable_sort(due.begin(), due.end(),
+                     [](const Event &a, const Event &b) { return (a.deadline < b.deadline); });
+
+    for (size_t i = 0; i < due.size(); i++) {
+        if (due[i].action) due[i].action(due[i].deadline);
+    }
+
+    for (auto &event : due) {
+        if (!event.action or (event.period <= Duration(0))) continue;
+
+        // Skip any periods missed entirely, keeping the original phase
+        event.deadline += (event.period * (((now - event.deadline) / event.period) + 1));
+        insert(std::move(event));
+    }
+
+    due.clear();
+}
+
+void Timeline::setClock(shared_ptr<Clock> c) {
+    clock = c;
+}
+
+
+// Accessors
+
+Timeline::Duration Timeline::getTime() const {
+    return now;
+}
+
+Timeline::Duration Timeline::sample() const {
+    return std::max(clock->now(), now);
+}
+
+float Timeline::getSeconds() const {
+    return toSeconds(now);
+}
+
+size_t Timeline::getPending() const {
+    return pending;
+}
+
+Timeline::Duration Timeline::fromSeconds(double seconds) {
+    return chrono::duration_cast<Duration>(chrono::duration<double>(seconds));
+}
+
+float Timeline::toSeconds(Duration duration) {
+    return static_cast<float>(chrono::duration<double>(duration).count());
+}
+
+
+// Private methods
+
+void Timeline::insert(Event &&event) {
+    // Events already due land in the current slot, visited on every advance
+    int64_t eventTick(std::max((event.deadline / k_Tick), tick));
+
+    wheel[eventTick % k_Slots].push_back(std::move(event));
+    pending++;
+}
+
+void Timeline::collect(vector<Event> &slot) {
+    for (size_t i = 0; i < slot.size();) {
+        if (slot[i].deadline <= now) {
+            due.push_back(std::move(slot[i]));
+            if ((i + 1) < slot.size()) slot[i] = std::move(slot.back());
+            slot.pop_back();
+            pending--;
+        } else i++;
+    }
+}
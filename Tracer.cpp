@@ -0,0 +1,256 @@
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "Tracer.h"
+
+// Namespace using directives
+
+using std::cerr;
+using std::cout;
+using std::endl;
+using std::int64_t;
+using std::lock_guard;
+using std::make_shared;
+using std::mutex;
+using std::ofstream;
+using std::shared_ptr;
+using std::string;
+using std::uint64_t;
+using std::vector;
+
+
+// Implementation of class Tracer
+
+// Static attribute initialization
+
+std::atomic<bool> Tracer::enabled(false);
+
+std::atomic<uint64_t> Tracer::flows(0UL);
+
+mutex Tracer::buffersMutex;
+
+vector<shared_ptr<Tracer::Buffer>> Tracer::buffers;
+
+string Tracer::path;
+
+
+// Scoped events
+
+Tracer::Scope::Scope(const char *category, const char *name) :
+    category(category),
+    name(name),
+    start(isEnabled() ? now() : 0) { }
+
+Tracer::Scope::~Scope() {
+    if (start != 0) complete(category, name, start, (now() - start));
+}
+
+
+// Public methods
+
+void Tracer::start(const string &p) {
+    {
+        lock_guard<mutex> lock(buffersMutex);
+        path = p;
+    }
+
+    enabled.store(true, std::memory_order_release);
+
+    cout << "[INFO] Tracing to \"" << p << "\"" << endl;
+}
+
+void Tracer::stop() {
+    if (!enabled.exchange(false, std::memory_order_acq_rel)) return;
+
+    write();
+}
+
+bool Tracer::isEnabled() {
+    return enabled.load(std::memory_order_relaxed);
+}
+
+void Tracer::setThreadName(const char *name) {
+    auto &buffer(threadBuffer());
+
+    lock_guard<mutex> lock(buffer.chunksMutex);
+    buffer.threadName = name;
+}
+
+void Tracer::complete(const char *category, const char *name, int64_t start, int64_t duration) {
+    if (isEnabled()) record('X', category, name, start, duration);
+}
+
+void Tracer::complete(const char *category, const string &name, int64_t start, int64_t duration) {
+    if (!isEnabled()) return;
+
+    // Only this thread adds names, and the writer reads only through events
+    auto &names(threadBuffer().names);
+    record('X', category, names.insert(name).first->c_str(), start, duration);
+}
+
+void Tracer::instant(const char *category, const char *name) {
+    if (isEnabled()) record('i', category, name, now());
+}
+
+void Tracer::counter(const char *name, double value) {
+    if (isEnabled()) record('C', "counters", name, now(), 0, value);
+}
+
+uint64_t Tracer::newFlow() {
+    return (flows.fetch_add(1UL, std::memory_order_relaxed) + 1UL);
+}
+
+void Tracer::flowBegin(const char *category, const char *name, uint64_t id) {
+    if (isEnabled()) record('s', category, name, now(), 0, 0.0, id);
+}
+
+void Tracer::flowStep(const char *category, const char *name, uint64_t id) {
+    if (isEnabled()) record('t', category, name, now(), 0, 0.0, id);
+}
+
+void Tracer::flowEnd(const char *category, const char *name, uint64_t id) {
+    if (isEnabled()) record('f', category, name, now(), 0, 0.0, id);
+}
+
+int64_t Tracer::now() {
+    timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    return ((static_cast<int64_t>(time.tv_sec) * 1000000000) + time.tv_nsec);
+}
+
+
+// Private methods
+
+Tracer::Buffer& Tracer::threadBuffer() {
+    static thread_local Buffer *local(nullptr);
+
+    if (!local) {
+        // Buffers are shared with the registry, so they outlive their threads
+        auto buffer(make_shared<Buffer>());
+        buffer->threadId = syscall(SYS_gettid);
+        buffer->threadName = nullptr;
+        buffer->count = 0;
+        buffer->dropped = 0UL;
+
+        lock_guard<mutex> lock(buffersMutex);
+        buffers.push_back(buffer);
+        local = buffer.get();
+    }
+
+    return *local;
+}
+
+void Tracer::record(char phase,
+                    const char *category,
+                    const char *name,
+                    int64_t timestamp,
+                    int64_t duration,
+                    double value,
+                    uint64_t id) {
+    auto &buffer(threadBuffer());
+
+    auto index(buffer.count.load(std::memory_order_relaxed));
+    auto chunk(index / k_ChunkEvents);
+
+    if (chunk >= buffer.chunks.size()) {
+        if (chunk >= k_MaxChunks) {
+            buffer.dropped.fetch_add(1UL, std::memory_order_relaxed);
+            return;
+        }
+
+        lock_guard<mutex> lock(buffer.chunksMutex);
+        buffer.chunks.emplace_back(new Event[k_ChunkEvents]);
+    }
+
+    buffer.chunks[chunk][index % k_ChunkEvents] = { category, name, timestamp, duration, value, id, phase };
+
+    // Publish the event to the writer
+    buffer.count.store((index + 1), std::memory_order_release);
+}
+
+void Tracer::write() {
+    lock_guard<mutex> lock(buffersMutex);
+
+    ofstream file(path);
+    if (!file) {
+        cerr << "[WARN] Could not open trace file \"" << path << "\"" << endl;
+        return;
+    }
+
+    auto pid(getpid());
+    unsigned long events(0UL);
+    unsigned long dropped(0UL);
+
+    file << std::fixed << std::setprecision(3);
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+    bool first(true);
+    auto separator = [&first, &file]() {
+        file << (first ? "" : ",\n");
+        first = false;
+    };
+
+    for (const auto &buffer : buffers) {
+        lock_guard<mutex> chunksLock(buffer->chunksMutex);
+        auto count(buffer->count.load(std::memory_order_acquire));
+
+        if (buffer->threadName) {
+            separator();
+            file << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":" << pid
+                 << ",\"tid\":" << buffer->threadId
+                 << ",\"args\":{\"name\":\"" << buffer->threadName << "\"}}";
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            const auto &event(buffer->chunks[i / k_ChunkEvents][i % k_ChunkEvents]);
+
+            // Trace timestamps are in microseconds
+            separator();
+            file << "{\"ph\":\"" << event.phase
+                 << "\",\"cat\":\"" << event.category
+                 << "\",\"name\":\"" << event.name
+                 << "\",\"ts\":" << (event.timestamp / 1000.0)
+                 << ",\"pid\":" << pid
+                 << ",\"tid\":" << buffer->threadId;
+
+            switch (event.phase) {
+            case 'X':
+                file << ",\"dur\":" << (event.duration / 1000.0);
+                break;
+            case 'C':
+                file << ",\"args\":{\"value\":" << event.value << "}";
+                break;
+            case 'i':
+                file << ",\"s\":\"t\"";
+                break;
+            case 'f':
+                file << ",\"bp\":\"e\",\"id\":" << event.id;
+                break;
+            case 's':
+            case 't':
+                file << ",\"id\":" << event.id;
+                break;
+            }
+
+            file << "}";
+        }
+
+        events += count;
+        dropped += buffer->dropped.load(std::memory_order_relaxed);
+    }
+
+    file << "\n]}\n";
+
+    cout << "[INFO] Wrote "
+         << events
+         << " trace events to \""
+         << path
+         << "\"";
+    if (dropped > 0UL) cout << ", " << dropped << " dropped";
+    cout << endl;
+}
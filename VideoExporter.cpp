@@ -0,0 +1,282 @@
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+#include "GLDebug.h"
+#include "Tracer.h"
+#include "VideoExporter.h"
+
+// Namespace using directives
+
+using std::cerr;
+using std::cout;
+using std::endl;
+using std::lock_guard;
+using std::mutex;
+using std::runtime_error;
+using std::string;
+using std::thread;
+using std::uint8_t;
+using std::unique_lock;
+using std::vector;
+
+
+// Implementation of class VideoExporter
+
+// Static attribute initialization
+
+// Bound on a wait for a readback, so a lost context cannot hang the export
+const GLuint64 VideoExporter::k_FenceTimeout(1000000000);
+
+
+// Constructor / destructor
+
+VideoExporter::VideoExporter(const string &path, int width, int height, unsigned int fps) :
+    width(width),
+    height(height),
+    frameBytes(static_cast<size_t>(width) * height * 4),
+    raw(false),
+    piped(!path.empty() and (path[0] == '|')),
+    output(nullptr),
+    buffers(),
+    fences(),
+    next(0),
+    frames(0UL),
+    stalls(0UL),
+    queued(),
+    spare(),
+    writing(false),
+    running(true),
+    failed(false),
+    plane(static_cast<size_t>(width) * height * 3),
+    queueMutex(),
+    wake(),
+    drained(),
+    writer() {
+
+    const string suffix(".rgb");
+    raw = (!piped and (path.size() >= suffix.size()) and
+           (path.compare((path.size() - suffix.size()), suffix.size(), suffix) == 0));
+
+    output = (piped ? popen(path.c_str() + 1, "w") : std::fopen(path.c_str(), "wb"));
+    if (!output) throw runtime_error("Cannot open video export \"" + path + "\"");
+
+    if (!raw) {
+        std::fprintf(output, "YUV4MPEG2 W%d H%d F%u:1 Ip A1:1 C444\n", width, height, fps);
+    }
+
+    glGenBuffers(k_Buffers, buffers);
+    for (auto buffer : buffers) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer);
+        GLDebug::label(GL_BUFFER, buffer, "export readback");
+        glBufferData(GL_PIXEL_PACK_BUFFER, frameBytes, nullptr, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    writer = thread(&VideoExporter::writeLoop, this);
+
+    cout << "[INFO] Exporting "
+         << width
+         << "x"
+         << height
+         << " at "
+         << fps
+         << " fps to "
+         << (piped ? "command " : "")
+         << "\""
+         << (piped ? (path.c_str() + 1) : path.c_str())
+         << "\""
+         << (raw ? " as raw RGB" : " as Y4M")
+         << endl;
+}
+
+VideoExporter::~VideoExporter() {
+    finish();
+
+    {
+        lock_guard<mutex> lock(queueMutex);
+        running = false;
+    }
+
+    wake.notify_all();
+    writer.join();
+
+    auto status(piped ? pclose(output) : std::fclose(output));
+    if (status != 0) cerr << "[WARN] Video export did not complete cleanly" << endl;
+
+    glDeleteBuffers(k_Buffers, buffers);
+
+    cout << "[INFO] Exported "
+         << frames
+         << " frames, render loop waited on the writer "
+         << stalls
+         << " times"
+         << endl;
+}
+
+
+// Public methods
+
+void VideoExporter::capture() {
+    Tracer::Scope scope("export", "readback");
+
+    // The frame read into this buffer last time round is surely complete
+    if (fences[next]) collect(next);
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, buffers[next]);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    fences[next] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    next = ((next + 1) % k_Buffers);
+}
+
+void VideoExporter::finish() {
+    // Oldest first, keeping the frames in order
+    for (size_t i = 0; i < k_Buffers; i++) {
+        auto slot((next + i) % k_Buffers);
+        if (fences[slot]) collect(slot);
+    }
+
+    unique_lock<mutex> lock(queueMutex);
+    drained.wait(lock, [this] { return (queued.empty() and !writing); });
+
+    std::fflush(output);
+}
+
+
+// Accessors
+
+unsigned long VideoExporter::getFrames() const {
+    return frames;
+}
+
+unsigned long VideoExporter::getStalls() const {
+    return stalls;
+}
+
+
+// Private methods
+
+void VideoExporter::collect(size_t slot) {
+    glClientWaitSync(fences[slot], GL_SYNC_FLUSH_COMMANDS_BIT, k_FenceTimeout);
+    glDeleteSync(fences[slot]);
+    fences[slot] = nullptr;
+
+    vector<uint8_t> pixels;
+    {
+        unique_lock<mutex> lock(queueMutex);
+
+        // Frames are never dropped, so a slow writer holds the render loop back
+        if (queued.size() >= k_MaxQueued) {
+            stalls++;
+            drained.wait(lock, [this] { return (queued.size() < k_MaxQueued); });
+        }
+
+        if (failed) return;
+
+        if (!spare.empty()) {
+            pixels = std::move(spare.back());
+            spare.pop_back();
+        }
+    }
+
+    pixels.resize(frameBytes);
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, buffers[slot]);
+    auto mapped(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, frameBytes, GL_MAP_READ_BIT));
+    if (mapped) {
+        std::memcpy(pixels.data(), mapped, frameBytes);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    if (!mapped) {
+        cerr << "[WARN] Could not map video export frame " << frames << endl;
+        return;
+    }
+
+    {
+        lock_guard<mutex> lock(queueMutex);
+        queued.push_back(std::move(pixels));
+    }
+
+    wake.notify_one();
+    frames++;
+}
+
+void VideoExporter::writeLoop() {
+    Tracer::setThreadName("video writer");
+
+    unique_lock<mutex> lock(queueMutex);
+
+    while (true) {
+        wake.wait(lock, [this] { return (!queued.empty() or !running); });
+        if (queued.empty()) break;
+
+        auto pixels(std::move(queued.front()));
+        queued.pop_front();
+        writing = true;
+        lock.unlock();
+
+        auto written(write(pixels));
+
+        lock.lock();
+        if (!written and !failed) {
+            cerr << "[WARN] Video export write failed; no further frames will be written" << endl;
+            failed = true;
+        }
+
+        spare.push_back(std::move(pixels));
+        writing = false;
+        drained.notify_all();
+    }
+}
+
+bool VideoExporter::write(const vector<uint8_t> &pixels) {
+    Tracer::Scope scope("export", "write");
+
+    return (raw ? writeRgb(pixels) : writeY4m(pixels));
+}
+
+bool VideoExporter::writeY4m(const vector<uint8_t> &pixels) {
+    auto pixelCount(static_cast<size_t>(width) * height);
+    auto *y(plane.data());
+    auto *u(y + pixelCount);
+    auto *v(u + pixelCount);
+
+    // OpenGL rows run bottom up; video rows run top down
+    for (int row = 0; row < height; row++) {
+        const auto *source(pixels.data() + (static_cast<size_t>(height - 1 - row) * width * 4));
+
+        for (int column = 0; column < width; column++, source += 4) {
+            int r(source[0]);
+            int g(source[1]);
+            int b(source[2]);
+
+            // BT.601 studio swing, in 8.8 fixed point
+            *y++ = static_cast<uint8_t>((((66 * r) + (129 * g) + (25 * b) + 128) >> 8) + 16);
+            *u++ = static_cast<uint8_t>(((((-38) * r) - (74 * g) + (112 * b) + 128) >> 8) + 128);
+            *v++ = static_cast<uint8_t>((((112 * r) - (94 * g) - (18 * b) + 128) >> 8) + 128);
+        }
+    }
+
+    return ((std::fputs("FRAME\n", output) >= 0) and
+            (std::fwrite(plane.data(), 1, plane.size(), output) == plane.size()));
+}
+
+bool VideoExporter::writeRgb(const vector<uint8_t> &pixels) {
+    auto *destination(plane.data());
+
+    for (int row = 0; row < height; row++) {
+        const auto *source(pixels.data() + (static_cast<size_t>(height - 1 - row) * width * 4));
+
+        for (int column = 0; column < width; column++, source += 4) {
+            *destination++ = source[0];
+            *destination++ = source[1];
+            *destination++ = source[2];
+        }
+    }
+
+    return (std::fwrite(plane.data(), 1, plane.size(), output) == plane.size());
+}
@@ -0,0 +1,901 @@
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <zlib.h>
+
+#include "nlohmann/json.hpp"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+// Florb benchmark runner
+//
+// Runs the headless renderer through each named scenario of a scenario file,
+// one process per scenario so that each has its own peak resident set size,
+// and collects frame time percentiles, per-stage CPU and GPU times from the
+// frame profiler's final JSON summary. The results are written out as JSON,
+// and compared against a stored baseline: any metric which has grown beyond
+// its tolerance is reported as a regression, and fails the run.
+//
+// With a golden file, each check instead exports a short fixed-clock render
+// with one effect enabled, and compares its last frame against a golden PNG
+// by perceptual colour difference, and its GPU time against a budget
+// recorded on the local machine alongside the goldens, so that a speedup can
+// be shown to leave the look of every effect unchanged.
+//
+// With a soak file, it instead cycles the renderer through a generated
+// library of synthetic images on an accelerated fixed clock, simulating days
+// of image switches in minutes, and fails when the resident set size, live
+// OpenGL objects, texture bytes or frame times sampled along the way grow
+// steadily throughout.
+
+// Namespace using directives
+
+namespace chrono = std::chrono;
+namespace fs = std::filesystem;
+
+using std::cerr;
+using std::cout;
+using std::endl;
+using std::exception;
+using std::ifstream;
+using std::ofstream;
+using std::ostringstream;
+using std::runtime_error;
+using std::string;
+using std::uint8_t;
+using std::vector;
+
+using json = nlohmann::json_abi_v3_12_0::json;
+
+
+const int k_Version(1);
+
+
+// Read and parse a JSON file; throws runtime_error when it cannot be
+json readJson(const fs::path &path) {
+    ifstream file(path);
+    if (!file) throw runtime_error("Cannot open \"" + path.string() + "\"");
+
+    try {
+        return json::parse(file);
+    } catch (const exception &exc) {
+        throw runtime_error("Cannot parse \"" + path.string() + "\" : " + exc.what());
+    }
+}
+
+void writeJson(const fs::path &path, const json &document) {
+    ofstream file(path);
+    if (!file) throw runtime_error("Cannot write \"" + path.string() + "\"");
+
+    file << std::setw(4) << document << endl;
+}
+
+
+// Find a stage's summary in a frame profiler JSON dump
+const json* findStage(const json &profile, const string &stage, const string &source) {
+    for (const auto &entry : profile.at("stages")) {
+        if ((entry.at("stage") == stage) and (entry.at("source") == source)) return &entry;
+    }
+
+    return nullptr;
+}
+
+json percentiles(const json *entry) {
+    json times(json::object());
+    if (!entry) return times;
+
+    for (auto key : { "avg", "p50", "p90", "p99", "max" }) times[key] = entry->at(key);
+
+    return times;
+}
+
+
+// Build a run's configuration: the entry's overrides, over the suite's, over
+// its base file, with the profiler writing one summary when florb exits
+json buildConfig(const json &suite, const json &entry, const fs::path &statsPath) {
+    auto config(readJson(entry.value("config", suite.value("config", string("florb.json")))));
+    config.merge_patch(suite.value("overrides", json::object()));
+    config.merge_patch(entry.value("overrides", json::object()));
+
+    json profile;
+    profile["enabled"] = true;
+    profile["path"] = statsPath.string();
+    profile["interval"] = 1.0e6;
+    profile["counters"] = false;
+    config["debug"]["profile"] = profile;
+    config["debug"]["flight_recorder"]["enabled"] = false;
+    config["debug"]["gl_counters"] = suite.value("gl_counters", true);
+
+    return config;
+}
+
+
+// Run florb to completion, logging its output, and return its resource
+// usage; throws runtime_error when it fails
+struct rusage runFlorb(vector<string> arguments, const fs::path &logPath) {
+    vector<char*> argv;
+    for (auto &argument : arguments) argv.push_back(&argument[0]);
+    argv.push_back(nullptr);
+
+    auto pid(fork());
+    if (pid < 0) throw runtime_error(string("Cannot fork : ") + std::strerror(errno));
+
+    if (pid == 0) {
+        auto log(open(logPath.c_str(), (O_WRONLY | O_CREAT | O_TRUNC), 0644));
+        if (log >= 0) {
+            dup2(log, STDOUT_FILENO);
+            dup2(log, STDERR_FILENO);
+            close(log);
+        }
+
+        execv(argv[0], argv.data());
+        std::perror(argv[0]);
+        _exit(127);
+    }
+
+    int status(0);
+    struct rusage usage = {};
+    while (wait4(pid, &status, 0, &usage) < 0) {
+        if (errno != EINTR) throw runtime_error(string("Cannot wait for florb : ") + std::strerror(errno));
+    }
+
+    if (!WIFEXITED(status) or (WEXITSTATUS(status) != 0)) {
+        throw runtime_error("florb failed; see \"" + logPath.string() + "\"");
+    }
+
+    return usage;
+}
+
+
+// Run one scenario in its own florb process, returning its results
+json runScenario(const string &florb,
+                 const json &suite,
+                 const json &scenario,
+                 long frames,
+                 const fs::path &workPath) {
+
+    const string name(scenario.at("name"));
+    const string size(scenario.value("size", suite.value("size", string("1920x1080"))));
+    if (frames <= 0) frames = scenario.value("frames", suite.value("frames", 600L));
+
+    auto statsPath(workPath / (name + "-profile.json"));
+    auto configPath(workPath / (name + "-florb.json"));
+    writeJson(configPath, buildConfig(suite, scenario, statsPath));
+
+    cout << "[INFO] Running scenario \"" << name << "\", " << frames << " frames at " << size << endl;
+
+    auto start(chrono::steady_clock::now());
+
+    auto usage(runFlorb({ florb,
+                          "--config", configPath.string(),
+                          "--headless",
+                          "--size", size,
+                          "--frames", std::to_string(frames),
+                          "--clock", suite.value("clock", string("fixed:60")),
+                          "--seed", std::to_string(suite.value("seed", 1U)) },
+                        (workPath / (name + ".log"))));
+
+    auto seconds(chrono::duration<double>(chrono::steady_clock::now() - start).count());
+
+    auto stats(readJson(statsPath));
+    const string gpuStage(suite.value("gpu_stage", string("draw")));
+
+    // GL counters are per-frame values, deterministic under a fixed clock
+    json stages(json::object());
+    json gl(json::object());
+    for (const auto &entry : stats.at("stages")) {
+        if (entry.at("source") == "value") {
+            gl[entry.at("stage").get<string>()] = entry.at("avg");
+            continue;
+        }
+        if ((entry.at("unit") != "ms") or (entry.at("stage") == "frame")) continue;
+
+        const string source(entry.at("source"));
+        stages[entry.at("stage").get<string>()][source + "_ms"] = entry.at("avg");
+    }
+
+    json result;
+    result["size"] = size;
+    result["frames"] = frames;
+    result["seconds"] = seconds;
+    result["fps"] = (frames / seconds);
+    result["frame_ms"] = percentiles(findStage(stats, "frame", "cpu"));
+    result["gpu_ms"] = percentiles(findStage(stats, gpuStage, "gpu"));
+    result["stages"] = stages;
+    result["gl"] = gl;
+
+    // Linux reports the peak resident set size in kilobytes
+    result["peak_rss_kb"] = usage.ru_maxrss;
+
+    return result;
+}
+
+
+// An 8-bit RGB image, its rows running top down
+struct Image {
+    int width = 0;
+    int height = 0;
+    vector<uint8_t> pixels;
+};
+
+bool readPng(const fs::path &path, Image &image) {
+    int channels(0);
+    auto data(stbi_load(path.c_str(), &image.width, &image.height, &channels, 3));
+    if (!data) return false;
+
+    image.pixels.assign(data, (data + (static_cast<size_t>(image.width) * image.height * 3)));
+    stbi_image_free(data);
+
+    return true;
+}
+
+void writePngChunk(ofstream &file, const char *type, const vector<uint8_t> &data) {
+    uint8_t header[8] = {
+        static_cast<uint8_t>(data.size() >> 24), static_cast<uint8_t>(data.size() >> 16),
+        static_cast<uint8_t>(data.size() >> 8), static_cast<uint8_t>(data.size()),
+        static_cast<uint8_t>(type[0]), static_cast<uint8_t>(type[1]),
+        static_cast<uint8_t>(type[2]), static_cast<uint8_t>(type[3])
+    };
+
+    // The CRC covers the chunk type and data, not the length
+    auto crc(crc32(0L, (header + 4), 4));
+    crc = crc32(crc, data.data(), data.size());
+
+    uint8_t trailer[4] = {
+        static_cast<uint8_t>(crc >> 24), static_cast<uint8_t>(crc >> 16),
+        static_cast<uint8_t>(crc >> 8), static_cast<uint8_t>(crc)
+    };
+
+    file.write(reinterpret_cast<const char*>(header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(data.data()), data.size());
+    file.write(reinterpret_cast<const char*>(trailer), sizeof(trailer));
+}
+
+// Write 8-bit pixels of one to four channels, grey, grey and alpha, RGB or
+// RGBA, as an unfiltered PNG
+void writePng(const fs::path &path, int width, int height, int channels, const vector<uint8_t> &pixels) {
+    auto stride(static_cast<size_t>(width) * channels);
+
+    // Each row is preceded by its filter type, none
+    vector<uint8_t> rows;
+    rows.reserve((stride + 1) * height);
+    for (int row = 0; row < height; row++) {
+        rows.push_back(0);
+        rows.insert(rows.end(), (pixels.begin() + (row * stride)), (pixels.begin() + ((row + 1) * stride)));
+    }
+
+    uLongf compressedSize(compressBound(rows.size()));
+    vector<uint8_t> compressed(compressedSize);
+    if (compress2(compressed.data(), &compressedSize, rows.data(), rows.size(), Z_BEST_COMPRESSION) != Z_OK) {
+        throw runtime_error("Cannot compress \"" + path.string() + "\"");
+    }
+    compressed.resize(compressedSize);
+
+    // PNG colour types by channel count
+    const uint8_t colourTypes[] = { 0, 0, 4, 2, 6 };
+
+    vector<uint8_t> header = {
+        static_cast<uint8_t>(width >> 24), static_cast<uint8_t>(width >> 16),
+        static_cast<uint8_t>(width >> 8), static_cast<uint8_t>(width),
+        static_cast<uint8_t>(height >> 24), static_cast<uint8_t>(height >> 16),
+        static_cast<uint8_t>(height >> 8), static_cast<uint8_t>(height),
+        8, colourTypes[channels], 0, 0, 0
+    };
+
+    ofstream file(path, std::ios::binary);
+    if (!file) throw runtime_error("Cannot write \"" + path.string() + "\"");
+
+    const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+    file.write(reinterpret_cast<const char*>(signature), sizeof(signature));
+
+    writePngChunk(file, "IHDR", header);
+    writePngChunk(file, "IDAT", compressed);
+    writePngChunk(file, "IEND", vector<uint8_t>());
+}
+
+void writePng(const fs::path &path, const Image &image) {
+    writePng(path, image.width, image.height, 3, image.pixels);
+}
+
+
+// An sRGB pixel in CIE L*a*b*, under D65
+void toLab(const uint8_t *rgb, double *lab) {
+    double linear[3];
+    for (int i = 0; i < 3; i++) {
+        double c(rgb[i] / 255.0);
+        linear[i] = ((c <= 0.04045) ? (c / 12.92) : std::pow(((c + 0.055) / 1.055), 2.4));
+    }
+
+    double xyz[3] = {
+        (((0.4124 * linear[0]) + (0.3576 * linear[1]) + (0.1805 * linear[2])) / 0.95047),
+        ((0.2126 * linear[0]) + (0.7152 * linear[1]) + (0.0722 * linear[2])),
+        (((0.0193 * linear[0]) + (0.1192 * linear[1]) + (0.9505 * linear[2])) / 1.08883)
+    };
+
+    for (auto &v : xyz) v = ((v > 0.008856) ? std::cbrt(v) : ((7.787 * v) + (16.0 / 116.0)));
+
+    lab[0] = ((116.0 * xyz[1]) - 16.0);
+    lab[1] = (500.0 * (xyz[0] - xyz[1]));
+    lab[2] = (200.0 * (xyz[1] - xyz[2]));
+}
+
+// Perceptual difference between two images of the same size: the mean CIE76
+// colour difference, and the fraction of pixels differing by more than the
+// threshold (2.3 being about the smallest difference an eye can notice)
+void compareImages(const Image &a, const Image &b, double threshold, double &mean, double &noticeable) {
+    auto count(static_cast<size_t>(a.width) * a.height);
+
+    double total(0.0);
+    size_t over(0UL);
+    for (size_t i = 0; i < count; i++) {
+        double labA[3];
+        double labB[3];
+        toLab(&a.pixels[i * 3], labA);
+        toLab(&b.pixels[i * 3], labB);
+
+        auto difference(std::sqrt(((labA[0] - labB[0]) * (labA[0] - labB[0])) +
+                                  ((labA[1] - labB[1]) * (labA[1] - labB[1])) +
+                                  ((labA[2] - labB[2]) * (labA[2] - labB[2]))));
+        total += difference;
+        if (difference > threshold) over++;
+    }
+
+    mean = (total / count);
+    noticeable = (static_cast<double>(over) / count);
+}
+
+
+// Render one golden check's last frame and compare it against its golden
+// image and its GPU budget, or record either; returns whether it passed
+bool runGolden(const string &florb,
+               const json &suite,
+               const json &check,
+               bool updateGolden,
+               bool updateBudgets,
+               json &budgets,
+               const fs::path &workPath) {
+
+    const string name(check.at("name"));
+    const string size(check.value("size", suite.value("size", string("320x180"))));
+    auto frames(check.value("frames", suite.value("frames", 30L)));
+    auto fps(suite.value("fps", 60U));
+
+    Image actual;
+    char separator('\0');
+    if ((std::sscanf(size.c_str(), "%d%c%d", &actual.width, &separator, &actual.height) != 3) or
+        (separator != 'x')) throw runtime_error("Invalid size \"" + size + "\" for check \"" + name + "\"");
+
+    auto statsPath(workPath / (name + "-profile.json"));
+    auto configPath(workPath / (name + "-florb.json"));
+    writeJson(configPath, buildConfig(suite, check, statsPath));
+
+    // An export steps a fixed clock once per frame, so each frame is the same on every run
+    auto videoPath(workPath / (name + ".rgb"));
+    runFlorb({ florb,
+               "--config", configPath.string(),
+               "--export", videoPath.string(),
+               "--size", size,
+               "--frames", std::to_string(frames),
+               "--fps", std::to_string(fps),
+               "--seed", std::to_string(suite.value("seed", 1U)) },
+             (workPath / (name + ".log")));
+
+    auto frameBytes(static_cast<size_t>(actual.width) * actual.height * 3);
+    actual.pixels.resize(frameBytes);
+
+    std::ifstream video(videoPath, std::ios::binary | std::ios::ate);
+    if (!video or (static_cast<size_t>(video.tellg()) < frameBytes)) {
+        throw runtime_error("No frame rendered for check \"" + name + "\"");
+    }
+
+    video.seekg(-static_cast<std::streamoff>(frameBytes), std::ios::end);
+    video.read(reinterpret_cast<char*>(actual.pixels.data()), frameBytes);
+
+    auto stats(readJson(statsPath));
+    auto gpu(findStage(stats, suite.value("gpu_stage", string("draw")), "gpu"));
+    auto gpuTime(gpu ? gpu->at("avg").get<double>() : -1.0);
+
+    fs::path goldenPath(fs::path(suite.value("directory", string("bench/golden"))) / (name + ".png"));
+
+    ostringstream line;
+    line << std::fixed << std::setprecision(3) << std::left << std::setw(20) << name;
+
+    if (updateGolden) {
+        fs::create_directories(goldenPath.parent_path());
+        writePng(goldenPath, actual);
+
+        cout << "[INFO] " << line.str() << "recorded \"" << goldenPath.string() << "\"" << endl;
+
+        return true;
+    }
+
+    // Budgets leave headroom for run to run variation, and are only
+    // meaningful on the machine which recorded them
+    if (updateBudgets and (gpuTime >= 0.0)) {
+        budgets[name] = (gpuTime * (1.0 + suite.value("budget_headroom", 0.25)));
+    }
+
+    vector<string> failures;
+
+    Image golden;
+    if (!readPng(goldenPath, golden)) {
+        failures.push_back("no golden image at \"" + goldenPath.string() + "\"");
+    } else if ((golden.width != actual.width) or (golden.height != actual.height)) {
+        failures.push_back("golden image is " + std::to_string(golden.width) + "x" + std::to_string(golden.height));
+    } else {
+        const auto &tolerance(suite.value("tolerance", json::object()));
+
+        double mean(0.0);
+        double noticeable(0.0);
+        compareImages(golden, actual, tolerance.value("delta_e", 2.3), mean, noticeable);
+
+        line << "mean dE " << mean << ", " << (100.0 * noticeable) << "% noticeable";
+
+        if (mean > tolerance.value("mean_delta_e", 0.5)) failures.push_back("mean colour difference too large");
+        if (noticeable > tolerance.value("noticeable", 0.001)) failures.push_back("too many pixels differ noticeably");
+    }
+
+    if (gpuTime >= 0.0) line << ", GPU " << gpuTime << " ms";
+
+    if (budgets.contains(name)) {
+        double budget(budgets[name]);
+        line << " (budget " << budget << " ms)";
+
+        if (gpuTime > budget) failures.push_back("over its GPU budget");
+    }
+
+    if (failures.empty()) {
+        cout << "[ OK ] " << line.str() << endl;
+        return true;
+    }
+
+    // The render is kept alongside the log, for comparison by eye
+    writePng((workPath / (name + ".png")), actual);
+
+    cerr << "[FAIL] " << line.str() << endl;
+    for (const auto &failure : failures) cerr << "       " << name << " : " << failure << endl;
+
+    return false;
+}
+
+
+// Generate a synthetic image library of the given number of PNGs, of random
+// sizes and of each channel count in turn, every one a smooth gradient with
+// a little noise so that it compresses about as a photograph would; the same
+// seed always generates the same library, so an existing one is reused
+void generateLibrary(const fs::path &directory, const json &spec) {
+    auto count(spec.value("count", 2000L));
+    auto minSize(spec.value("min_size", 16));
+    auto maxSize(spec.value("max_size", 256));
+    std::mt19937 random(spec.value("seed", 1U));
+
+    if (fs::is_directory(directory)) {
+        long existing(0L);
+        for (const auto &entry : fs::directory_iterator(directory)) {
+            if (entry.is_regular_file()) existing++;
+        }
+
+        if (existing == count) {
+            cout << "[INFO] Using the library of " << count << " images in \"" << directory.string() << "\"" << endl;
+            return;
+        }
+
+        if (existing > 0) {
+            throw runtime_error("\"" + directory.string() + "\" already holds " + std::to_string(existing) + " files");
+        }
+    }
+
+    cout << "[INFO] Generating a library of " << count << " images in \"" << directory.string() << "\"" << endl;
+    fs::create_directories(directory);
+
+    std::uniform_int_distribution<int> sizes(minSize, maxSize);
+    std::uniform_int_distribution<int> levels(0, 255);
+
+    for (long image = 0; image < count; image++) {
+        auto width(sizes(random));
+        auto height(sizes(random));
+        auto channels(static_cast<int>(1 + (image % 4)));
+
+        int from[4];
+        int to[4];
+        for (int channel = 0; channel < 4; channel++) {
+            from[channel] = levels(random);
+            to[channel] = levels(random);
+        }
+
+        vector<uint8_t> pixels(static_cast<size_t>(width) * height * channels);
+        auto pixel(pixels.begin());
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                // Alternate channels run across and down the image
+                for (int channel = 0; channel < channels; channel++) {
+                    auto t((channel % 2) ? (static_cast<double>(y) / height) : (static_cast<double>(x) / width));
+                    auto level(from[channel] + ((to[channel] - from[channel]) * t) + (random() % 9) - 4);
+                    *pixel++ = static_cast<uint8_t>(std::clamp(level, 0.0, 255.0));
+                }
+            }
+        }
+
+        char name[32];
+        std::snprintf(name, sizeof(name), "library-%05ld.png", image);
+        writePng((directory / name), width, height, channels, pixels);
+    }
+}
+
+
+// Read a CSV file with a header row into its named columns
+std::map<string, vector<double>> readColumns(const fs::path &path) {
+    ifstream file(path);
+    if (!file) throw runtime_error("Cannot read \"" + path.string() + "\"");
+
+    string line;
+    vector<string> names;
+    if (std::getline(file, line)) {
+        std::istringstream header(line);
+        string name;
+        while (std::getline(header, name, ',')) names.push_back(name);
+    }
+
+    std::map<string, vector<double>> columns;
+    while (std::getline(file, line)) {
+        std::istringstream row(line);
+        string value;
+        for (size_t column = 0; (column < names.size()) and std::getline(row, value, ','); column++) {
+            columns[names[column]].push_back(std::atof(value.c_str()));
+        }
+    }
+
+    return columns;
+}
+
+
+// Soak the renderer: cycle through a synthetic library on a fixed clock
+// stepping a good fraction of an image switch each frame, so that days of
+// switches pass in minutes, sampling the resources held every simulated
+// interval, and fail on any measure which grows steadily beyond its
+// allowance from the first sample after warming up to the last; returns
+// whether it passed
+bool runSoak(const string &florb, const json &suite, const fs::path &workPath) {
+    const auto &library(suite.value("library", json::object()));
+    fs::path libraryPath(library.value("directory", string("florb-soak-library")));
+    generateLibrary(libraryPath, library);
+
+    const string size(suite.value("size", string("320x180")));
+    auto imageSwitch(suite.value("image_switch", 60.0));
+    auto step(imageSwitch / suite.value("frames_per_switch", 2));
+    auto hours(suite.value("simulated_hours", 72.0));
+
+    // Images upload one per frame before the soak proper begins
+    auto frames(library.value("count", 2000L) + std::lround((hours * 3600.0) / step));
+
+    auto samplesPath(workPath / "soak-resources.csv");
+    auto configPath(workPath / "soak-florb.json");
+
+    auto config(buildConfig(suite, json::object(), (workPath / "soak-profile.json")));
+    config["image_paths"] = json::array({ fs::absolute(libraryPath).string() });
+    config["video"]["image_switch"] = imageSwitch;
+
+    json resources;
+    resources["enabled"] = true;
+    resources["path"] = samplesPath.string();
+    resources["interval"] = suite.value("sample_interval", 3600.0);
+    config["debug"]["resources"] = resources;
+
+    writeJson(configPath, config);
+
+    ostringstream clock;
+    clock << "fixed:" << std::setprecision(9) << (1.0 / step);
+
+    cout << "[INFO] Soaking for " << hours << " simulated hours, " << frames << " frames at " << size << endl;
+
+    auto start(chrono::steady_clock::now());
+
+    runFlorb({ florb,
+               "--config", configPath.string(),
+               "--headless",
+               "--size", size,
+               "--frames", std::to_string(frames),
+               "--clock", clock.str(),
+               "--seed", std::to_string(suite.value("seed", 1U)) },
+             (workPath / "soak.log"));
+
+    auto seconds(chrono::duration<double>(chrono::steady_clock::now() - start).count());
+    cout << "[INFO] Soaked in " << std::fixed << std::setprecision(1) << seconds << " s" << endl;
+
+    // Early samples see allocators and caches settling
+    auto columns(readColumns(samplesPath));
+    auto warmup(suite.value("warmup_samples", 2UL));
+    auto samples(columns["frame"].size());
+    if (samples < (warmup + 3)) {
+        throw runtime_error("Only " + std::to_string(samples) + " resource samples; soak for longer");
+    }
+
+    int failures(0);
+    for (const auto &[metric, allowance] : suite.at("growth").items()) {
+        if (!columns.count(metric)) throw runtime_error("No resource samples of \"" + metric + "\"");
+        const auto &values(columns[metric]);
+
+        bool monotonic(true);
+        for (auto sample = (warmup + 1); sample < samples; sample++) {
+            if (values[sample] < values[sample - 1]) monotonic = false;
+        }
+
+        auto first(values[warmup]);
+        auto last(values.back());
+        auto limit(first + (first * allowance.value("relative", 0.0)) + allowance.value("absolute", 0.0));
+        bool grew(monotonic and (last > first) and (last > limit));
+        if (grew) failures++;
+
+        ostringstream line;
+        line << std::fixed << std::setprecision(3)
+             << (grew ? "[FAIL] " : "[ OK ] ")
+             << std::left << std::setw(16) << metric
+             << std::right << std::setw(14) << first
+             << " -> " << std::setw(14) << last
+             << "  (limit " << limit << ")"
+             << (grew ? "  MONOTONIC GROWTH" : "");
+
+        (grew ? cerr : cout) << line.str() << endl;
+    }
+
+    return (failures == 0);
+}
+
+
+// Compare results against a baseline, returning the number of regressions
+int compare(const json &results, const json &baseline, const json &tolerances) {
+    int regressions(0);
+
+    for (const auto &[name, result] : results.at("scenarios").items()) {
+        if (!baseline.at("scenarios").contains(name)) {
+            cout << "[INFO] No baseline for scenario \"" << name << "\"" << endl;
+            continue;
+        }
+
+        const auto &base(baseline["scenarios"][name]);
+        if ((base.at("size") != result.at("size")) or (base.at("frames") != result.at("frames"))) {
+            cerr << "[WARN] Baseline for scenario \"" << name << "\" was run differently, skipping" << endl;
+            continue;
+        }
+
+        for (const auto &[metric, tolerance] : tolerances.items()) {
+            json::json_pointer pointer(metric);
+            if (!base.contains(pointer) or !result.contains(pointer)) continue;
+
+            double before(base[pointer]);
+            double after(result[pointer]);
+
+            // Lower is better for every compared metric
+            double limit((before * (1.0 + tolerance.value("relative", 0.0))) + tolerance.value("absolute", 0.0));
+            bool regressed(after > limit);
+            if (regressed) regressions++;
+
+            ostringstream line;
+            line << std::fixed << std::setprecision(3)
+                 << (regressed ? "[FAIL] " : "[ OK ] ")
+                 << std::left << std::setw(16) << name
+                 << std::setw(20) << metric
+                 << std::right << std::setw(14) << before
+                 << " -> " << std::setw(14) << after
+                 << "  (limit " << limit << ")"
+                 << (regressed ? "  REGRESSION" : "");
+
+            (regressed ? cerr : cout) << line.str() << endl;
+        }
+    }
+
+    return regressions;
+}
+
+
+int main(int numArgs, const char *args[]) {
+
+    string florb("./florb");
+    fs::path scenariosPath("bench/scenarios.json");
+    fs::path baselinePath("bench/baseline.json");
+    fs::path outputPath("florb-bench.json");
+    bool updateBaseline(false);
+    fs::path goldenPath;
+    bool updateGolden(false);
+    bool updateBudgets(false);
+    fs::path soakPath;
+    fs::path libraryPath;
+    long images(0);
+    long frames(0);
+    vector<string> only;
+
+    for (int arg = 1; arg < numArgs; arg++) {
+        string option(args[arg]);
+        bool valid(true);
+
+        if ((option == "--florb") and ((arg + 1) < numArgs)) {
+            florb = args[++arg];
+        } else if ((option == "--scenarios") and ((arg + 1) < numArgs)) {
+            scenariosPath = args[++arg];
+        } else if ((option == "--baseline") and ((arg + 1) < numArgs)) {
+            baselinePath = args[++arg];
+        } else if ((option == "--output") and ((arg + 1) < numArgs)) {
+            outputPath = args[++arg];
+        } else if (option == "--update-baseline") {
+            updateBaseline = true;
+        } else if ((option == "--golden") and ((arg + 1) < numArgs)) {
+            goldenPath = args[++arg];
+        } else if (option == "--update-golden") {
+            updateGolden = true;
+        } else if (option == "--update-budgets") {
+            updateBudgets = true;
+        } else if ((option == "--soak") and ((arg + 1) < numArgs)) {
+            soakPath = args[++arg];
+        } else if ((option == "--generate-library") and ((arg + 1) < numArgs)) {
+            libraryPath = args[++arg];
+        } else if ((option == "--images") and ((arg + 1) < numArgs)) {
+            images = std::atol(args[++arg]);
+            valid = (images > 0);
+        } else if ((option == "--frames") and ((arg + 1) < numArgs)) {
+            frames = std::atol(args[++arg]);
+            valid = (frames > 0);
+        } else if (!option.empty() and (option[0] != '-')) {
+            only.push_back(option);
+        } else {
+            valid = false;
+        }
+
+        if (!valid) {
+            cerr << "Usage : "
+                 << args[0]
+                 << " [--florb <florb>] [--scenarios <scenarios.json>] [--baseline <baseline.json>]"
+                 << " [--output <results.json>] [--update-baseline] [--frames <count>]"
+                 << " [--golden <golden.json> [--update-golden | --update-budgets]] [<scenario or check> ...]"
+                 << " [--soak <soak.json>] [--generate-library <directory> [--images <count>]]"
+                 << endl;
+            return -EINVAL;
+        }
+    }
+
+    if ((updateGolden or updateBudgets) and goldenPath.empty()) {
+        cerr << "--update-golden and --update-budgets need a --golden file" << endl;
+        return -EINVAL;
+    }
+
+    if (updateGolden and updateBudgets) {
+        cerr << "Record the goldens and the GPU budgets separately" << endl;
+        return -EINVAL;
+    }
+
+    try {
+        if (!libraryPath.empty()) {
+            json spec;
+            if (images > 0) spec["count"] = images;
+            generateLibrary(libraryPath, spec);
+            return 0;
+        }
+
+        string workTemplate((fs::temp_directory_path() / "florb-bench.XXXXXX").string());
+        if (!mkdtemp(&workTemplate[0])) throw runtime_error("Cannot create a working directory");
+        fs::path workPath(workTemplate);
+
+        if (!soakPath.empty()) {
+            auto suite(readJson(soakPath));
+            if (images > 0) suite["library"]["count"] = images;
+
+            if (!runSoak(florb, suite, workPath)) {
+                cerr << "[FAIL] Resources grew during the soak; samples kept in \"" << workPath.string() << "\"" << endl;
+                return 1;
+            }
+
+            fs::remove_all(workPath);
+            cout << "[INFO] No resource growth during the soak" << endl;
+
+            return 0;
+        }
+
+        if (!goldenPath.empty()) {
+            auto suite(readJson(goldenPath));
+
+            auto budgetsPath(fs::path(suite.value("directory", string("bench/golden"))) / "budgets.json");
+            json budgets(fs::exists(budgetsPath) ? readJson(budgetsPath) : json::object());
+
+            int failures(0);
+            for (const auto &check : suite.at("checks")) {
+                const string name(check.at("name"));
+                if (!only.empty() and (std::find(only.begin(), only.end(), name) == only.end())) continue;
+
+                if (!runGolden(florb, suite, check, updateGolden, updateBudgets, budgets, workPath)) failures++;
+            }
+
+            if (updateBudgets) {
+                writeJson(budgetsPath, budgets);
+                cout << "[INFO] GPU budgets updated in \"" << budgetsPath.string() << "\"" << endl;
+            }
+
+            if (failures > 0) {
+                cerr << "[FAIL] " << failures << " golden checks failed; renders kept in \"" << workPath.string() << "\"" << endl;
+                return 1;
+            }
+
+            fs::remove_all(workPath);
+            if (!updateGolden) cout << "[INFO] All golden checks passed" << endl;
+
+            return 0;
+        }
+
+        auto suite(readJson(scenariosPath));
+
+        json results;
+        results["florb_bench"] = k_Version;
+        results["scenarios"] = json::object();
+
+        for (const auto &scenario : suite.at("scenarios")) {
+            const string name(scenario.at("name"));
+            if (!only.empty() and (std::find(only.begin(), only.end(), name) == only.end())) continue;
+
+            results["scenarios"][name] = runScenario(florb, suite, scenario, frames, workPath);
+        }
+
+        writeJson(outputPath, results);
+        cout << "[INFO] Results written to \"" << outputPath.string() << "\"" << endl;
+
+        // Logs and profiles are only kept while there is something to look
+        // into, so are removed only once the comparison has passed
+        if (updateBaseline) {
+            // Scenarios not run this time keep their previous baselines
+            json baseline(results);
+            if (fs::exists(baselinePath)) {
+                baseline = readJson(baselinePath);
+                for (const auto &[name, result] : results["scenarios"].items()) baseline["scenarios"][name] = result;
+            }
+
+            writeJson(baselinePath, baseline);
+            cout << "[INFO] Baseline updated in \"" << baselinePath.string() << "\"" << endl;
+
+            fs::remove_all(workPath);
+            return 0;
+        }
+
+        if (!fs::exists(baselinePath)) {
+            cerr << "[WARN] No baseline at \""
+                 << baselinePath.string()
+                 << "\" to compare against; record one with --update-baseline"
+                 << endl;
+
+            fs::remove_all(workPath);
+            return 0;
+        }
+
+        auto regressions(compare(results, readJson(baselinePath), suite.value("tolerances", json::object())));
+        if (regressions > 0) {
+            cerr << "[FAIL] " << regressions << " performance regressions against \"" << baselinePath.string()
+                 << "\"; logs and profiles kept in \"" << workPath.string() << "\"" << endl;
+            return 1;
+        }
+
+        fs::remove_all(workPath);
+        cout << "[INFO] No performance regressions" << endl;
+
+    } catch (const exception &e) {
+        cerr << "[FAIL] " << e.what() << endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,391 @@
+#include <X11/Xlib.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Camera.h"
+#include "FlorbConfigs.h"
+#include "MotionExpression.h"
+#include "SeqLock.h"
+#include "Spotlight.h"
+
+// Florb self-checks
+//
+// Checks of behaviour which neither the benchmarks nor the golden images
+// would catch: that parsing a configuration again replaces its cameras and
+// spotlights rather than adding to them; that motion expressions evaluate as
+// written on the CPU, in
+// both the scalar and batch paths, and that those which cannot be compiled,
+// including constants folding to infinities or NaNs which would break the
+// shader prelude, are rejected with a parse error; and that no reader of a
+// SeqLock, directly or through the camera and spotlight getters, ever sees
+// a torn value while a writer thread hammers it. Each check prints one line,
+// and the exit status is non-zero when any failed.
+
+// Namespace using directives
+
+using std::cerr;
+using std::cout;
+using std::endl;
+using std::atomic;
+using std::exception;
+using std::function;
+using std::ostringstream;
+using std::string;
+using std::thread;
+using std::vector;
+
+
+// The globals which Florb and its configs expect of the application
+Display *display = nullptr;
+Window window = 0;
+
+int screenWidth = 640;
+int screenHeight = 360;
+
+
+// Report one check's outcome, returning whether it passed
+static bool report(const string &name, bool passed, const string &detail = string()) {
+    (passed ? cout : cerr) << (passed ? "[ OK ] " : "[FAIL] ")
+                           << name
+                           << ((passed or detail.empty()) ? "" : (" : " + detail))
+                           << endl;
+    return passed;
+}
+
+
+// Configuration checks
+
+static const char *const k_Document = R"({
+    "cameras" : [
+        { "name" : "front", "view" : [ 0.0, 0.0 ], "zoom" : 1.0 },
+        { "name" : "above", "view" : [ 0.0, 1.0 ], "zoom" : 2.0 }
+    ],
+    "light" : {
+        "spotlights" : [
+            { "name" : "key",  "direction" : [ 0.5, 0.5 ],  "intensity" : 1.0, "color" : [ 1.0, 1.0, 1.0 ] },
+            { "name" : "fill", "direction" : [ -1.0, 0.0 ], "intensity" : 0.5, "color" : [ 1.0, 1.0, 1.0 ] }
+        ]
+    }
+})";
+
+static int checkConfigs() {
+    int failures(0);
+
+    auto configs(std::make_shared<FlorbConfigs>());
+
+    // Each parse, as on a reload or a replayed configuration, gives the same scene
+    for (int parse = 1; parse <= 3; parse++) {
+        configs->parse(k_Document);
+
+        auto snapshot(configs->getSnapshot());
+
+        ostringstream name;
+        name << "parse " << parse << " keeps 2 cameras and 2 spotlights";
+        ostringstream detail;
+        detail << snapshot->cameras.size() << " cameras and " << snapshot->spotlights.size() << " spotlights";
+        if (!report(name.str(), ((snapshot->cameras.size() == 2) and (snapshot->spotlights.size() == 2)),
+                    detail.str())) failures++;
+    }
+
+    // A document without them leaves none
+    configs->parse("{}");
+    auto snapshot(configs->getSnapshot());
+    if (!report("parse without cameras or spotlights clears them",
+                (snapshot->cameras.empty() and snapshot->spotlights.empty()))) failures++;
+
+    return failures;
+}
+
+
+// Motion expression checks
+
+struct ExpressionCase {
+    const char *source;
+    float time;
+    float expected;
+};
+
+static const ExpressionCase k_Values[] = {
+    { "1 + 2 * 3",              0.0f,  7.0f    },
+    { "(1 + 2) * 3",            0.0f,  9.0f    },
+    { "2 ^ 3 ^ 2",              0.0f,  512.0f  },
+    { "-t ^ 2",                 3.0f, -9.0f    },
+    { "t / 4",                  2.0f,  0.5f    },
+    { "sin(pi / 2)",            0.0f,  1.0f    },
+    { "clamp(t, 0, 1)",         2.0f,  1.0f    },
+    { "mod(t, 2)",              5.0f,  1.0f    },
+    { "mix(0, 10, 0.25)",       0.0f,  2.5f    },
+    { "step(1, t)",             0.5f,  0.0f    },
+    { "smoothstep(0, 2, t)",    1.0f,  0.5f    },
+    { "impulse(t, 2.0, 0.0)",   3.0f,  1.0f    },
+    { "max(min(t, 4), 3)",      5.0f,  4.0f    }
+};
+
+// Each is rejected when compiled; the non-finite constants would otherwise
+// be emitted as GLSL literals such as "inf.0"
+static const char *const k_Rejected[] = {
+    "1 / 0",
+    "0 / 0",
+    "-1 / 0",
+    "log(-1)",
+    "log(0)",
+    "sqrt(-1)",
+    "exp(1000)",
+    "10 ^ 100",
+    "1e40",
+    "(1",
+    "1 +",
+    "sin(t, 1)",
+    "clamp(t, 0)",
+    "foo(t)",
+    "t t"
+};
+
+// Compiled regardless, since t is only known when evaluated
+static const char *const k_Accepted[] = {
+    "1 / t",
+    "log(t - 10)",
+    "sqrt(-t)"
+};
+
+static int checkExpressions() {
+    int failures(0);
+
+    for (const auto &value : k_Values) {
+        string name(string("expression \"") + value.source + "\"");
+
+        try {
+            MotionExpression expression(value.source);
+            auto result(expression.evaluate(value.time));
+
+            ostringstream detail;
+            detail << "t = " << value.time << " gave " << result << ", expected " << value.expected;
+            if (!report(name, (std::fabs(result - value.expected) <= 1.0e-5f), detail.str())) failures++;
+        } catch (const exception &e) {
+            report(name, false, e.what());
+            failures++;
+        }
+    }
+
+    for (auto source : k_Rejected) {
+        string name(string("expression \"") + source + "\" is rejected");
+
+        try {
+            MotionExpression expression(source);
+            report(name, false, ("compiled to \"" + expression.toGLSL("t") + "\""));
+            failures++;
+        } catch (const std::runtime_error &) {
+            report(name, true);
+        }
+    }
+
+    for (auto source : k_Accepted) {
+        string name(string("expression \"") + source + "\" compiles");
+
+        try {
+            MotionExpression expression(source);
+            report(name, true);
+        } catch (const exception &e) {
+            report(name, false, e.what());
+            failures++;
+        }
+    }
+
+    // The batch path, blocked into lanes, matches the scalar path at every time
+    {
+        const string source("0.1 * impulse(t, 2.0, 4.0) + 0.02 * noise(3.0 * t) - sin(t) ^ 2");
+        MotionExpression expression(source);
+
+        vector<float> times(1003);
+        for (size_t i = 0; i < times.size(); i++) times[i] = (0.013f * i);
+
+        vector<float> results(times.size());
+        expression.evaluate(times.data(), results.data(), times.size());
+
+        size_t mismatches(0);
+        for (size_t i = 0; i < times.size(); i++) {
+            if (std::fabs(results[i] - expression.evaluate(times[i])) > 1.0e-6f) mismatches++;
+        }
+
+        ostringstream detail;
+        detail << mismatches << " of " << times.size() << " times differ";
+        if (!report("batch evaluation matches scalar", (mismatches == 0), detail.str())) failures++;
+    }
+
+    return failures;
+}
+
+
+// SeqLock stress checks
+
+// A value wide enough that a torn copy is likely to mix two writes
+struct Wide {
+    float words[16];
+};
+
+// Run one writer against several readers for a while; each reader's check
+// returns false for a torn copy. Passes when no reader saw one
+static bool stress(const string &name,
+                   double seconds,
+                   const function<void(unsigned int)> &write,
+                   const function<bool()> &read) {
+
+    auto readers(std::max(2U, std::min(8U, (thread::hardware_concurrency() - 1U))));
+
+    atomic<bool> stop(false);
+    atomic<unsigned long> reads(0UL);
+    atomic<unsigned long> torn(0UL);
+    unsigned long writes(0UL);
+
+    vector<thread> threads;
+    for (unsigned int reader = 0; reader < readers; reader++) {
+        threads.emplace_back([&]() {
+            unsigned long count(0UL);
+            unsigned long bad(0UL);
+            while (!stop.load(std::memory_order_relaxed)) {
+                if (!read()) bad++;
+                count++;
+            }
+            reads += count;
+            torn += bad;
+        });
+    }
+
+    threads.emplace_back([&]() {
+        auto end(std::chrono::steady_clock::now() + std::chrono::duration<double>(seconds));
+        for (unsigned int value = 1; std::chrono::steady_clock::now() < end; value++) {
+            write(value);
+            writes++;
+        }
+        stop = true;
+    });
+
+    for (auto &t : threads) t.join();
+
+    ostringstream detail;
+    detail << torn << " torn of " << reads << " reads by " << readers
+           << " readers, during " << writes << " writes";
+
+    bool passed((torn == 0UL) and (reads > 0UL) and (writes > 0UL));
+    report(name, passed, detail.str());
+    if (passed) cout << "       " << detail.str() << endl;
+
+    return passed;
+}
+
+static int checkSeqLocks(double seconds) {
+    int failures(0);
+
+    // Every word of a consistent copy holds the same value
+    auto consistent = [](const Wide &wide) {
+        return std::all_of(std::begin(wide.words), std::end(wide.words),
+                           [&wide](float word) { return (word == wide.words[0]); });
+    };
+
+    {
+        SeqLock<Wide> lock;
+        if (!stress("SeqLock::write", seconds,
+                    [&lock](unsigned int value) {
+                        Wide wide;
+                        std::fill(std::begin(wide.words), std::end(wide.words), static_cast<float>(value));
+                        lock.write(wide);
+                    },
+                    [&]() { return consistent(lock.load()); })) failures++;
+    }
+
+    {
+        SeqLock<Wide> lock;
+        if (!stress("SeqLock::modify", seconds,
+                    [&lock](unsigned int) {
+                        lock.modify([](Wide &wide) {
+                            for (auto &word : wide.words) word += 1.0f;
+                        });
+                    },
+                    [&]() { return consistent(lock.load()); })) failures++;
+    }
+
+    // Each setter writes its components together, in a fixed ratio
+    {
+        Spotlight spotlight("stress", { 0.0f, 0.0f, 0.0f }, 1.0f, { 0.0f, 0.0f, 0.0f });
+        if (!stress("Spotlight getters", seconds,
+                    [&spotlight](unsigned int value) {
+                        float v(static_cast<float>(value & 0xFFFFFU));
+                        spotlight.setColor(v, (v * 2.0f), (v * 3.0f));
+                        spotlight.setDirection(v, -v, (v * 0.5f));
+                        spotlight.setIntensity(v);
+                    },
+                    [&spotlight]() {
+                        auto state(spotlight.getState());
+                        const auto &c(state.color);
+                        const auto &d(state.direction);
+                        auto color(spotlight.getColor());
+                        return ((c.y == (c.x * 2.0f)) and (c.z == (c.x * 3.0f)) and
+                                (d.y == -d.x) and (d.z == (d.x * 0.5f)) and
+                                (color.y == (color.x * 2.0f)) and (color.z == (color.x * 3.0f)));
+                    })) failures++;
+    }
+
+    {
+        Camera camera("stress", { 0.0f, 0.0f, 0.0f }, 1.0f);
+        if (!stress("Camera getters", seconds,
+                    [&camera](unsigned int value) {
+                        float v(static_cast<float>(value & 0xFFFFFU));
+                        camera.setView(v, (v * 2.0f), (v * 3.0f));
+                        camera.setZoom(v);
+                    },
+                    [&camera]() {
+                        auto view(camera.getState().view);
+                        return ((view.y == (view.x * 2.0f)) and (view.z == (view.x * 3.0f)));
+                    })) failures++;
+    }
+
+    return failures;
+}
+
+
+int main(int numArgs, const char *args[]) {
+
+    double seconds(1.0);
+
+    for (int arg = 1; arg < numArgs; arg++) {
+        string option(args[arg]);
+        bool valid(true);
+
+        if ((option == "--seconds") and ((arg + 1) < numArgs)) {
+            seconds = std::atof(args[++arg]);
+            valid = (seconds > 0.0);
+        } else {
+            valid = false;
+        }
+
+        if (!valid) {
+            cerr << "Usage : " << args[0] << " [--seconds <per stress check>]" << endl;
+            return -EINVAL;
+        }
+    }
+
+    auto failures(checkConfigs());
+    failures += checkExpressions();
+    failures += checkSeqLocks(seconds);
+
+    if (failures > 0) {
+        cerr << "[FAIL] " << failures << " checks failed" << endl;
+    } else {
+        cout << "[INFO] All checks passed" << endl;
+    }
+
+    return ((failures > 0) ? 1 : 0);
+}
@@ -0,0 +1,499 @@
+#include <GL/glew.h>
+#include <X11/Xlib.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Florb.h"
+#include "FlorbConfigs.h"
+#include "Flower.h"
+#include "HeadlessContext.h"
+#include "LinearMotion.h"
+#include "SinusoidalMotion.h"
+#include "nlohmann/json.hpp"
+#include "stb_image.h"
+
+// Florb micro-benchmarks
+//
+// Times the CPU hot paths of a frame, and of loading, each in isolation: the
+// sphere geometry, the dust mote walk, motion evaluation, configuration
+// loading, image decoding and the flower shuffle. A kernel is first run
+// untimed for a warmup period, then timed in batches, each of enough
+// iterations to dwarf the clock's resolution, and the batches' per-iteration
+// times summarized. Kernels with a parameter which governs their cost are
+// swept across it. Anything which draws needs a GL context, so the kernels
+// run against a small headless one.
+
+// Namespace using directives
+
+namespace chrono = std::chrono;
+namespace fs = std::filesystem;
+
+using std::cerr;
+using std::cout;
+using std::endl;
+using std::exception;
+using std::function;
+using std::make_shared;
+using std::ofstream;
+using std::ostringstream;
+using std::runtime_error;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+using json = nlohmann::json_abi_v3_12_0::json;
+
+
+// The globals which Florb and its configs expect of the application
+Display *display = nullptr;
+Window window = 0;
+
+int screenWidth = 640;
+int screenHeight = 360;
+
+
+// Declaration of class MicroBench
+//
+// The benchmark harness, and the kernels it times. Florb befriends the
+// harness, so that its private geometry, mote and shuffle kernels can be
+// driven directly rather than through a whole frame.
+class MicroBench {
+
+    // Public type definitions
+public:
+
+    // Per-iteration times of one kernel at one parameter, in nanoseconds
+    struct Result {
+        string kernel;
+        string parameter;
+        unsigned long iterations;
+        double median;
+        double minimum;
+        double mean;
+        double deviation;
+    };
+
+
+    // Constructor
+public:
+
+    MicroBench(double warmup, unsigned int repetitions, const string &filter, const string &imagePath);
+
+
+    // Public interface methods
+public:
+
+    void run();
+
+    void writeJson(const string &path) const;
+
+
+    // Private helper methods
+private:
+
+    bool selected(const string &kernel) const;
+
+    // Time a kernel, called once per iteration
+    void measure(const string &kernel, const string &parameter, const function<void()> &body);
+
+    shared_ptr<FlorbConfigs> loadConfigs() const;
+
+    void benchGenerateSphere();
+
+    void benchUpdateMotes();
+
+    void benchSinusoidalMotion();
+
+    void benchLinearMotion();
+
+    void benchConfigsLoad();
+
+    void benchImageDecode();
+
+    void benchNextFlower();
+
+
+    // Private attributes
+private:
+
+    chrono::duration<double> warmup;
+
+    unsigned int repetitions;
+
+    string filter;
+
+    string imagePath;
+
+    vector<Result> results;
+
+    // Folds in kernel outputs, so that none can be optimized away
+    volatile float sink;
+
+    static const chrono::duration<double> k_MinBatchTime;
+
+    static const unsigned long k_MaxBatchIterations;
+
+};
+
+
+// Implementation of class MicroBench
+
+// Static attribute initialization
+
+// Long enough that timer resolution and call overhead are lost in it
+const chrono::duration<double> MicroBench::k_MinBatchTime(0.010);
+
+const unsigned long MicroBench::k_MaxBatchIterations(1UL << 24);
+
+
+// Constructor
+
+MicroBench::MicroBench(double warmup, unsigned int repetitions, const string &filter, const string &imagePath) :
+    warmup(warmup),
+    repetitions(repetitions),
+    filter(filter),
+    imagePath(imagePath),
+    results(),
+    sink(0.0f) { }
+
+
+// Public methods
+
+void MicroBench::run() {
+    cout << std::left
+         << std::setw(32) << "kernel"
+         << std::setw(32) << "parameter"
+         << std::right
+         << std::setw(12) << "iterations"
+         << std::setw(14) << "median ns"
+         << std::setw(14) << "min ns"
+         << std::setw(14) << "mean ns"
+         << std::setw(9) << "cv %"
+         << endl;
+
+    benchGenerateSphere();
+    benchUpdateMotes();
+    benchSinusoidalMotion();
+    benchLinearMotion();
+    benchConfigsLoad();
+    benchImageDecode();
+    benchNextFlower();
+}
+
+void MicroBench::writeJson(const string &path) const {
+    json document;
+    document["florb_microbench"] = 1;
+    document["repetitions"] = repetitions;
+    document["results"] = json::array();
+
+    for (const auto &result : results) {
+        json entry;
+        entry["kernel"] = result.kernel;
+        entry["parameter"] = result.parameter;
+        entry["iterations"] = result.iterations;
+        entry["median_ns"] = result.median;
+        entry["min_ns"] = result.minimum;
+        entry["mean_ns"] = result.mean;
+        entry["stddev_ns"] = result.deviation;
+        document["results"].push_back(entry);
+    }
+
+    ofstream file(path);
+    if (!file) throw runtime_error("Cannot write \"" + path + "\"");
+
+    file << std::setw(4) << document << endl;
+    cout << "[INFO] Results written to \"" << path << "\"" << endl;
+}
+
+
+// Private methods
+
+bool MicroBench::selected(const string &kernel) const {
+    return (filter.empty() or (kernel.find(filter) != string::npos));
+}
+
+void MicroBench::measure(const string &kernel, const string &parameter, const function<void()> &body) {
+    typedef chrono::steady_clock Clock;
+
+    if (!selected(kernel)) return;
+
+    // Warm caches, branch predictors and the CPU's clock before timing,
+    // counting iterations as a first estimate of a batch's size
+    unsigned long warmed(0UL);
+    auto warmupStart(Clock::now());
+    do {
+        body();
+        warmed++;
+    } while ((Clock::now() - warmupStart) < warmup);
+
+    auto perIteration(chrono::duration<double>(Clock::now() - warmupStart) / warmed);
+    auto batch(static_cast<unsigned long>(std::ceil(k_MinBatchTime / perIteration)));
+    batch = std::min(std::max(batch, 1UL), k_MaxBatchIterations);
+
+    vector<double> samples;
+    for (unsigned int repetition = 0; repetition < repetitions; repetition++) {
+        auto start(Clock::now());
+        for (unsigned long i = 0; i < batch; i++) body();
+        auto elapsed(chrono::duration<double, std::nano>(Clock::now() - start).count());
+
+        samples.push_back(elapsed / batch);
+    }
+
+    std::sort(samples.begin(), samples.end());
+
+    double total(0.0);
+    for (auto sample : samples) total += sample;
+
+    Result result;
+    result.kernel = kernel;
+    result.parameter = parameter;
+    result.iterations = (batch * repetitions);
+    result.minimum = samples.front();
+    result.mean = (total / samples.size());
+
+    auto middle(samples.size() / 2);
+    result.median = (((samples.size() % 2) == 1) ? samples[middle] :
+                     ((samples[middle - 1] + samples[middle]) / 2.0));
+
+    double squares(0.0);
+    for (auto sample : samples) squares += ((sample - result.mean) * (sample - result.mean));
+    result.deviation = std::sqrt(squares / samples.size());
+
+    results.push_back(result);
+
+    cout << std::left
+         << std::setw(32) << kernel
+         << std::setw(32) << parameter
+         << std::right << std::fixed << std::setprecision(1)
+         << std::setw(12) << result.iterations
+         << std::setw(14) << result.median
+         << std::setw(14) << result.minimum
+         << std::setw(14) << result.mean
+         << std::setw(9) << (100.0 * result.deviation / result.mean)
+         << endl;
+}
+
+shared_ptr<FlorbConfigs> MicroBench::loadConfigs() const {
+    auto configs(make_shared<FlorbConfigs>());
+    configs->load("configs/basic.json");
+
+    // Kernels are benchmarked apart from any flower library
+    configs->setImagePaths(vector<string>());
+    configs->setTransitionOrder(FlorbConfigs::TransitionOrder::RANDOM);
+    configs->setShaderHotReload(false);
+
+    return configs;
+}
+
+void MicroBench::benchGenerateSphere() {
+    if (!selected("Florb::generateSphere")) return;
+
+    Florb florb(loadConfigs(), 1U);
+
+    // Buffers are sized by initSphere(), once per smoothness
+    for (int smoothness : { 72, 144, 288, 576 }) {
+        glDeleteVertexArrays(1, &florb.vao);
+        glDeleteBuffers(1, &florb.vbo);
+        glDeleteBuffers(1, &florb.ebo);
+        florb.initSphere(smoothness, (smoothness / 2));
+
+        measure("Florb::generateSphere", ("smoothness " + std::to_string(smoothness)), [&florb, smoothness] {
+            florb.generateSphere(1.0f, smoothness, (smoothness / 2));
+        });
+    }
+
+    glFinish();
+}
+
+void MicroBench::benchUpdateMotes() {
+    if (!selected("Florb::updateMotes")) return;
+
+    for (unsigned int count : { 16U, 64U, 256U }) {
+        auto configs(loadConfigs());
+        configs->setMoteCount(count);
+
+        Florb florb(configs, 1U);
+        florb.motions.evaluate(0.0f, florb.motionValues.data(), florb.motionValues.size());
+
+        float timeSeconds(0.0f);
+        measure("Florb::updateMotes", ("motes " + std::to_string(count)), [&florb, &timeSeconds] {
+            florb.updateMotes(timeSeconds);
+            timeSeconds += (1.0f / 60.0f);
+        });
+    }
+}
+
+void MicroBench::benchSinusoidalMotion() {
+    if (!selected("SinusoidalMotion::evaluate")) return;
+
+    SinusoidalMotion motion(true, 0.5f, 0.5f, 0.4f, 0.25f);
+
+    float time(0.0f);
+    measure("SinusoidalMotion::evaluate", "", [this, &motion, &time] {
+        sink = (sink + motion.evaluate(time));
+        time += (1.0f / 60.0f);
+    });
+}
+
+void MicroBench::benchLinearMotion() {
+    if (!selected("LinearMotion::vectorEvaluate")) return;
+
+    LinearMotion motion(true, { 0.0f, 0.0f, 0.0f }, { 0.5f, 0.1f, 0.3f });
+
+    float time(0.0f);
+    measure("LinearMotion::vectorEvaluate", "3 dimensions", [this, &motion, &time] {
+        sink = (sink + motion.vectorEvaluate(time)[0]);
+        time += (1.0f / 60.0f);
+    });
+}
+
+void MicroBench::benchConfigsLoad() {
+    if (!selected("FlorbConfigs::load")) return;
+
+    for (const string path : { "configs/basic.json", "configs/effects.json" }) {
+        FlorbConfigs configs;
+
+        measure("FlorbConfigs::load", path, [&configs, &path] {
+            configs.load(path);
+        });
+    }
+}
+
+void MicroBench::benchImageDecode() {
+    if (!selected("Flower::loadImage") and !selected("Flower::loadImage decode")) return;
+
+    vector<fs::path> images;
+    if (fs::is_directory(imagePath)) {
+        for (const auto &entry : fs::recursive_directory_iterator(imagePath)) {
+            if (entry.is_regular_file() and (entry.path().extension() == ".png")) images.push_back(entry.path());
+        }
+    }
+
+    if (images.empty()) {
+        cerr << "[WARN] No images under \"" << imagePath << "\" to decode" << endl;
+        return;
+    }
+
+    // Swept from the smallest image to the largest
+    std::sort(images.begin(), images.end(), [](const fs::path &a, const fs::path &b) {
+        return (fs::file_size(a) < fs::file_size(b));
+    });
+
+    for (const auto &image : images) {
+        int width(0);
+        int height(0);
+        int channels(0);
+        if (!stbi_info(image.c_str(), &width, &height, &channels)) continue;
+
+        ostringstream parameter;
+        parameter << width << "x" << height << "x" << channels << " " << image.stem().string();
+
+        // The decode alone, as loadImage() performs it, then with the upload
+        measure("Flower::loadImage decode", parameter.str(), [this, &image] {
+            int w, h, c;
+            auto data(stbi_load(image.c_str(), &w, &h, &c, 0));
+            sink = (sink + data[0]);
+            stbi_image_free(data);
+        });
+
+        Flower flower(image.string());
+        measure("Flower::loadImage", parameter.str(), [&flower] {
+            flower.loadImage();
+        });
+
+        glFinish();
+    }
+}
+
+void MicroBench::benchNextFlower() {
+    if (!selected("Florb::nextFlower")) return;
+
+    Florb florb(loadConfigs(), 1U);
+
+    // Flowers are only decoded when loaded, so placeholders shuffle as well
+    for (unsigned int count : { 16U, 256U, 4096U }) {
+        florb.flowers.clear();
+        for (auto i = 0U; i < count; i++) florb.flowers.push_back(make_shared<Flower>(std::to_string(i)));
+
+        // Always from the last flower, so that every call reshuffles
+        measure("Florb::nextFlower shuffle", ("flowers " + std::to_string(count)), [&florb] {
+            florb.currentFlower = (florb.flowers.size() - 1);
+            florb.nextFlower();
+        });
+    }
+
+    florb.flowers.clear();
+}
+
+
+int main(int numArgs, const char *args[]) {
+
+    double warmup(0.2);
+    unsigned int repetitions(15U);
+    string filter;
+    string imagePath("flowers");
+    string jsonPath;
+
+    for (int arg = 1; arg < numArgs; arg++) {
+        string option(args[arg]);
+        bool valid(true);
+
+        if ((option == "--warmup") and ((arg + 1) < numArgs)) {
+            warmup = std::atof(args[++arg]);
+            valid = (warmup >= 0.0);
+        } else if ((option == "--repetitions") and ((arg + 1) < numArgs)) {
+            auto count(std::atol(args[++arg]));
+            repetitions = static_cast<unsigned int>(count);
+            valid = (count > 0);
+        } else if ((option == "--images") and ((arg + 1) < numArgs)) {
+            imagePath = args[++arg];
+        } else if ((option == "--json") and ((arg + 1) < numArgs)) {
+            jsonPath = args[++arg];
+        } else if (!option.empty() and (option[0] != '-') and filter.empty()) {
+            filter = option;
+        } else {
+            valid = false;
+        }
+
+        if (!valid) {
+            cerr << "Usage : "
+                 << args[0]
+                 << " [--warmup <seconds>] [--repetitions <count>] [--images <directory>] [--json <results.json>]"
+                 << " [<kernel filter>]"
+                 << endl;
+            return -EINVAL;
+        }
+    }
+
+    try {
+        HeadlessContext context(screenWidth, screenHeight);
+
+        GLenum err = glewInit();
+        if ((err != GLEW_OK) and (err != GLEW_ERROR_NO_GLX_DISPLAY)) {
+            throw runtime_error(string("GLEW init failed: ") + (const char*)glewGetErrorString(err));
+        }
+
+        MicroBench bench(warmup, repetitions, filter, imagePath);
+        bench.run();
+
+        if (!jsonPath.empty()) bench.writeJson(jsonPath);
+
+    } catch (const exception &e) {
+        cerr << "Fatal error: " << e.what() << endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -1,12 +1,21 @@
 #pragma once
 
-#include <memory>
-#include <mutex>
+#include <glm/glm.hpp>
 #include <string>
 #include <vector>
 
+#include "SeqLock.h"
+
 class Camera {
 
+public:
+
+    // Consistent copy of the mutable camera state
+    struct State {
+        glm::vec3 view;
+        float zoom;
+    };
+
 public:
 
     // Constructor
@@ -16,7 +25,9 @@ public:
 
 public:
 
-    const std::vector<float>& getView() const;
+    State getState() const;
+
+    glm::vec3 getView() const;
     void setView(float alpha, float beta, float phi);
 
     float getZoom() const;
@@ -26,10 +37,6 @@ private:
 
     const std::string name;
 
-    std::vector<float> view;
-    
-    float zoom;
-      
-    mutable std::mutex stateMutex;
+    SeqLock<State> state;
 
 };
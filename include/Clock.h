@@ -0,0 +1,74 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+
+// Declaration of class Clock
+//
+// The single source of animation time, measured from when the clock was
+// created. A real clock follows the steady clock; an accelerated clock runs
+// the steady clock at a multiple of its rate; a fixed clock ignores the
+// steady clock altogether and advances by exactly one step each time it is
+// ticked, once per frame, so that the same frames see the same times on
+// every run regardless of how long each takes to render.
+class Clock {
+
+    // Public type definitions
+public:
+
+    enum class Mode { REAL, FIXED, ACCELERATED };
+
+    typedef std::chrono::nanoseconds Duration;
+
+
+    // Constructor
+public:
+
+    // A real clock
+    Clock();
+
+
+    // Public interface methods
+public:
+
+    // Each mode restarts the clock from zero; configure it before use
+    void setReal();
+
+    void setFixed(Duration step);
+
+    void setAccelerated(double scale);
+
+    // Configure from "real", "fixed:<rate>" or "accelerated:<scale>"
+    bool parse(const std::string &description);
+
+    // A description which parse() accepts
+    std::string describe() const;
+
+    // Mark the start of a frame; only a fixed clock moves
+    void tick();
+
+    Duration now() const;
+
+    Mode getMode() const;
+
+
+    // Private helper methods
+private:
+
+    void restart();
+
+
+    // Private attributes
+private:
+
+    Mode mode;
+
+    std::chrono::steady_clock::time_point origin;
+
+    Duration step;
+
+    double scale;
+
+    Duration elapsed;
+
+};
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Class forward references
+class Florb;
+class FlorbConfigs;
+
+// Declaration of class EffectCosts
+//
+// Measures what each shader effect costs on the GPU, to decide which to turn
+// off on weak hardware. With time frozen, the same scene is rendered with
+// every effect off, with each effect on alone, then with all of them on, at
+// each of a set of resolutions. Each frame is bracketed by GL_TIMESTAMP
+// queries, which unlike elapsed-time queries may overlap the profiler's own,
+// and an effect's marginal cost is the median frame time with it on, less
+// that with every effect off. The costs are printed as a matrix of effects
+// by resolution.
+class EffectCosts {
+
+    // Public type definitions
+public:
+
+    typedef std::pair<int, int> Size;
+
+
+    // Constructor / destructor
+public:
+
+    EffectCosts(std::shared_ptr<FlorbConfigs> configs, Florb &florb);
+
+    ~EffectCosts();
+
+    EffectCosts(const EffectCosts&) = delete;
+    EffectCosts& operator=(const EffectCosts&) = delete;
+
+
+    // Public interface methods
+public:
+
+    // Configure every effect on, so that a Florb constructed afterwards
+    // allocates all it needs, such as the full count of motes; throws if
+    // the scene no longer has the lights and cameras configured
+    static void prepare(FlorbConfigs &configs);
+
+    // Parse "<width>x<height>[,<width>x<height>...]"
+    static bool parseSizes(const std::string &description, std::vector<Size> &sizes);
+
+    // Render frames per effect at each size, which must fit the framebuffer
+    void run(const std::vector<Size> &sizes, unsigned int frames);
+
+
+    // Public attributes
+public:
+
+    // Frames measured per effect and size, unless otherwise asked
+    static const unsigned int k_DefaultFrames;
+
+
+    // Private type definitions
+private:
+
+    // An effect, and the configuration which turns it on
+    struct Effect {
+        const char *name;
+        const char *patch;
+    };
+
+
+    // Private helper methods
+private:
+
+    // Configure the scene with every effect off, then the patch applied
+    void apply(const std::string &patch);
+
+    // Median GPU time of a frame, in milliseconds
+    double measure(unsigned int frames);
+
+
+    // Private attributes
+private:
+
+    std::shared_ptr<FlorbConfigs> configs;
+
+    Florb &florb;
+
+    // The configuration the scene started from
+    std::string document;
+
+    std::vector<GLuint> queries;
+
+    static const Effect k_Effects[];
+
+    static const char *const k_EffectsOff;
+
+    static const unsigned int k_WarmupFrames;
+
+};
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <deque>
+#include <fstream>
+#include <string>
+
+// Declaration of class EventScript
+//
+// A session script: the seed and clock a session ran with, followed by every
+// input and configuration event, each stamped with the frame it took effect
+// on. Recording writes the script as JSON lines while the session runs;
+// replaying reads it back and hands each event out again on its frame, so
+// that with a fixed clock the replayed session renders exactly the frames
+// of the recorded one.
+class EventScript {
+
+    // Public type definitions
+public:
+
+    enum class Type { KEY, RESIZE, CONFIG, END };
+
+    struct Event {
+        unsigned long frame = 0UL;
+        Type type = Type::END;
+
+        // Key name, for KEY events
+        std::string key;
+
+        // New size, for RESIZE events
+        int width = 0;
+        int height = 0;
+
+        // Configuration document, for CONFIG events
+        std::string document;
+    };
+
+    // How the session was run
+    struct Header {
+        unsigned int seed = 0U;
+        std::string clock;
+        int width = 0;
+        int height = 0;
+    };
+
+
+    // Constructor / destructor
+public:
+
+    EventScript();
+
+
+    // Public interface methods
+public:
+
+    // Begin writing a script; throws runtime_error when it cannot be opened
+    void record(const std::string &path, const Header &header);
+
+    // Read a whole script; throws runtime_error when it cannot be read
+    Header replay(const std::string &path);
+
+    bool isRecording() const;
+
+    bool isReplaying() const;
+
+    // Append an event to the script being recorded
+    void add(const Event &event);
+
+    // Take the next replayed event due by the given frame
+    bool poll(unsigned long frame, Event &event);
+
+
+    // Private attributes
+private:
+
+    std::ofstream output;
+
+    std::deque<Event> events;
+
+    bool replaying;
+
+    static const int k_Version;
+
+};
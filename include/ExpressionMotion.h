@@ -0,0 +1,24 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "MotionExpression.h"
+#include "MultiMotion.h"
+
+class ExpressionMotion final : public MultiMotion {
+public:
+
+    // Throws if any of the expressions fails to compile
+    ExpressionMotion(bool enabled, const std::vector<std::string> &expressions);
+
+    using MultiMotion::evaluate;
+
+    void evaluate(float time, float *results, size_t count) const override;
+
+    size_t getDimensions() const override;
+
+private:
+    std::vector<MotionExpression> expressions;
+
+};
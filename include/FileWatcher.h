@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+// Declaration of class FileWatcher
+//
+// Polls the modification times of a set of files from a background thread,
+// bumping a generation counter whenever any of them changes on disk.
+class FileWatcher {
+
+    // Constructor / destructor
+public:
+
+    FileWatcher(const std::vector<std::string> &paths,
+                std::chrono::milliseconds interval);
+
+    ~FileWatcher();
+
+
+    // Public interface methods
+public:
+
+    const std::vector<std::string>& getPaths() const;
+
+    unsigned int getGeneration() const;
+
+
+    // Private helper methods
+private:
+
+    void watch();
+
+    std::filesystem::file_time_type writeTime(const std::string &path) const;
+
+
+    // Private attributes
+private:
+
+    const std::vector<std::string> paths;
+
+    const std::chrono::milliseconds interval;
+
+    std::vector<std::filesystem::file_time_type> writeTimes;
+
+    std::atomic<unsigned int> generation;
+
+    bool running;
+
+    std::mutex wakeMutex;
+
+    std::condition_variable wake;
+
+    std::thread watcher;
+
+};
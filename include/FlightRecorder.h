@@ -0,0 +1,148 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "FrameProfiler.h"
+
+// Declaration of class FlightRecorder
+//
+// Always-on record of the recent past, in constant memory: the last frames'
+// stage timings from a FrameProfiler, with the OpenGL errors raised in each,
+// and a log of notable events such as flower switches, texture uploads and
+// configuration changes. When a frame takes longer than a multiple of its
+// budget, the recorder copies out the last few seconds and a background
+// thread writes them to a JSON snapshot file, so that an occasional hitch
+// leaves evidence behind without disturbing the frames which follow it. The
+// ring holds a whole window at the fastest paced rate, and is only resized
+// when the window changes; recording and capturing never allocate.
+class FlightRecorder {
+
+    // Constructor / destructor
+public:
+
+    explicit FlightRecorder(std::shared_ptr<const FrameProfiler> profiler);
+
+    ~FlightRecorder();
+
+
+    // Public interface methods
+public:
+
+    void setEnabled(bool enabled);
+
+    // Seconds of history written into each snapshot, up to a minute
+    void setWindow(float seconds);
+
+    // Frames longer than this multiple of the budget trigger a snapshot
+    void setThreshold(float multiple);
+
+    void setDirectory(const std::string &directory);
+
+    // Note an event; names must be string literals
+    void addEvent(const char *name, double value = 0.0);
+
+    // Record the profiler's last frame, which was allotted budget nanoseconds
+    void addFrame(std::int64_t budget);
+
+    unsigned long getSnapshots() const;
+
+
+    // Private type definitions
+private:
+
+    struct Frame {
+        std::int64_t end;
+        std::int64_t interval;
+        unsigned long glErrors;
+        FrameProfiler::FrameRecord stages;
+    };
+
+    struct Event {
+        std::int64_t time;
+        const char *name;
+        double value;
+    };
+
+    // A copy of the recent past, handed to the writer thread
+    struct Snapshot {
+        std::vector<Frame> frames;
+        std::vector<Event> events;
+        std::vector<std::string> stageNames;
+        unsigned int stageCount;
+        std::vector<const char*> counterNames;
+        std::int64_t budget;
+        std::string path;
+    };
+
+
+    // Private helper methods
+private:
+
+    // Frames in a window at the fastest paced rate
+    static size_t getCapacity(std::int64_t window);
+
+    // Size a snapshot's storage so that filling it never allocates
+    void reserve(Snapshot &snapshot) const;
+
+    void capture(const Frame &trigger, std::int64_t budget);
+
+    void writeLoop();
+
+    static void write(const Snapshot &snapshot);
+
+
+    // Private attributes
+private:
+
+    std::shared_ptr<const FrameProfiler> profiler;
+
+    bool enabled;
+    std::int64_t window;
+    float threshold;
+    std::string directory;
+
+    std::vector<Frame> frames;
+    size_t frameCapacity;
+    size_t frameNext;
+    size_t frameCount;
+
+    std::vector<Event> events;
+    size_t eventNext;
+    size_t eventCount;
+
+    std::int64_t lastEnd;
+    unsigned long lastErrors;
+    std::int64_t lastSnapshot;
+    unsigned long snapshots;
+
+    // Shared with the writer thread, under writeMutex
+    Snapshot pending;
+    bool writePending;
+    bool running;
+
+    // Owned by the writer thread
+    Snapshot writing;
+
+    std::mutex writeMutex;
+
+    std::condition_variable wake;
+
+    std::thread writer;
+
+    static constexpr size_t k_MaxEvents = 1024;
+
+    static constexpr size_t k_MaxStageName = 64;
+
+    static const float k_MaxFrameRate;
+
+    static const std::int64_t k_MaxWindow;
+
+    static const std::int64_t k_MinSnapshotInterval;
+
+};
@@ -7,38 +7,69 @@
 #include <vector>
 #include <random>
 
+#include "FlightRecorder.h"
+#include "FlorbConfigs.h"
 #include "Flower.h"
+#include "FrameProfiler.h"
+#include "MotionBatch.h"
+#include "PhysicsWorld.h"
+#include "ShaderUniforms.h"
+#include "SinusoidalMotion.h"
+#include "Timeline.h"
 
 // Class forward references
 class Camera;
-class FlorbConfigs;
+class KeyframeCurve;
 class MotionAlgorithm;
+class MotionExpression;
+class ShaderProgram;
 class Spotlight;
 
 
 // Florb class encapsulating the sphere state, geometry, textures, and behavior
 class Florb {
 
+    // Micro-benchmarks time the private geometry, mote and shuffle kernels
+    friend class MicroBench;
+
 public:
-    Florb();
+    // Every random choice, from mote placement to shuffled flower order,
+    // follows from the seed
+    Florb(std::shared_ptr<FlorbConfigs> configs, unsigned int seed);
     virtual ~Florb();
 
     std::shared_ptr<FlorbConfigs> getConfigs() const;
 
+    std::shared_ptr<FrameProfiler> getProfiler() const;
+
+    std::shared_ptr<FlightRecorder> getRecorder() const;
+
+    // Take animation time from the given clock
+    void setClock(std::shared_ptr<Clock> clock);
+
     void nextFlower();
   
-    void renderFrame(bool transition);
+    void renderFrame();
+
+    // Whether flower images are still being uploaded, one per frame
+    bool isLoading() const;
 
 private:
   
     void loadFlowers();
 
-    void updateTransition(bool transition, float timeSeconds);
+    void updateTransition(Timeline::Duration now);
+
+    void scheduleImageSwitch();
 
     void initSphere(int sectorCount, int stackCount);
     void generateSphere(float radius, int sectorCount, int stackCount);
   
     void initShaders();
+
+    void initUniforms();
+
+    void reportUniformStats();
   
     void initMotes(unsigned int count,
 		   float radius,
@@ -46,19 +77,108 @@ private:
 		   const std::vector<float> &color);
     void updateMotes(float timeSeconds);
 
-    void createBouncer();
-    void createBreather();
-    void createRimPulser();
+    std::string compileMotionExpressions();
+
+    void compileMotionCurves();
+
+    void updateMotionDescriptors();
   
     void updatePhysicalEffects(bool transition);
 
+    void latchUniforms();
+
 private:
 
+    // Capacities of the shader's uniform block arrays
+    static const unsigned int k_MaxLights = 4;
+    static const unsigned int k_MaxMotes = 256;
+
+    // Motion descriptor slots, matching the shaders' MOTION_* indices
+    enum MotionSlot { BOUNCE_MOTION, BREATHE_MOTION, RIM_MOTION, MAX_MOTIONS };
+
+    // Motion descriptor types, matching the shaders' MOTION_* types
+    enum MotionType { CONSTANT_MOTION, SINUSOIDAL_MOTION, EXPRESSION_MOTION };
+
+    // Profiled stages of a frame, registered in this order
+    enum ProfileStage {
+        CONFIGS_STAGE, TIMELINE_STAGE, SPHERE_STAGE, TEXTURES_STAGE, SHADERS_STAGE,
+        PHYSICS_STAGE, MOTES_STAGE, UNIFORMS_STAGE, DRAW_STAGE, MAX_STAGES
+    };
+
     // Structure for passing vertices to the vertex shader
     struct Vertex {
         glm::vec3 position;
         glm::vec3 normal;
     };
+
+    // std140 mirror of the shader's Lights uniform block
+    struct LightsBlock {
+        struct Light {
+            glm::vec3 direction;
+            GLfloat intensity;
+            glm::vec3 color;
+            GLfloat padding;
+        } spotlights[k_MaxLights];
+
+        GLint lightCount;
+        GLfloat shininess;
+        GLfloat padding[2];
+    };
+
+    // std140 mirror of the shaders' Motions uniform block
+    struct MotionsBlock {
+        struct Motion {
+            GLfloat bias;
+            GLfloat amplitude;
+            GLfloat frequency;
+            GLfloat phase;
+            GLint type;
+            GLint padding[3];
+        } motions[MAX_MOTIONS];
+    };
+
+    // std140 mirror of the shader's Effects uniform block
+    struct EffectsBlock {
+        glm::vec3 rimColor;
+        GLfloat rimExponent;
+
+        GLfloat vignetteExponent;
+        GLfloat iridescenceStrength;
+        GLfloat iridescenceFrequency;
+        GLfloat iridescenceShift;
+
+        GLfloat anisotropyStrength;
+        GLfloat anisotropySharpness;
+        GLfloat waveAmplitude;
+        GLfloat waveFrequency;
+
+        GLfloat waveSpeed;
+        GLint anisotropyEnabled;
+        GLint anisotropicDebug;
+        GLint specularDebug;
+    };
+
+    // std140 mirror of the shader's Motes uniform block
+    struct MotesBlock {
+        glm::vec4 motes[k_MaxMotes];
+        GLfloat motesAmplitudes[k_MaxMotes];
+        glm::vec3 motesColor;
+        GLint moteCount;
+    };
+
+    // Handles onto the per-frame default-block uniforms
+    struct FrameUniforms {
+        Uniform<GLfloat> time;
+        Uniform<glm::mat4> projView;
+        Uniform<glm::vec2> resolution;
+        Uniform<GLfloat> aspectRatio;
+        Uniform<glm::vec2> offset;
+        Uniform<glm::vec3> viewPos;
+        Uniform<GLfloat> zoom;
+        Uniform<GLfloat> transitionProgress;
+        Uniform<GLint> previousTexture;
+        Uniform<GLint> currentTexture;
+    };
   
 private:
   
@@ -69,7 +189,7 @@ private:
     unsigned int previousFlower;
     std::shared_ptr<std::default_random_engine> flowersRandom;
 
-    float transitionStart;
+    Timeline::Duration transitionStart;
 
     std::vector<std::shared_ptr<Camera>> cameras;
 
@@ -77,8 +197,6 @@ private:
 
     float baseRadius;
 
-    float baseRimStrength;
-
     glm::vec3 animatedRimColor;
 
     float vignetteRadius = 0.0f;
@@ -89,7 +207,6 @@ private:
     std::vector<float> motesSpeeds;
     float motesMaxStep;
     std::vector<float> motesCenters;
-    std::vector<std::shared_ptr<MotionAlgorithm>> motesPulsers;
     std::vector<bool> motesWinkingEnabled;
     std::vector<float> motesWinkTimes;
     std::vector<bool> motesWinking;
@@ -99,22 +216,52 @@ private:
     std::vector<float> motesColor;
 
     std::shared_ptr<FlorbConfigs> configs;
+    std::shared_ptr<const FlorbConfigs::Snapshot> snapshot;
+
+    std::shared_ptr<FrameProfiler> profiler;
+
+    std::shared_ptr<FlightRecorder> recorder;
+
+    Timeline timeline;
+    unsigned long imageSwitchEvent;
+    float imageSwitchPeriod;
+    bool transitionPending;
+
+    MotionBatch<SinusoidalMotion> motions;
+    std::vector<float> motionValues;
+    size_t motesMotion;
 
-    std::shared_ptr<MotionAlgorithm> bouncer;
-    float bounceOffset;
-    std::shared_ptr<MotionAlgorithm> breather;
-    std::shared_ptr<MotionAlgorithm> rimPulser;
+    // Expression motions compiled into the shaders, per descriptor slot
+    std::string motionSources[MAX_MOTIONS];
+    std::shared_ptr<MotionExpression> motionExpressions[MAX_MOTIONS];
+
+    // Keyframed motions evaluated on the CPU, per descriptor slot
+    std::shared_ptr<KeyframeCurve> motionCurves[MAX_MOTIONS];
+
+    PhysicsWorld physics;
+    size_t bounceBody;
+    Timeline::Duration physicsTime;
 
     GLuint vao = 0;
     GLuint vbo = 0;
     GLuint ebo = 0;
-    GLuint shaderProgram = 0;
+    std::shared_ptr<ShaderProgram> shaders;
+
+    std::shared_ptr<ShaderUniforms> uniforms;
+    FrameUniforms frameUniforms;
+    std::shared_ptr<UniformBlock<MotionsBlock>> motionsBlock;
+    std::shared_ptr<UniformBlock<LightsBlock>> lightsBlock;
+    std::shared_ptr<UniformBlock<EffectsBlock>> effectsBlock;
+    std::shared_ptr<UniformBlock<MotesBlock>> motesBlock;
+
+    unsigned int uniformStatsFrames;
+    unsigned long uniformStatsCalls;
+    unsigned long uniformStatsUploads;
     GLuint loadingTexture = 0;
     GLuint fallbackTexture = 0;
   
     int indexCount = 0;
 
-    std::random_device rd;
     std::mt19937 gen;
     std::uniform_real_distribution<float> dist;
 
@@ -122,5 +269,7 @@ private:
     static const float k_MinMoteWinkFrequency;
     static const float k_MaxMoteWinkFrequency;
     static const float k_MoteWinkThreshold;
+
+    static const char *const k_StageNames[MAX_STAGES];
   
 };
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <mutex>
 #include <string>
 #include <vector>
@@ -14,6 +15,10 @@ class Spotlight;
 
 
 // Declaration of class FlorbConfigs
+//
+// Configuration state is published as immutable, versioned snapshots. Readers
+// take (or refresh) a snapshot without locking; mutators copy the current
+// snapshot, apply their change and publish the result with an atomic swap.
 class FlorbConfigs : public std::enable_shared_from_this<FlorbConfigs> {
 
     // Public type definitions
@@ -35,6 +40,115 @@ public:
     enum class TransitionOrder { ALPHABETICAL, RANDOM };
 
 
+    // Immutable snapshot of the complete configuration state
+    struct Snapshot {
+        unsigned long version = 0UL;
+
+        // The JSON document last parsed, so that a session can be replayed
+        std::string document;
+
+        std::vector<std::string> imagePaths;
+
+        std::string title;
+
+        float videoFrameRate = k_DefaultVideoFrameRate;
+        float imageSwitch = k_DefaultImageSwitch;
+        bool vsync = false;
+        unsigned int framesInFlight = k_DefaultFramesInFlight;
+
+        std::string vertexShaderPath = k_DefaultVertexShaderPath;
+        std::string fragmentShaderPath = k_DefaultFragmentShaderPath;
+        bool shaderHotReload = false;
+
+        TransitionMode transitionMode = TransitionMode::FLIP;
+        TransitionOrder transitionOrder = TransitionOrder::ALPHABETICAL;
+        float transitionTime = k_DefaultTransitionTime;
+
+        std::vector<std::shared_ptr<Camera>> cameras;
+
+        float offsetX = 0.0f;
+        float offsetY = 0.0f;
+        float radius = k_DefaultRadius;
+        unsigned int smoothness = 7U;
+
+        float shininess = 1.0f;
+        std::vector<std::shared_ptr<Spotlight>> spotlights;
+
+        bool anisotropyEnabled = false;
+        float anisotropyStrength = 0.0f;
+        float anisotropySharpness = 0.0f;
+
+        bool bounceEnabled = false;
+        float bounceAmplitude = 0.0f;
+        float bounceFrequency = 0.0f;
+        std::string bounceExpression;
+        bool bounceViscous = false;
+        float bounceStiffness = 0.0f;
+        float bounceDamping = 0.0f;
+        float bounceDrag = 0.0f;
+        float bounceImpulse = 0.0f;
+        float bounceImpulsePeriod = 0.0f;
+        std::vector<std::pair<float, float>> bounceKeyframes;
+
+        bool breatheEnabled = false;
+        std::vector<float> breatheAmplitude = std::vector<float>(2, k_DefaultRadius);
+        float breatheFrequency = 0.0f;
+        std::string breatheExpression;
+        std::vector<std::pair<float, float>> breatheKeyframes;
+
+        float rimStrength = 0.0f;
+        float rimExponent = 0.0f;
+        std::vector<float> rimColor = std::vector<float>(3, 0.0f);
+        float rimFrequency = 0.0f;
+        bool rimAnimateEnabled = false;
+        float rimAnimateFrequency = 0.0f;
+        std::string rimExpression;
+        std::vector<std::pair<float, float>> rimKeyframes;
+
+        float vignetteRadius = 0.0f;
+        float vignetteExponent = 0.0f;
+
+        float iridescenceStrength = 0.0f;
+        float iridescenceFrequency = 0.0f;
+        float iridescenceShift = 0.0f;
+
+        unsigned int moteCount = 0U;
+        float motesRadius = 0.0f;
+        float motesMaxStep = 0.0f;
+        bool motesWinkingEnabled = false;
+        float motesMaxOff = 0.0f;
+        std::vector<float> motesColor = std::vector<float>(3, 0.0f);
+
+        bool flutterEnabled = false;
+        float flutterAmplitude = 0.0f;
+        float flutterFrequency = 0.0f;
+        float flutterSpeed = 0.0f;
+
+        AnisotropicMode anisotropicMode = AnisotropicMode::NORMAL;
+        RenderMode renderMode = RenderMode::FILL;
+        SpecularMode specularMode = SpecularMode::NORMAL;
+        bool uniformStats = false;
+        bool frameStats = false;
+        bool glCounters = false;
+        bool glDebug = true;
+        bool glSynchronous = false;
+
+        bool profileEnabled = false;
+        std::string profilePath = k_DefaultProfilePath;
+        float profileInterval = k_DefaultProfileInterval;
+        bool profileCounters = false;
+
+        bool recorderEnabled = true;
+        float recorderWindow = k_DefaultRecorderWindow;
+        float recorderThreshold = k_DefaultRecorderThreshold;
+        std::string recorderDirectory = k_DefaultRecorderDirectory;
+
+        bool resourcesEnabled = false;
+        std::string resourcesPath = k_DefaultResourcesPath;
+        float resourcesInterval = k_DefaultResourcesInterval;
+    };
+
+
     // Constructor
 public:
         
@@ -44,13 +158,27 @@ public:
     // Public interface methods
 public:
 
-    void load();
+    // Read and parse a configuration file, florb.json by default
+    void load(const std::string &path = k_DefaultPath);
+
+    // Read a configuration file without parsing it
+    static bool read(std::string &document, const std::string &path = k_DefaultPath);
+
+    // Parse a configuration document, publishing it as one snapshot
+    void parse(const std::string &document);
+
+    std::shared_ptr<const Snapshot> getSnapshot() const;
 
-    const std::string& getTitle() const;
+    unsigned long getVersion() const;
+
+    bool refresh(std::shared_ptr<const Snapshot> &current) const;
+
+
+    std::string getTitle() const;
     void setTitle(const std::string& t);
 
   
-    const std::vector<std::string>& getImagePaths() const;
+    std::vector<std::string> getImagePaths() const;
     void setImagePaths(const std::vector<std::string>& p);
 
 
@@ -70,7 +198,23 @@ public:
     float getImageSwitch() const;
     void setImageSwitch(float s);
 
-    const std::vector<std::shared_ptr<Camera>>& getCameras() const;
+    bool getVsync() const;
+    void setVsync(bool v);
+
+    unsigned int getFramesInFlight() const;
+    void setFramesInFlight(unsigned int f);
+
+
+    std::string getVertexShaderPath() const;
+    void setVertexShaderPath(const std::string &p);
+
+    std::string getFragmentShaderPath() const;
+    void setFragmentShaderPath(const std::string &p);
+
+    bool getShaderHotReload() const;
+    void setShaderHotReload(bool h);
+
+    std::vector<std::shared_ptr<Camera>> getCameras() const;
 
   
     std::pair<float, float> getCenter() const;
@@ -86,7 +230,7 @@ public:
     float getShininess() const;
     void setShininess(float s);
   
-    const std::vector<std::shared_ptr<Spotlight>>& getSpotlights() const;
+    std::vector<std::shared_ptr<Spotlight>> getSpotlights() const;
 
 
     bool getAnisotropyEnabled() const;
@@ -108,16 +252,46 @@ public:
     float getBounceFrequency() const;
     void setBounceFrequency(float f);
 
+    std::string getBounceExpression() const;
+    void setBounceExpression(const std::string &e);
+
+    bool getBounceViscous() const;
+    void setBounceViscous(bool v);
+
+    float getBounceStiffness() const;
+    void setBounceStiffness(float s);
+
+    float getBounceDamping() const;
+    void setBounceDamping(float d);
+
+    float getBounceDrag() const;
+    void setBounceDrag(float d);
+
+    float getBounceImpulse() const;
+    void setBounceImpulse(float i);
+
+    float getBounceImpulsePeriod() const;
+    void setBounceImpulsePeriod(float p);
+
+    std::vector<std::pair<float, float>> getBounceKeyframes() const;
+    void setBounceKeyframes(const std::vector<std::pair<float, float>> &k);
+
   
     bool getBreatheEnabled() const;
     void setBreatheEnabled(bool e);
 
-    const std::vector<float>& getBreatheAmplitude() const;
+    std::vector<float> getBreatheAmplitude() const;
     void setBreatheAmplitude(float min, float max);
 
     float getBreatheFrequency() const;
     void setBreatheFrequency(float f);
 
+    std::string getBreatheExpression() const;
+    void setBreatheExpression(const std::string &e);
+
+    std::vector<std::pair<float, float>> getBreatheKeyframes() const;
+    void setBreatheKeyframes(const std::vector<std::pair<float, float>> &k);
+
   
     float getRimStrength() const;
     void setRimStrength(float s);
@@ -125,7 +299,7 @@ public:
     float getRimExponent() const;
     void setRimExponent(float e);
 
-    const std::vector<float>& getRimColor() const;
+    std::vector<float> getRimColor() const;
     void setRimColor(float r, float g, float b);
 
     float getRimFrequency() const;
@@ -137,6 +311,12 @@ public:
     float getRimAnimateFrequency() const;
     void setRimAnimateFrequency(float f);
 
+    std::string getRimExpression() const;
+    void setRimExpression(const std::string &e);
+
+    std::vector<std::pair<float, float>> getRimKeyframes() const;
+    void setRimKeyframes(const std::vector<std::pair<float, float>> &k);
+
     
     float getIridescenceStrength() const;
     void setIridescenceStrength(float s);
@@ -170,7 +350,7 @@ public:
     float getMotesWinkingMaxOff() const;
     void setMotesWinkingMaxOff(float m);
     
-    const std::vector<float>& getMotesColor() const;
+    std::vector<float> getMotesColor() const;
     void setMotesColor(float r, float g, float b);
 
 
@@ -196,99 +376,133 @@ public:
     SpecularMode getSpecularMode() const;
     void setSpecularMode(SpecularMode s);  
 
+    bool getUniformStats() const;
+    void setUniformStats(bool u);
+
+    bool getFrameStats() const;
+    void setFrameStats(bool f);
+
+    bool getGLCounters() const;
+    void setGLCounters(bool g);
+
+    // Read when the context is created, so only takes effect on a restart
+    bool getGLDebug() const;
+    void setGLDebug(bool g);
+
+    bool getGLSynchronous() const;
+    void setGLSynchronous(bool g);
+
+    bool getProfileEnabled() const;
+    void setProfileEnabled(bool e);
+
+    std::string getProfilePath() const;
+    void setProfilePath(const std::string &p);
+
+    float getProfileInterval() const;
+    void setProfileInterval(float i);
+
+    bool getProfileCounters() const;
+    void setProfileCounters(bool c);
+
+    bool getRecorderEnabled() const;
+    void setRecorderEnabled(bool e);
+
+    float getRecorderWindow() const;
+    void setRecorderWindow(float w);
+
+    float getRecorderThreshold() const;
+    void setRecorderThreshold(float t);
+
+    std::string getRecorderDirectory() const;
+    void setRecorderDirectory(const std::string &d);
+
+    bool getResourcesEnabled() const;
+    void setResourcesEnabled(bool e);
+
+    std::string getResourcesPath() const;
+    void setResourcesPath(const std::string &p);
+
+    float getResourcesInterval() const;
+    void setResourcesInterval(float i);
+
     
     // Public attributes
 public:
+
+    static const std::string k_DefaultPath;
   
     static const std::string k_DefaultImagePath;
   
     static const float k_DefaultRadius;
 
     
+    // Private type definitions
+private:
+
+    // Scoped writer; nested writers coalesce into a single published snapshot
+    class Writer {
+    public:
+
+        explicit Writer(FlorbConfigs &configs);
+
+        ~Writer();
+
+        Snapshot& getState();
+
+    private:
+
+        FlorbConfigs &configs;
+
+        bool owner;
+
+    };
+
+
     // Private helper methods
 private:
 
-    void parseSpotlights(const nlohmann::json &light);
+    void parseSpotlights(const nlohmann::json &light, Snapshot &state);
+
+    static std::vector<std::pair<float, float>> parseKeyframes(const nlohmann::json &keyframes);
 
 
     // Private attributes
 private:
-  
-    std::vector<std::string> imagePaths;
-  
-    std::string title;
-  
-    float videoFrameRate;
-    float imageSwitch;
 
-    TransitionMode transitionMode;
-    TransitionOrder transitionOrder;
-    float transitionTime;
-  
-    std::vector<std::shared_ptr<Camera>> cameras;
-
-    float offsetX;
-    float offsetY;
-    float radius;
-    unsigned int smoothness;
-
-    float shininess;
-    std::vector<std::shared_ptr<Spotlight>> spotlights;
-
-    bool anisotropyEnabled;
-    float anisotropyStrength;
-    float anisotropySharpness;
-
-    bool bounceEnabled;
-    float bounceAmplitude;
-    float bounceFrequency;
-
-    bool breatheEnabled;
-    std::vector<float> breatheAmplitude;
-    float breatheFrequency;
-
-    float rimStrength;
-    float rimExponent;
-    std::vector<float> rimColor;
-    float rimFrequency;
-    bool rimAnimateEnabled;
-    float rimAnimateFrequency;
-
-    float vignetteRadius;
-    float vignetteExponent;
-
-    float iridescenceStrength;
-    float iridescenceFrequency;
-    float iridescenceShift;
-
-    unsigned int moteCount;
-    float motesRadius;
-    float motesMaxStep;
-    bool motesWinkingEnabled;
-    float motesMaxOff;
-    std::vector<float> motesColor;
-
-    bool flutterEnabled;
-    float flutterAmplitude;
-    float flutterFrequency;
-    float flutterSpeed;
-
-    AnisotropicMode anisotropicMode;
-    RenderMode renderMode;
-    SpecularMode specularMode;
-      
-    mutable std::mutex stateMutex;
+    // Published snapshot, only accessed through std::atomic_load / atomic_store
+    std::shared_ptr<const Snapshot> snapshot;
+
+    std::atomic<unsigned long> version;
+
+    std::shared_ptr<Snapshot> pending;
+
+    mutable std::recursive_mutex writerMutex;
 
     static const std::string k_DefaultTitle;
 
     static const float k_MaxVideoFrameRate;
     static const float k_DefaultVideoFrameRate;
+    static const unsigned int k_MaxFramesInFlight;
+    static const unsigned int k_DefaultFramesInFlight;
     static const float k_DefaultImageSwitch;
 
+    static const std::string k_DefaultVertexShaderPath;
+    static const std::string k_DefaultFragmentShaderPath;
+
     static const float k_DefaultTransitionTime;
 
     static const unsigned int k_MaxSpotlights;
   
     static const int k_MaxMotes;
+
+    static const std::string k_DefaultProfilePath;
+    static const float k_DefaultProfileInterval;
+
+    static const float k_DefaultRecorderWindow;
+    static const float k_DefaultRecorderThreshold;
+    static const std::string k_DefaultRecorderDirectory;
+
+    static const std::string k_DefaultResourcesPath;
+    static const float k_DefaultResourcesInterval;
     
 };
@@ -22,7 +22,14 @@ namespace FlorbUtils {
     void setWindowTitle(Display *display,
 			Window window,
 			const std::string &title);
+
+    // True when a GLX or headless EGL context is current on this thread
+    bool hasCurrentContext();
   
+    // Polls for OpenGL errors only when GLDebug checks synchronously
     void glCheck(const std::string &str);
 
+    // Total OpenGL errors reported by glCheck and GLDebug
+    unsigned long glErrorCount();
+
 }
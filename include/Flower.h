@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <GL/gl.h>
 
@@ -22,6 +23,9 @@ public:
     
     GLenum getFormat() const;
 
+    // Note that the texture has been drawn, closing its trace flow
+    void markDisplayed();
+
     Flower& operator=(const Flower& other);
 
 private:
@@ -33,5 +37,8 @@ private:
     GLint channels = 0;
     GLenum format = 0;
 
+    // Trace flow from decode through upload to first display
+    std::uint64_t traceFlow = 0;
+
     void loadFromFile(const std::string& filename);
 };
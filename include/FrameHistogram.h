@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+// Declaration of class FrameHistogram
+//
+// Fixed-bin histogram of frame intervals, cheap enough to update every frame
+// without allocating. Reports percentiles to within one bin width.
+class FrameHistogram {
+
+    // Constructor
+public:
+
+    // Bins of binWidth nanoseconds, the last also counting every longer interval
+    FrameHistogram(std::int64_t binWidth = k_DefaultBinWidth,
+                   size_t binCount = k_DefaultBinCount);
+
+
+    // Public interface methods
+public:
+
+    void add(std::int64_t interval);
+
+    void clear();
+
+    std::uint64_t getCount() const;
+
+    double getMean() const;
+
+    double getStandardDeviation() const;
+
+    std::int64_t getMinimum() const;
+
+    std::int64_t getMaximum() const;
+
+    // Upper edge of the bin holding the given fraction of intervals, e.g. 0.99
+    std::int64_t getPercentile(double fraction) const;
+
+    // Intervals longer than the given threshold, e.g. missed deadlines
+    std::uint64_t countAbove(std::int64_t threshold) const;
+
+    // One-line summary in milliseconds
+    void report(std::ostream &stream) const;
+
+
+    // Private attributes
+private:
+
+    const std::int64_t binWidth;
+
+    std::vector<std::uint64_t> bins;
+
+    std::uint64_t count;
+
+    double sum;
+    double sumSquares;
+
+    std::int64_t minimum;
+    std::int64_t maximum;
+
+    static const std::int64_t k_DefaultBinWidth = 100000;
+
+    static const size_t k_DefaultBinCount = 500;
+
+};
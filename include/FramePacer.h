@@ -0,0 +1,144 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <GL/glx.h>
+#include <cstdint>
+#include <deque>
+#include <time.h>
+
+#include "FrameHistogram.h"
+
+// Declaration of class FramePacer
+//
+// Presents frames at a steady rate. In timer mode each frame is held until
+// an absolute deadline on the monotonic clock, one period after the previous
+// deadline, by sleeping with clock_nanosleep(TIMER_ABSTIME) and spinning the
+// last fraction of a millisecond; deadlines never accumulate rounding, so the
+// rate does not drift. In vsync mode frames are locked to the display refresh,
+// scheduled on an exact refresh divisor through GLX_OML_sync_control where
+// available, else by the swap interval. Present-to-present intervals are kept
+// in a histogram as evidence of pacing quality.
+//
+// Each presented frame is also fenced, and the CPU is held back whenever
+// more than the configured number of frames are still queued on the GPU, so
+// the driver cannot buffer stale frames ahead of the display. Retired fences
+// yield an input-to-completion latency, measured from the time the frame's
+// input was sampled.
+//
+// Without a display, for offscreen rendering, frames are neither swapped nor
+// paced; they are only fenced, so that an unthrottled loop measures the
+// throughput of rendering rather than the depth of the driver's queue.
+class FramePacer {
+
+    // Constructor
+public:
+
+    // A null display paces offscreen frames, without throttling
+    FramePacer(Display *display, GLXDrawable drawable);
+
+
+    // Public interface methods
+public:
+
+    void setRate(float rate);
+
+    void setVsync(bool vsync);
+
+    // Periodically print the frame interval histogram to the console
+    void setReporting(bool reporting);
+
+    // Maximum frames queued on the GPU; zero leaves the driver unbounded
+    void setFramesInFlight(unsigned int frames);
+
+    // Record that input for the frame being built has just been sampled
+    void markInput();
+
+    // Wait for this frame's deadline, then swap buffers
+    void present();
+
+    const FrameHistogram& getHistogram() const;
+
+    const FrameHistogram& getLatencyHistogram() const;
+
+    float getRate() const;
+
+    bool getVsync() const;
+
+    static std::int64_t now();
+
+
+    // Private type definitions
+private:
+
+    typedef void (*glXSwapIntervalEXTProc)(Display*, GLXDrawable, int);
+    typedef int (*glXSwapIntervalMESAProc)(unsigned int);
+    typedef Bool (*glXGetSyncValuesOMLProc)(Display*, GLXDrawable,
+                                            std::int64_t*, std::int64_t*, std::int64_t*);
+    typedef Bool (*glXGetMscRateOMLProc)(Display*, GLXDrawable, std::int32_t*, std::int32_t*);
+    typedef std::int64_t (*glXSwapBuffersMscOMLProc)(Display*, GLXDrawable,
+                                                     std::int64_t, std::int64_t, std::int64_t);
+
+
+    // A presented frame still pending on the GPU
+    struct InFlight {
+        GLsync fence;
+        std::int64_t input;
+    };
+
+
+    // Private helper methods
+private:
+
+    void initExtensions();
+
+    void retireFrames();
+
+    void retire(const InFlight &frame);
+
+    void applySwapControl();
+
+    void waitUntil(std::int64_t deadline) const;
+
+    static timespec toTimespec(std::int64_t time);
+
+
+    // Private attributes
+private:
+
+    Display *display;
+    GLXDrawable drawable;
+
+    float rate;
+    bool vsync;
+    bool reporting;
+
+    std::int64_t period;
+    std::int64_t deadline;
+    std::int64_t lastPresent;
+    std::int64_t lastReport;
+
+    double refreshRate;
+    std::int64_t targetMsc;
+
+    FrameHistogram histogram;
+
+    unsigned int framesInFlight;
+    std::int64_t inputTime;
+    std::deque<InFlight> inFlight;
+    FrameHistogram latency;
+
+    glXSwapIntervalEXTProc glXSwapIntervalEXT;
+    glXSwapIntervalMESAProc glXSwapIntervalMESA;
+    glXGetSyncValuesOMLProc glXGetSyncValuesOML;
+    glXGetMscRateOMLProc glXGetMscRateOML;
+    glXSwapBuffersMscOMLProc glXSwapBuffersMscOML;
+
+    static const std::int64_t k_SpinTail;
+
+    static const std::int64_t k_ReportInterval;
+
+    static const GLuint64 k_FenceTimeout;
+
+    static const float k_MaxRate;
+
+};
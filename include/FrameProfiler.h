@@ -0,0 +1,255 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "PerfCounters.h"
+#include "SampleRing.h"
+
+// Declaration of class FrameProfiler
+//
+// Per-stage frame timing. CPU stages are timed by scoped timers, always, so
+// that the latest frame's record is available to a flight recorder; a GPU stage
+// is bracketed by GL_TIME_ELAPSED queries, double-buffered per stage and read
+// back only once available, so the render thread never waits on the GPU (a
+// GPU time is credited to the frame in which it becomes available, one or two
+// frames after it was measured). Each frame's times are pushed into a
+// lock-free ring, drained by a background thread which keeps rolling
+// statistics and periodically dumps them to a CSV or JSON file, and once more
+// when the profiler is destroyed.
+// While a trace is being recorded, CPU stages are also emitted as trace slices.
+// Optionally, scoped stages also collect per-stage performance counter deltas,
+// and other per-frame values, such as counts of OpenGL calls, are summarized
+// alongside the stages.
+class FrameProfiler {
+
+    // Public type definitions
+public:
+
+    static constexpr unsigned int k_MaxStages = 24;
+
+    static constexpr size_t k_MaxCounters = PerfCounters::k_MaxCounters;
+
+    static constexpr unsigned int k_MaxValues = 16;
+
+    // One frame's stage times in nanoseconds, performance counter deltas and
+    // other values; negative when not measured
+    struct FrameRecord {
+        std::uint64_t frame;
+        std::int64_t cpu[k_MaxStages];
+        std::int64_t gpu[k_MaxStages];
+        std::int64_t counters[k_MaxStages][k_MaxCounters];
+        std::int64_t values[k_MaxValues];
+    };
+
+    // Times a CPU stage for the lifetime of the scope
+    class Scope {
+    public:
+        Scope(FrameProfiler &profiler, unsigned int stage);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        FrameProfiler &profiler;
+        unsigned int stage;
+        bool counted;
+        std::uint64_t counts[k_MaxCounters];
+        std::int64_t start;
+    };
+
+    // Times a GPU stage for the lifetime of the scope; GPU scopes cannot nest
+    class GpuScope {
+    public:
+        GpuScope(FrameProfiler &profiler, unsigned int stage);
+        ~GpuScope();
+
+        GpuScope(const GpuScope&) = delete;
+        GpuScope& operator=(const GpuScope&) = delete;
+
+    private:
+        FrameProfiler &profiler;
+        bool active;
+    };
+
+
+    // Constructor / destructor
+public:
+
+    FrameProfiler();
+
+    ~FrameProfiler();
+
+
+    // Public interface methods
+public:
+
+    // Register a named stage, returning its index
+    unsigned int addStage(const std::string &name);
+
+    // Register a named per-frame value, in units which must be a string
+    // literal, returning its index
+    unsigned int addValue(const std::string &name, const char *unit);
+
+    // Set a value for the current frame
+    void setValue(unsigned int value, std::int64_t sample);
+
+    void setEnabled(bool enabled);
+
+    // Collect performance counters for scoped stages, where permitted
+    void setCounters(bool counters);
+
+    // Dump statistics to path every interval; ".json" paths are rewritten
+    // with the latest summary, any other path is appended to as CSV
+    void setDump(const std::string &path, float interval);
+
+    void beginFrame();
+
+    void endFrame();
+
+    // Close a CPU stage which began at start, also tracing it when enabled
+    void endStage(unsigned int stage, std::int64_t start);
+
+    bool beginGpu(unsigned int stage);
+
+    void endGpu();
+
+    bool getEnabled() const;
+
+    // The most recently completed frame
+    const FrameRecord& getLastFrame() const;
+
+    unsigned int getStageCount() const;
+
+    // Stage names may be read from the thread which registers stages
+    const std::string& getStageName(unsigned int stage) const;
+
+    size_t getCounterCount() const;
+
+    const char* getCounterName(size_t counter) const;
+
+    static std::int64_t now();
+
+
+    // Private type definitions
+private:
+
+    static constexpr unsigned int k_QueryBuffers = 2;
+
+    static constexpr size_t k_RingCapacity = 256;
+
+    static constexpr size_t k_Window = 1024;
+
+    // Double-buffered elapsed-time queries for one GPU stage
+    struct GpuTimer {
+        GLuint queries[k_QueryBuffers];
+        bool pending[k_QueryBuffers];
+        unsigned int next;
+    };
+
+    // Rolling window of one stage's samples, owned by the dump thread
+    struct Window {
+        std::vector<std::int64_t> samples;
+        size_t next;
+        unsigned long count;
+    };
+
+    // Summary statistics over a window, in the window's reporting unit
+    struct Summary {
+        size_t count;
+        double minimum;
+        double average;
+        double p50;
+        double p90;
+        double p99;
+        double maximum;
+    };
+
+
+    // Private helper methods
+private:
+
+    void collectGpu();
+
+    void addCounts(unsigned int stage, const std::uint64_t *begin);
+
+    void dump();
+
+    void accumulate(const FrameRecord &record);
+
+    void write(const std::string &path, std::uint64_t frame);
+
+    void writeSummary(std::ostream &file,
+                      bool json,
+                      bool &first,
+                      std::uint64_t frame,
+                      const std::string &stage,
+                      const char *source,
+                      const char *unit,
+                      double scale,
+                      const Window &window) const;
+
+    static void addSample(Window &window, std::int64_t sample);
+
+    static Summary summarize(const Window &window, double scale);
+
+
+    // Private attributes
+private:
+
+    bool enabled;
+
+    unsigned int stageCount;
+
+    FrameRecord current;
+    FrameRecord last;
+
+    std::uint64_t frame;
+
+    std::vector<GpuTimer> gpuTimers;
+    unsigned int activeGpu;
+
+    PerfCounters counters;
+    bool counting;
+    bool countersFailed;
+
+    SampleRing<FrameRecord, k_RingCapacity> ring;
+
+    unsigned int valueCount;
+
+    // Shared with the dump thread, under wakeMutex
+    std::vector<std::string> stageNames;
+    std::vector<std::string> valueNames;
+    std::vector<const char*> valueUnits;
+    std::string dumpPath;
+    std::chrono::milliseconds dumpInterval;
+    bool running;
+
+    // Owned by the dump thread; the last frame accumulated but not yet
+    // written, if any, for the final summary
+    bool undumped;
+    std::uint64_t undumpedFrame;
+    std::vector<Window> cpuWindows;
+    std::vector<Window> gpuWindows;
+    std::vector<Window> counterWindows;
+    std::vector<Window> valueWindows;
+    std::vector<const char*> counterNames;
+
+    std::mutex wakeMutex;
+
+    std::condition_variable wake;
+
+    std::thread dumper;
+
+    static const unsigned int k_NoStage;
+
+};
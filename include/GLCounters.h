@@ -0,0 +1,74 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <array>
+#include <cstdint>
+
+// Declaration of class GLCounters
+//
+// Optional instrumentation shim over the OpenGL entry points Florb calls
+// each frame: uniform setters, buffer and texture uploads, binds, clears and
+// draws, and also program deletion, which forgets the deleted program's
+// uniforms. While enabled, GLEW's function pointers for these are swapped
+// for counting wrappers which forward to the driver; disabling swaps the
+// driver's back, so that nothing is paid when counting is off. The OpenGL
+// 1.1 entry points, which GLEW does not load, are wrapped at link time
+// instead, and only check whether counting is enabled. Each frame's calls,
+// bytes uploaded and redundant state changes (binds of what is already
+// bound, and uniforms set to the values they already hold) are tallied.
+// Bound state is tracked only from the intercepted calls, so is forgotten
+// whenever counting is enabled. All counting is on the thread which enabled
+// it, the render thread; calls from any other, such as the shader compile
+// thread deleting a program which failed to link, pass through uncounted.
+class GLCounters {
+
+    // Public type definitions
+public:
+
+    enum Count {
+        CALLS,
+        UNIFORMS,
+        BINDS,
+        DRAWS,
+        CLEARS,
+        BUFFER_UPLOADS,
+        TEXTURE_UPLOADS,
+        UPLOAD_BYTES,
+        REDUNDANT,
+        MAX_COUNTS
+    };
+
+    typedef std::array<std::uint64_t, MAX_COUNTS> Counts;
+
+
+    // Public interface methods
+public:
+
+    // Enable once GLEW is initialized, with a context current
+    static void setEnabled(bool enabled);
+
+    static bool isEnabled();
+
+    // The counts since the last call, normally one frame's
+    static Counts endFrame();
+
+    // Names as reported, such as "gl_calls", and their units
+    static const char* getName(Count count);
+
+    static const char* getUnit(Count count);
+
+
+    // Private helper methods
+private:
+
+    static void reset();
+
+
+    // Private attributes
+private:
+
+    static bool enabled;
+
+    static const char *const k_Names[MAX_COUNTS];
+
+};
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <atomic>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Declaration of class GLDebug
+//
+// OpenGL error reporting without a glGetError round trip after each call.
+// Where the driver offers GL_KHR_debug, its messages arrive through a
+// callback, which may be called on a driver thread, and are queued for the
+// render thread to report once a frame. Passes are named with debug groups,
+// and objects with labels, so that external profilers and frame captures
+// show them by name. Synchronous checking, in which the driver reports each
+// message within the call which caused it, is kept for debugging; without
+// the callback, FlorbUtils::glCheck polls glGetError after each call instead,
+// so that each error is reported once. Without GL_KHR_debug, or with debug
+// output disabled, errors are polled once a frame instead.
+class GLDebug {
+
+    // Public type definitions
+public:
+
+    // A debug group, named in captures, for the lifetime of the object
+    class Group {
+    public:
+        Group(const char *name);
+        ~Group();
+    };
+
+
+    // Public interface methods
+public:
+
+    // Install the message callback once GLEW is initialized, with a context
+    // current; one created as a debug context where enabled
+    static void initialize(bool enabled);
+
+    static bool isAvailable();
+
+    static void setSynchronous(bool synchronous);
+
+    static bool isSynchronous();
+
+    // Report the messages queued since the last call, on the render thread
+    static void flush();
+
+    // Name an object, such as a GL_TEXTURE or GL_BUFFER, in captures
+    static void label(GLenum identifier, GLuint name, const std::string &text);
+
+    // OpenGL errors reported to the callback, or polled by flush()
+    static unsigned long getErrorCount();
+
+
+    // Private type definitions
+private:
+
+    struct Message {
+        GLenum source;
+        GLenum type;
+        GLuint id;
+        GLenum severity;
+        std::string text;
+    };
+
+
+    // Private helper methods
+private:
+
+    static void APIENTRY callback(GLenum source,
+                                  GLenum type,
+                                  GLuint id,
+                                  GLenum severity,
+                                  GLsizei length,
+                                  const GLchar *message,
+                                  const void *userParam);
+
+    static void report(const Message &message);
+
+
+    // Private attributes
+private:
+
+    static bool available;
+
+    // Read by the callback, which may be on a driver thread
+    static std::atomic<bool> synchronous;
+
+    static std::mutex queueMutex;
+
+    static std::vector<Message> queue;
+
+    static unsigned long dropped;
+
+    static std::atomic<unsigned long> errors;
+
+    // Times each message has been reported, by id
+    static std::map<GLuint, unsigned long> reported;
+
+    static const std::size_t k_MaxQueued;
+
+    static const unsigned long k_MaxRepeats;
+
+};
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <EGL/egl.h>
+
+// Declaration of class HeadlessContext
+//
+// An OpenGL 3.3 core context with no window and no X server, created through
+// EGL. The surfaceless platform (EGL_MESA_platform_surfaceless) is preferred,
+// rendering only into framebuffer objects; otherwise the default display is
+// used, with a pbuffer surface of the frame size where surfaceless contexts
+// are not supported. The context is made current on the constructing thread.
+class HeadlessContext {
+
+    // Constructor / destructor
+public:
+
+    // Throws runtime_error when no suitable context can be created; a debug
+    // context is requested where asked for, and where EGL supports one
+    HeadlessContext(int width, int height, bool debug);
+
+    ~HeadlessContext();
+
+    HeadlessContext(const HeadlessContext&) = delete;
+    HeadlessContext& operator=(const HeadlessContext&) = delete;
+
+
+    // Public interface methods
+public:
+
+    // True when rendering without any EGL surface
+    bool isSurfaceless() const;
+
+    const char* getVendor() const;
+
+
+    // Private helper methods
+private:
+
+    void release();
+
+    static EGLDisplay openDisplay();
+
+    static bool hasExtension(const char *extensions, const char *name);
+
+
+    // Private attributes
+private:
+
+    EGLDisplay display;
+
+    EGLContext context;
+
+    EGLSurface surface;
+
+};
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// Declaration of class KeyframeCurve
+//
+// A scalar parameter curve passing smoothly through (time, value) keyframes,
+// as a Catmull-Rom spline. The spline is baked once into a table of uniformly
+// spaced cubic segments, so each evaluation is one table lookup and a short
+// polynomial rather than a search over keyframes. Looping curves repeat over
+// the span of their keyframes, wrapping integer time so that long uptimes do
+// not lose precision.
+class KeyframeCurve {
+
+    // Public type definitions
+public:
+
+    typedef std::pair<float, float> Keyframe;
+
+
+    // Constructor
+public:
+
+    // Throws if there are no keyframes, or their times do not increase
+    explicit KeyframeCurve(const std::vector<Keyframe> &keyframes,
+                           bool loop = true,
+                           size_t resolution = k_DefaultResolution);
+
+
+    // Public interface methods
+public:
+
+    float evaluate(float seconds) const;
+
+    float evaluate(std::chrono::nanoseconds time) const;
+
+    float getDuration() const;
+
+
+    // Private type definitions
+private:
+
+    // Cubic over one table segment, in its local parameter u in [0, 1]
+    struct Segment {
+        float a;
+        float b;
+        float c;
+        float d;
+    };
+
+
+    // Private helper methods
+private:
+
+    float tangent(size_t index) const;
+
+    float spline(float time, bool leftSide, float &slope) const;
+
+
+    // Private attributes
+private:
+
+    std::vector<Keyframe> keyframes;
+
+    std::vector<float> tangents;
+
+    std::vector<Segment> table;
+
+    const bool loop;
+
+    float start;
+    float duration;
+    float scale;
+
+    std::chrono::nanoseconds period;
+
+    static const size_t k_DefaultResolution = 1024;
+
+};
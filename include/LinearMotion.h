@@ -1,6 +1,8 @@
+#pragma once
+
 #include "MultiMotion.h"
 
-class LinearMotion : public MultiMotion {
+class LinearMotion final : public MultiMotion {
 public:
   
     LinearMotion(bool enabled, float offset, float speed);
@@ -9,7 +11,11 @@ public:
                  const std::vector<float> &offsets,
                  const std::vector<float> &speeds);
 
-    virtual std::vector<float> vectorEvaluate(float time) const override;
+    using MultiMotion::evaluate;
+
+    void evaluate(float time, float *results, size_t count) const override;
+
+    size_t getDimensions() const override;
 
 private:
     std::vector<float> offsets;
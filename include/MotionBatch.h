@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <variant>
+#include <vector>
+
+// Declaration of class template MotionBatch
+//
+// A contiguous collection of scalar motions whose concrete types are fixed at
+// compile time. Every motion is evaluated for one timestamp in a single call,
+// dispatching through std::visit rather than virtual calls on shared pointers,
+// and writing into caller-provided storage without allocating.
+template <typename... Motions>
+class MotionBatch {
+
+    // Public type definitions
+public:
+
+    using Motion = std::variant<Motions...>;
+
+
+    // Public interface methods
+public:
+
+    void reserve(size_t count) {
+        motions.reserve(count);
+    }
+
+    // Append a motion, returning its index within the batch
+    size_t add(const Motion &motion) {
+        motions.push_back(motion);
+
+        return (motions.size() - 1);
+    }
+
+    Motion& get(size_t index) {
+        return motions[index];
+    }
+
+    const Motion& get(size_t index) const {
+        return motions[index];
+    }
+
+    size_t size() const {
+        return motions.size();
+    }
+
+    void clear() {
+        motions.clear();
+    }
+
+    // Evaluate the first count motions at the given time
+    void evaluate(float time, float *results, size_t count) const {
+        if (count > motions.size()) count = motions.size();
+
+        for (size_t i = 0; i < count; i++) {
+            results[i] = std::visit([time](const auto &motion) {
+                                        return motion.evaluate(time);
+                                    },
+                                    motions[i]);
+        }
+    }
+
+
+    // Private attributes
+private:
+
+    std::vector<Motion> motions;
+
+};
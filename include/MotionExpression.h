@@ -0,0 +1,125 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Declaration of class MotionExpression
+//
+// A scalar motion described as an arithmetic expression of the time variable
+// "t", e.g. "0.1 * impulse(t, 2.0, 4.0) + 0.02 * noise(t * 3.0)". Expressions
+// are parsed once, constant-folded and compiled into flat stack bytecode for
+// evaluation on the CPU, and may also be emitted as GLSL for the shaders.
+//
+// Operators : + - * / ^ (power), unary -, parentheses
+// Constants : pi, numeric literals
+// Functions : sin cos tan abs exp log sqrt floor fract noise
+//             min max mod pow step impulse(t, period, decay)
+//             clamp mix smoothstep
+class MotionExpression {
+
+    // Constructor
+public:
+
+    explicit MotionExpression(const std::string &source);
+
+
+    // Public interface methods
+public:
+
+    float evaluate(float time) const;
+
+    // Evaluate at many times at once, in lane-blocked vectorizable passes
+    void evaluate(const float *times, float *results, size_t count) const;
+
+    const std::string& getSource() const;
+
+    size_t getInstructionCount() const;
+
+    std::string toGLSL(const std::string &timeName) const;
+
+    static std::string glslFunctions();
+
+
+    // Private type definitions
+private:
+
+    // Bytecode operations, ordered by arity
+    enum class Op : std::uint8_t {
+        CONSTANT, TIME,
+        NEG, SIN, COS, TAN, ABS, EXP, LOG, SQRT, FLOOR, FRACT, NOISE,
+        ADD, SUB, MUL, DIV, POW, MIN, MAX, MOD, STEP,
+        IMPULSE, CLAMP, MIX, SMOOTHSTEP
+    };
+
+    // One flat bytecode instruction; operand indexes the constant pool
+    struct Instruction {
+        Op op;
+        std::uint32_t operand;
+    };
+
+    // Parsed expression tree, used only while compiling; position is the
+    // operator's or function's, for errors found while folding
+    struct Node {
+        Op op;
+        float value;
+        std::vector<Node> args;
+        size_t position = 0;
+    };
+
+    // Named function signature
+    struct Function {
+        const char *name;
+        Op op;
+        unsigned int arity;
+        const char *glslName;
+    };
+
+
+    // Private helper methods
+private:
+
+    Node parseSum(size_t &position) const;
+    Node parseProduct(size_t &position) const;
+    Node parsePower(size_t &position) const;
+    Node parseUnary(size_t &position) const;
+    Node parsePrimary(size_t &position) const;
+
+    void skipSpace(size_t &position) const;
+
+    [[noreturn]] void fail(size_t position, const std::string &reason) const;
+
+    Node fold(Node node) const;
+
+    void emit(const Node &node, unsigned int depth);
+
+    std::string emitGLSL(const Node &node, const std::string &timeName) const;
+
+    static unsigned int arity(Op op);
+
+    static float apply(Op op, const float *args);
+
+    static float noise(float x);
+
+
+    // Private attributes
+private:
+
+    const std::string source;
+
+    Node tree;
+
+    std::vector<Instruction> code;
+
+    std::vector<float> constants;
+
+    unsigned int maxDepth;
+
+    static const Function k_Functions[];
+
+    static constexpr size_t k_MaxDepth = 32;
+
+    static constexpr size_t k_Lanes = 8;
+
+};
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <vector>
 
 #include "MotionAlgorithm.h"
@@ -12,7 +13,15 @@ public:
     
     virtual float evaluate(float time) const;
 
-    virtual std::vector<float> vectorEvaluate(float time) const = 0;
+    // Write up to count components into caller-provided storage
+    virtual void evaluate(float time, float *results, size_t count) const = 0;
+
+    virtual size_t getDimensions() const = 0;
+
+    std::vector<float> vectorEvaluate(float time) const;
+
+protected:
+    static const size_t k_MaxStackDimensions = 4;
 
 private:
     bool enabled;
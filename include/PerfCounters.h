@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Declaration of class PerfCounters
+//
+// A group of performance counters on the calling thread, opened through
+// perf_event_open and read together in one system call, so that every
+// counter covers exactly the same span of execution. Hardware counters
+// (instructions, cycles, cache and branch misses) are preferred; where they
+// are unavailable, as is common in containers and virtual machines, software
+// counters (page faults, context switches, migrations) are used instead.
+// Hardware counts exclude the kernel and hypervisor. A group which shares the
+// PMU with others is multiplexed, and its counts scaled up from the time it
+// ran to the time it was enabled; one which the PMU can never fit falls back
+// to the software counters.
+class PerfCounters {
+
+    // Constructor / destructor
+public:
+
+    PerfCounters();
+
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+
+    // Public interface methods
+public:
+
+    // Open and start the counter group; false when no counters are available
+    bool open();
+
+    void close();
+
+    bool isOpen() const;
+
+    bool isHardware() const;
+
+    size_t getCount() const;
+
+    const char* getName(size_t counter) const;
+
+    // Read the running totals of every counter into values, scaled when
+    // multiplexed; false when unavailable, or never yet scheduled
+    bool read(std::uint64_t *values) const;
+
+    static constexpr size_t k_MaxCounters = 4;
+
+
+    // Private type definitions
+private:
+
+    struct Counter {
+        std::uint32_t type;
+        std::uint64_t config;
+        const char *name;
+    };
+
+
+    // Private helper methods
+private:
+
+    bool openGroup(const Counter *counters, size_t count);
+
+    // Whether the open group has yet run on the PMU at all
+    bool isScheduled() const;
+
+    static int openCounter(const Counter &counter, int group);
+
+
+    // Private attributes
+private:
+
+    int descriptors[k_MaxCounters];
+
+    size_t count;
+
+    const char *names[k_MaxCounters];
+
+    bool hardware;
+
+    // Reads are on the counting thread, which is warned once of multiplexing
+    mutable bool multiplexed;
+
+    static const Counter k_HardwareCounters[];
+
+    static const Counter k_SoftwareCounters[];
+
+};
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Declaration of class PhysicsWorld
+//
+// Stateful motion for effects which cannot be written as a function of time,
+// such as a viscous bounce excited by an impulse train. Each body is a scalar
+// damped spring; bodies are held as parallel arrays and advanced together by
+// a fixed-timestep, semi-implicit Euler integrator which is decoupled from the
+// render rate. Positions are read back interpolated between the last two
+// steps, so output is smooth and the integration identical at any frame rate.
+class PhysicsWorld {
+
+    // Public type definitions
+public:
+
+    // Parameters of one scalar body
+    struct Body {
+        float rest = 0.0f;       // Spring rest position
+        float stiffness = 0.0f;  // Spring constant, in 1/s^2
+        float damping = 0.0f;    // Linear drag coefficient, in 1/s
+        float drag = 0.0f;       // Speed-proportional drag coefficient
+        float impulse = 0.0f;    // Velocity kick applied by each impulse
+        float period = 0.0f;     // Impulse train period in seconds, zero for none
+    };
+
+
+    // Constructor
+public:
+
+    explicit PhysicsWorld(float stepRate = k_DefaultStepRate);
+
+
+    // Public interface methods
+public:
+
+    // Add a body at rest, returning its index
+    size_t addBody(const Body &body);
+
+    void setBody(size_t index, const Body &body);
+
+    // Apply an instantaneous change of velocity
+    void kick(size_t index, float velocity);
+
+    // Run as many fixed steps as the elapsed time affords
+    void advance(float elapsed);
+
+    // Position interpolated between the last two steps
+    float getPosition(size_t index) const;
+
+    void interpolate(float *results, size_t count) const;
+
+    size_t size() const;
+
+    float getStepSeconds() const;
+
+
+    // Private helper methods
+private:
+
+    void step();
+
+
+    // Private attributes
+private:
+
+    const float stepSeconds;
+
+    float accumulator;
+    float alpha;
+
+    std::vector<float> positions;
+    std::vector<float> previous;
+    std::vector<float> velocities;
+    std::vector<float> phases;
+
+    std::vector<float> rests;
+    std::vector<float> stiffnesses;
+    std::vector<float> dampings;
+    std::vector<float> drags;
+    std::vector<float> impulses;
+    std::vector<float> periods;
+
+    static const float k_DefaultStepRate;
+
+    static const unsigned int k_MaxSteps;
+
+};
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+// Declaration of class ResourceMonitor
+//
+// Periodic record of what a long run holds on to, for soak testing: the
+// process's resident set size, the number of live OpenGL objects of each
+// kind, the bytes held by live textures, and the average and longest frame
+// time since the previous sample. Samples are taken on animation time, so
+// that an accelerated or fixed clock samples every simulated hour rather
+// than every real one, and appended as rows to a CSV file. OpenGL objects
+// are counted by asking the driver which names are live, rather than by
+// trusting Florb's own bookkeeping, so that leaks anywhere are seen.
+class ResourceMonitor {
+
+    // Public type definitions
+public:
+
+    // One sample of the resources held
+    struct Sample {
+        long rssKb;
+        long textures;
+        long textureKb;
+        long buffers;
+        long vertexArrays;
+        long framebuffers;
+        long renderbuffers;
+        long programs;
+        long shaders;
+        long queries;
+    };
+
+
+    // Constructor / destructor
+public:
+
+    ResourceMonitor();
+
+    ResourceMonitor(const ResourceMonitor&) = delete;
+    ResourceMonitor& operator=(const ResourceMonitor&) = delete;
+
+
+    // Public interface methods
+public:
+
+    // Samples are appended to path; a change of path starts a new file
+    void setPath(const std::string &path);
+
+    // Seconds of animation time between samples
+    void setInterval(float seconds);
+
+    // Account for a frame of the given duration in nanoseconds
+    void addFrame(std::int64_t duration);
+
+    // Sample once the interval has passed since the last sample
+    void update(std::uint64_t frame, double seconds);
+
+    // Measure the resources held now; the OpenGL context must be current
+    Sample measure();
+
+
+    // Private helper methods
+private:
+
+    // Count live names of one kind of object, from the lowest upwards
+    long countNames(GLboolean (*isName)(GLuint), GLuint probe, GLuint &highest);
+
+    // Bytes held by every mip level of a live 2D texture
+    static std::int64_t textureBytes(GLuint texture);
+
+    static long residentKb();
+
+
+    // Private attributes
+private:
+
+    std::string path;
+    std::ofstream file;
+
+    double interval;
+    double nextSample;
+
+    unsigned long frames;
+    std::int64_t frameTotal;
+    std::int64_t frameLongest;
+
+    // The highest live name of each kind seen, bounding the next search
+    GLuint highestTexture;
+    GLuint highestBuffer;
+    GLuint highestVertexArray;
+    GLuint highestFramebuffer;
+    GLuint highestRenderbuffer;
+    GLuint highestShader;
+    GLuint highestQuery;
+
+    static const GLuint k_MinimumSearch;
+
+};
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+// Declaration of class template SampleRing
+//
+// Bounded single-producer, single-consumer ring of fixed-size records. The
+// producer never blocks or allocates; when the consumer falls behind, new
+// records are dropped and counted rather than overwriting unread ones. Each
+// index is written by only one side, so a pair of acquire/release atomics is
+// all the synchronization required.
+template <typename T, size_t Capacity>
+class SampleRing {
+
+    static_assert((Capacity & (Capacity - 1)) == 0,
+                  "SampleRing capacity must be a power of two");
+
+    // Constructor
+public:
+
+    SampleRing() :
+        head(0U),
+        tail(0U),
+        dropped(0UL) { }
+
+    SampleRing(const SampleRing&) = delete;
+    SampleRing& operator=(const SampleRing&) = delete;
+
+
+    // Public interface methods
+public:
+
+    // Producer side; returns false when the record was dropped
+    bool push(const T &record) {
+        auto h(head.load(std::memory_order_relaxed));
+
+        if ((h - tail.load(std::memory_order_acquire)) >= Capacity) {
+            dropped.fetch_add(1UL, std::memory_order_relaxed);
+            return false;
+        }
+
+        records[h & (Capacity - 1)] = record;
+        head.store((h + 1U), std::memory_order_release);
+
+        return true;
+    }
+
+    // Consumer side; returns false when the ring is empty
+    bool pop(T &record) {
+        auto t(tail.load(std::memory_order_relaxed));
+
+        if (t == head.load(std::memory_order_acquire)) return false;
+
+        record = records[t & (Capacity - 1)];
+        tail.store((t + 1U), std::memory_order_release);
+
+        return true;
+    }
+
+    // Number of records dropped because the ring was full
+    unsigned long getDropped() const {
+        return dropped.load(std::memory_order_relaxed);
+    }
+
+
+    // Private attributes
+private:
+
+    std::atomic<size_t> head;
+    std::atomic<size_t> tail;
+    std::atomic<unsigned long> dropped;
+
+    T records[Capacity];
+
+};
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+
+// Declaration of class template SeqLock
+//
+// Sequence lock over a small, trivially copyable value. Readers never block
+// and never write shared memory; they copy the value and retry if a writer
+// was active meanwhile. Writers are serialized among themselves, but never
+// wait on readers. The value is held as atomic words, so a torn copy which
+// is about to be discarded is still free of data races.
+template <typename T>
+class SeqLock {
+
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "SeqLock requires a trivially copyable value type");
+
+    // Constructor
+public:
+
+    explicit SeqLock(const T &value = T()) :
+        sequence(0U) {
+        store(value);
+    }
+
+    SeqLock(const SeqLock&) = delete;
+    SeqLock& operator=(const SeqLock&) = delete;
+
+
+    // Public interface methods
+public:
+
+    // Return a consistent copy of the value
+    T load() const {
+        std::uint32_t image[k_Words];
+
+        while (true) {
+            auto before(sequence.load(std::memory_order_acquire));
+
+            if ((before & 1U) == 0U) {
+                for (size_t i = 0; i < k_Words; i++) {
+                    image[i] = words[i].load(std::memory_order_relaxed);
+                }
+
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (sequence.load(std::memory_order_relaxed) == before) break;
+            }
+
+            std::this_thread::yield();
+        }
+
+        return fromImage(image);
+    }
+
+    // Replace the value
+    void write(const T &value) {
+        auto begun(begin());
+        store(value);
+        end(begun);
+    }
+
+    // Read-modify-write the value through a callable taking T&
+    template <typename F>
+    void modify(F mutator) {
+        auto begun(begin());
+
+        std::uint32_t image[k_Words];
+        for (size_t i = 0; i < k_Words; i++) {
+            image[i] = words[i].load(std::memory_order_relaxed);
+        }
+
+        T value(fromImage(image));
+        mutator(value);
+        store(value);
+
+        end(begun);
+    }
+
+    // Number of completed writes
+    unsigned int getWrites() const {
+        return (sequence.load(std::memory_order_acquire) / 2U);
+    }
+
+
+    // Private helper methods
+private:
+
+    // Claim exclusive write access by moving the sequence to an odd value
+    unsigned int begin() {
+        auto current(sequence.load(std::memory_order_relaxed));
+
+        while (((current & 1U) != 0U) or
+               !sequence.compare_exchange_weak(current,
+                                               (current + 1U),
+                                               std::memory_order_acquire,
+                                               std::memory_order_relaxed)) {
+            if ((current & 1U) != 0U) {
+                std::this_thread::yield();
+                current = sequence.load(std::memory_order_relaxed);
+            }
+        }
+
+        // Order the odd sequence ahead of the value stores which follow
+        std::atomic_thread_fence(std::memory_order_release);
+
+        return current;
+    }
+
+    void end(unsigned int begun) {
+        sequence.store((begun + 2U), std::memory_order_release);
+    }
+
+    void store(const T &value) {
+        std::uint32_t image[k_Words] = {};
+        std::memcpy(image, &value, sizeof(T));
+
+        for (size_t i = 0; i < k_Words; i++) {
+            words[i].store(image[i], std::memory_order_relaxed);
+        }
+    }
+
+    static T fromImage(const std::uint32_t *image) {
+        T value;
+        std::memcpy(static_cast<void*>(&value), image, sizeof(T));
+
+        return value;
+    }
+
+
+    // Private attributes
+private:
+
+    static constexpr size_t k_Words = ((sizeof(T) + sizeof(std::uint32_t) - 1) /
+                                       sizeof(std::uint32_t));
+
+    std::atomic<unsigned int> sequence;
+
+    std::atomic<std::uint32_t> words[k_Words];
+
+};
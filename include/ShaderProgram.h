@@ -0,0 +1,130 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <GL/glx.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Class forward references
+class FileWatcher;
+
+
+// Declaration of class ShaderProgram
+//
+// Owns the linked shader program built from a vertex / fragment source file
+// pair. When hot reload is enabled the source files are watched, and edits
+// are recompiled in the background; the live program is only replaced once
+// the new one links successfully, so rendering never stalls or goes dark.
+class ShaderProgram {
+
+    // Constructor / destructor
+public:
+
+    ShaderProgram(const std::string &vertexPath,
+                  const std::string &fragmentPath,
+                  bool hotReload);
+
+    ~ShaderProgram();
+
+
+    // Public interface methods
+public:
+
+    void build();
+
+    bool update();
+
+    // Source injected after the #version line of both stages, rebuilding on change
+    void setPrelude(const std::string &p);
+
+    // Whether the live program was built with the prelude last set; until
+    // then it may be one built with an earlier prelude, or none
+    bool isPreludeLive() const;
+
+    GLuint getProgram() const;
+
+    unsigned int getGeneration() const;
+
+
+    // Private type definitions
+private:
+
+    // Enumerated type for background compilation strategy
+    enum class CompileMode { SYNCHRONOUS, PARALLEL, THREAD };
+
+    // Shader and program objects of one in-flight build
+    struct Build {
+        GLuint program = 0;
+        GLuint vertexShader = 0;
+        GLuint fragmentShader = 0;
+    };
+
+
+    // Private helper methods
+private:
+
+    static std::string readSource(const std::string &path);
+
+    std::string loadSource(const std::string &path) const;
+
+    static Build startBuild(const std::string &vertexSource,
+                            const std::string &fragmentSource);
+
+    static bool finishBuild(Build &build);
+
+    bool isComplete(const Build &build) const;
+
+    void initCompileMode();
+
+    bool initCompileThread();
+
+    void compileLoop();
+
+    void requestBuild();
+
+    void swap(GLuint linked);
+
+
+    // Private attributes
+private:
+
+    const std::string vertexPath;
+    const std::string fragmentPath;
+
+    std::string prelude;
+    bool preludeChanged;
+    std::string buildPrelude;
+    std::string livePrelude;
+
+    GLuint program;
+    unsigned int generation;
+
+    CompileMode compileMode;
+
+    std::shared_ptr<FileWatcher> watcher;
+    unsigned int watchedGeneration;
+
+    Build pending;
+    bool building;
+
+    Display *threadDisplay;
+    GLXContext threadContext;
+    std::thread compiler;
+    std::mutex compileMutex;
+    std::condition_variable compileWake;
+    bool compileRunning;
+    bool compileRequested;
+    std::string requestedVertex;
+    std::string requestedFragment;
+    GLuint compiledProgram;
+    std::atomic<bool> compileDone;
+    std::atomic<bool> compileFailed;
+
+    static const std::chrono::milliseconds k_WatchInterval;
+
+};
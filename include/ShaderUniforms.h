@@ -0,0 +1,269 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Class forward references
+class ShaderProgram;
+class ShaderUniforms;
+
+
+// Declaration of class template Uniform
+//
+// Typed handle onto one default-block uniform of a ShaderUniforms instance.
+// Handles remain valid across shader hot reloads.
+template <typename T>
+class Uniform {
+
+    // Constructors
+public:
+
+    Uniform() :
+        uniforms(nullptr),
+        slot(0) { }
+
+    Uniform(ShaderUniforms *uniforms, size_t slot) :
+        uniforms(uniforms),
+        slot(slot) { }
+
+
+    // Public interface methods
+public:
+
+    void set(const T &value) const;
+
+
+    // Private attributes
+private:
+
+    ShaderUniforms *uniforms;
+
+    size_t slot;
+
+};
+
+
+// Declaration of class UniformBuffer
+//
+// A std140 uniform buffer object mirrored by a CPU-side byte image. Only the
+// byte range which differs from the last upload is sent to the GPU.
+class UniformBuffer {
+
+    // Constructor / destructor
+public:
+
+    UniformBuffer(const std::string &name, GLuint binding, size_t size);
+
+    virtual ~UniformBuffer();
+
+
+    // Public interface methods
+public:
+
+    const std::string& getName() const;
+
+    GLuint getBinding() const;
+
+    bool bind(GLuint program);
+
+    bool upload(const void *data);
+
+    void invalidate();
+
+    unsigned int takeUploads();
+
+
+    // Private attributes
+private:
+
+    const std::string name;
+
+    const GLuint binding;
+
+    const size_t size;
+
+    GLuint buffer;
+
+    std::vector<unsigned char> shadow;
+
+    bool valid;
+
+    unsigned int uploads;
+
+};
+
+
+// Declaration of class template UniformBlock
+template <typename T>
+class UniformBlock : public UniformBuffer {
+
+    // Constructor
+public:
+
+    UniformBlock(const std::string &name, GLuint binding) :
+        UniformBuffer(name, binding, sizeof(T)),
+        data() { }
+
+
+    // Public interface methods
+public:
+
+    T& edit() { return data; }
+
+    const T& get() const { return data; }
+
+    bool upload() { return UniformBuffer::upload(&data); }
+
+
+    // Private attributes
+private:
+
+    T data;
+
+};
+
+
+// Declaration of class ShaderUniforms
+//
+// Reflects the active uniforms and uniform blocks of a linked shader program,
+// resolving typed handles by name and suppressing redundant uploads. The
+// number of GL uniform calls issued each frame is tallied for reporting.
+class ShaderUniforms {
+
+    // Constructor
+public:
+
+    explicit ShaderUniforms(std::shared_ptr<ShaderProgram> shaders);
+
+
+    // Public interface methods
+public:
+
+    template <typename T>
+    Uniform<T> get(const std::string &name);
+
+    template <typename T>
+    std::shared_ptr<UniformBlock<T>> getBlock(const std::string &name);
+
+    bool update();
+
+    void endFrame();
+
+    unsigned int getFrameCalls() const;
+
+    unsigned int getFrameUploads() const;
+
+
+    // Typed setters invoked through Uniform handles
+public:
+
+    void set(size_t slot, GLint value);
+    void set(size_t slot, GLfloat value);
+    void set(size_t slot, const glm::vec2 &value);
+    void set(size_t slot, const glm::vec3 &value);
+    void set(size_t slot, const glm::mat4 &value);
+
+
+    // Private type definitions
+private:
+
+    // An active uniform reported by the linked program
+    struct Active {
+        std::string name;
+        GLenum type;
+        GLint size;
+        GLint location;
+    };
+
+    // A requested default-block uniform and its last uploaded value
+    struct Slot {
+        std::string name;
+        GLenum expectedType;
+        GLint location;
+        bool cached;
+        std::vector<unsigned char> value;
+    };
+
+
+    // Private helper methods
+private:
+
+    void reflect();
+
+    size_t addSlot(const std::string &name, GLenum expectedType);
+
+    void resolve(Slot &slot);
+
+    bool unchanged(Slot &slot, const void *value, size_t size);
+
+
+    // Private attributes
+private:
+
+    std::shared_ptr<ShaderProgram> shaders;
+
+    GLuint program;
+
+    unsigned int generation;
+
+    std::vector<Active> actives;
+
+    std::vector<Slot> slots;
+
+    std::vector<std::shared_ptr<UniformBuffer>> blocks;
+
+    unsigned int frameCalls;
+
+    unsigned int lastFrameCalls;
+    unsigned int lastFrameUploads;
+
+};
+
+
+// Template implementations
+
+template <typename T>
+void Uniform<T>::set(const T &value) const {
+    if (uniforms) uniforms->set(slot, value);
+}
+
+template <>
+inline Uniform<GLint> ShaderUniforms::get<GLint>(const std::string &name) {
+    return Uniform<GLint>(this, addSlot(name, GL_INT));
+}
+
+template <>
+inline Uniform<GLfloat> ShaderUniforms::get<GLfloat>(const std::string &name) {
+    return Uniform<GLfloat>(this, addSlot(name, GL_FLOAT));
+}
+
+template <>
+inline Uniform<glm::vec2> ShaderUniforms::get<glm::vec2>(const std::string &name) {
+    return Uniform<glm::vec2>(this, addSlot(name, GL_FLOAT_VEC2));
+}
+
+template <>
+inline Uniform<glm::vec3> ShaderUniforms::get<glm::vec3>(const std::string &name) {
+    return Uniform<glm::vec3>(this, addSlot(name, GL_FLOAT_VEC3));
+}
+
+template <>
+inline Uniform<glm::mat4> ShaderUniforms::get<glm::mat4>(const std::string &name) {
+    return Uniform<glm::mat4>(this, addSlot(name, GL_FLOAT_MAT4));
+}
+
+template <typename T>
+std::shared_ptr<UniformBlock<T>> ShaderUniforms::getBlock(const std::string &name) {
+    auto block(std::make_shared<UniformBlock<T>>(name, static_cast<GLuint>(blocks.size())));
+
+    blocks.push_back(block);
+    if (program != 0) {
+        block->bind(program);
+        frameCalls++;
+    }
+
+    return block;
+}
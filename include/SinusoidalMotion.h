@@ -1,6 +1,8 @@
+#pragma once
+
 #include "MotionAlgorithm.h"
 
-class SinusoidalMotion : public MotionAlgorithm {
+class SinusoidalMotion final : public MotionAlgorithm {
 public:
 
     SinusoidalMotion();
@@ -1,15 +1,26 @@
 #pragma once
 
+#include <glm/glm.hpp>
 #include <memory>
-#include <mutex>
 #include <string>
 #include <vector>
 
+#include "SeqLock.h"
+
 // Class forward references
-class LinearMotion;
+class MultiMotion;
 
 class Spotlight {
 
+public:
+
+    // Consistent copy of the mutable spotlight state
+    struct State {
+        glm::vec3 direction;
+        float intensity;
+        glm::vec3 color;
+    };
+
 public:
 
     // Constructors
@@ -22,17 +33,19 @@ public:
               const std::vector<float> &direction,
               float intensity,
               const std::vector<float> &color,
-              std::shared_ptr<LinearMotion> linear);
+              std::shared_ptr<MultiMotion> motion);
 
 public:
 
-    const std::vector<float>& getDirection() const;
+    State getState() const;
+
+    glm::vec3 getDirection() const;
     void setDirection(float alpha, float beta, float phi);
 
     float getIntensity() const;
     void setIntensity(float i);
 
-    const std::vector<float>& getColor() const;
+    glm::vec3 getColor() const;
     void setColor(float r, float g, float b);
 
     void updateMotion(float time);
@@ -41,14 +54,8 @@ private:
 
     const std::string name;
 
-    std::vector<float> direction;
-
-    float intensity;
-
-    std::vector<float> color;
+    SeqLock<State> state;
 
-    std::shared_ptr<LinearMotion> linear;
-      
-    mutable std::mutex stateMutex;
+    std::shared_ptr<MultiMotion> motion;
 
 };
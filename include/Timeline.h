@@ -0,0 +1,111 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "Clock.h"
+
+// Declaration of class Timeline
+//
+// Master clock and scheduler for timed events such as image switches, driven
+// by a Clock which may be real, accelerated or fixed-step. Time is kept as
+// integer nanoseconds since the clock began, so neither the clock nor
+// periodic events drift however long the program runs: a periodic event is
+// re-armed at its previous deadline plus its period, never relative to when
+// it happened to fire. Pending events are held in a hashed timer wheel, so
+// scheduling and expiry cost does not grow with the number of events.
+class Timeline {
+
+    // Public type definitions
+public:
+
+    typedef Clock::Duration Duration;
+
+    // Event callback, passed the deadline at which the event was scheduled
+    typedef std::function<void(Duration)> Action;
+
+
+    // Constructor
+public:
+
+    Timeline();
+
+
+    // Public interface methods
+public:
+
+    // Schedule a one-shot event at an absolute time, returning its identifier
+    unsigned long schedule(Duration at, Action action);
+
+    // Schedule an event at an absolute time, repeating every period thereafter
+    unsigned long scheduleEvery(Duration first, Duration period, Action action);
+
+    void cancel(unsigned long id);
+
+    // Tick the clock and advance to it, firing every event which has come due
+    void advance();
+
+    // Advance to an explicit time since the timeline began
+    void advance(Duration time);
+
+    Duration getTime() const;
+
+    // Read the clock without advancing or firing any events
+    Duration sample() const;
+
+    // Take time from another clock, from the next advance onwards
+    void setClock(std::shared_ptr<Clock> clock);
+
+    float getSeconds() const;
+
+    size_t getPending() const;
+
+    static Duration fromSeconds(double seconds);
+
+    static float toSeconds(Duration duration);
+
+
+    // Private type definitions
+private:
+
+    struct Event {
+        Duration deadline;
+        Duration period;
+        unsigned long id;
+        Action action;
+    };
+
+
+    // Private helper methods
+private:
+
+    void insert(Event &&event);
+
+    void collect(std::vector<Event> &slot);
+
+
+    // Private attributes
+private:
+
+    std::shared_ptr<Clock> clock;
+
+    Duration now;
+
+    std::int64_t tick;
+
+    std::vector<std::vector<Event>> wheel;
+
+    std::vector<Event> due;
+
+    unsigned long nextId;
+
+    size_t pending;
+
+    static const Duration k_Tick;
+
+    static const size_t k_Slots;
+
+};
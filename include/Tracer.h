@@ -0,0 +1,141 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+// Declaration of class Tracer
+//
+// Process-wide trace-event recorder, written out in the Chrome trace format
+// understood by chrome://tracing and Perfetto. Each thread appends events to
+// its own chunked buffer without locking; buffers are only gathered and
+// serialized when tracing stops, normally at exit. Event names and categories
+// given as C strings must be string literals, or otherwise outlive the trace;
+// names given as std::string are copied into the recording thread's string
+// table. Recording is a single relaxed load when tracing is off.
+class Tracer {
+
+    // Public type definitions
+public:
+
+    // Records a complete event spanning the lifetime of the scope
+    class Scope {
+    public:
+        Scope(const char *category, const char *name);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        const char *category;
+        const char *name;
+        std::int64_t start;
+    };
+
+
+    // Public interface methods
+public:
+
+    // Begin recording, to be written to path when tracing stops
+    static void start(const std::string &path);
+
+    // Stop recording and write the trace file
+    static void stop();
+
+    static bool isEnabled();
+
+    // Name the calling thread in the trace
+    static void setThreadName(const char *name);
+
+    static void complete(const char *category,
+                         const char *name,
+                         std::int64_t start,
+                         std::int64_t duration);
+
+    static void complete(const char *category,
+                         const std::string &name,
+                         std::int64_t start,
+                         std::int64_t duration);
+
+    static void instant(const char *category, const char *name);
+
+    static void counter(const char *name, double value);
+
+    // Flow arrows link slices across threads and time; each flow event
+    // binds to the slice enclosing it on the calling thread
+    static std::uint64_t newFlow();
+    static void flowBegin(const char *category, const char *name, std::uint64_t id);
+    static void flowStep(const char *category, const char *name, std::uint64_t id);
+    static void flowEnd(const char *category, const char *name, std::uint64_t id);
+
+    static std::int64_t now();
+
+
+    // Private type definitions
+private:
+
+    struct Event {
+        const char *category;
+        const char *name;
+        std::int64_t timestamp;
+        std::int64_t duration;
+        double value;
+        std::uint64_t id;
+        char phase;
+    };
+
+    static constexpr size_t k_ChunkEvents = 4096;
+
+    static constexpr size_t k_MaxChunks = 256;
+
+    // One thread's events; only the owning thread appends, and chunks are
+    // only added under the mutex, which the writer holds while gathering.
+    // Interned names are kept with the buffer, so outlive their thread, and
+    // never move once added
+    struct Buffer {
+        long threadId;
+        const char *threadName;
+        std::mutex chunksMutex;
+        std::vector<std::unique_ptr<Event[]>> chunks;
+        std::atomic<size_t> count;
+        std::atomic<unsigned long> dropped;
+        std::unordered_set<std::string> names;
+    };
+
+
+    // Private helper methods
+private:
+
+    static Buffer& threadBuffer();
+
+    static void record(char phase,
+                       const char *category,
+                       const char *name,
+                       std::int64_t timestamp,
+                       std::int64_t duration = 0,
+                       double value = 0.0,
+                       std::uint64_t id = 0UL);
+
+    static void write();
+
+
+    // Private attributes
+private:
+
+    static std::atomic<bool> enabled;
+
+    static std::atomic<std::uint64_t> flows;
+
+    static std::mutex buffersMutex;
+
+    static std::vector<std::shared_ptr<Buffer>> buffers;
+
+    static std::string path;
+
+};
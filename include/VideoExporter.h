@@ -0,0 +1,110 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Declaration of class VideoExporter
+//
+// Streams rendered frames to a video file. Each frame is read back from the
+// bound framebuffer into the next of a ring of pixel buffer objects, and is
+// only mapped once that buffer comes round again, a few frames later, by
+// which time the GPU has long finished the copy; the render loop therefore
+// never waits on glReadPixels. Mapped frames are handed to a writer thread,
+// which flips them upright and writes them as YUV4MPEG2 (4:4:4, BT.601), or
+// as raw RGB24 when the path ends in ".rgb". A path beginning with '|' is
+// run as a command with the Y4M stream on its standard input, for piping
+// into an encoder such as ffmpeg.
+class VideoExporter {
+
+    // Constructor / destructor
+public:
+
+    // Throws runtime_error when the output cannot be opened
+    VideoExporter(const std::string &path, int width, int height, unsigned int fps);
+
+    ~VideoExporter();
+
+    VideoExporter(const VideoExporter&) = delete;
+    VideoExporter& operator=(const VideoExporter&) = delete;
+
+
+    // Public interface methods
+public:
+
+    // Start reading back the frame just rendered to the read framebuffer
+    void capture();
+
+    // Collect every outstanding frame, then wait for the writer to drain
+    void finish();
+
+    unsigned long getFrames() const;
+
+    // Frames for which the render loop had to wait on the writer
+    unsigned long getStalls() const;
+
+
+    // Private helper methods
+private:
+
+    void collect(size_t slot);
+
+    void writeLoop();
+
+    bool write(const std::vector<std::uint8_t> &pixels);
+
+    bool writeY4m(const std::vector<std::uint8_t> &pixels);
+
+    bool writeRgb(const std::vector<std::uint8_t> &pixels);
+
+
+    // Private attributes
+private:
+
+    const int width;
+    const int height;
+    const size_t frameBytes;
+
+    bool raw;
+    bool piped;
+    std::FILE *output;
+
+    // Readback ring, owned by the render thread
+    static constexpr size_t k_Buffers = 3;
+
+    GLuint buffers[k_Buffers];
+    GLsync fences[k_Buffers];
+    size_t next;
+
+    unsigned long frames;
+    unsigned long stalls;
+
+    // Shared with the writer thread, under queueMutex
+    std::deque<std::vector<std::uint8_t>> queued;
+    std::vector<std::vector<std::uint8_t>> spare;
+    bool writing;
+    bool running;
+    bool failed;
+
+    // Owned by the writer thread
+    std::vector<std::uint8_t> plane;
+
+    std::mutex queueMutex;
+
+    std::condition_variable wake;
+
+    std::condition_variable drained;
+
+    std::thread writer;
+
+    static constexpr size_t k_MaxQueued = 8;
+
+    static const GLuint64 k_FenceTimeout;
+
+};
@@ -2,34 +2,47 @@
 #include <GL/glew.h>
 #include <GL/glx.h>
 #include <GL/gl.h>
-#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
 #include <iomanip>
 #include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
 #include <string>
-#include <thread>
+#include <vector>
 
+#include "Clock.h"
+#include "EffectCosts.h"
+#include "EventScript.h"
 #include "Florb.h"
 #include "FlorbConfigs.h"
 #include "FlorbUtils.h"
+#include "FramePacer.h"
+#include "FrameProfiler.h"
+#include "GLCounters.h"
+#include "GLDebug.h"
+#include "HeadlessContext.h"
+#include "ResourceMonitor.h"
+#include "Tracer.h"
+#include "VideoExporter.h"
 
 #define VERSION_MAJOR 0
 #define VERSION_MINOR 4
 
-namespace chrono = std::chrono;
-
-using chrono::duration;
-using chrono::duration_cast;
-using chrono::milliseconds;
-using chrono::steady_clock;
-
 using std::cerr;
 using std::cout;
 using std::endl;
 using std::exception;
+using std::int64_t;
+using std::make_shared;
+using std::make_unique;
 using std::runtime_error;
+using std::shared_ptr;
 using std::string;
-
-namespace this_thread = std::this_thread;
+using std::unique_ptr;
+using std::vector;
 
 
 Display *display;
@@ -39,6 +52,12 @@ GLXContext context;
 int screenWidth = 800;
 int screenHeight = 600;
 
+// Intermediate framebuffer; headless frames are rendered into it
+GLuint framebuffer = 0;
+
+// Set from a signal handler, to end a headless run cleanly
+static volatile std::sig_atomic_t interrupted = 0;
+
 
 // Declare function pointers (global or static)
 PFNGLATTACHSHADERPROC       glAttachShader       = nullptr;
@@ -69,10 +88,12 @@ void generateFramebuffer() {
     GLuint fbo1, tex1;
     glGenFramebuffers(1, &fbo1);
     glBindFramebuffer(GL_FRAMEBUFFER, fbo1);
+    GLDebug::label(GL_FRAMEBUFFER, fbo1, "intermediate");
     
     // Create color texture to attach
     glGenTextures(1, &tex1);
     glBindTexture(GL_TEXTURE_2D, tex1);
+    GLDebug::label(GL_TEXTURE, tex1, "intermediate color");
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, screenWidth, screenHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
@@ -82,6 +103,7 @@ void generateFramebuffer() {
     GLuint rbo;
     glGenRenderbuffers(1, &rbo);
     glBindRenderbuffer(GL_RENDERBUFFER, rbo);
+    GLDebug::label(GL_RENDERBUFFER, rbo, "intermediate depth");
     glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, screenWidth, screenHeight);
     glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, rbo);
     
@@ -90,13 +112,68 @@ void generateFramebuffer() {
         cerr << "Framebuffer is not complete" << endl;
     
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    framebuffer = fbo1;
+}
+
+
+// Initialize the state shared by windowed and headless rendering, once a
+// context is current
+void initRendering(bool headless, bool debug) {
+
+    GLenum err = glewInit();
+
+    // GLEW's GLX extensions need an X display, which headless runs lack;
+    // the core entry points are loaded regardless
+    if ((err != GLEW_OK) and !(headless and (err == GLEW_ERROR_NO_GLX_DISPLAY))) {
+        throw runtime_error(string("GLEW init failed: ") + (const char*)glewGetErrorString(err));
+    }
+
+    // OpenGL errors are reported through the debug callback from here on
+    GLDebug::initialize(debug);
+
+    // Graphical housekeeping
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_CULL_FACE);
+    
+    glFrontFace(GL_CCW);
+    glCullFace(GL_BACK);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    
+    // Generate an intermediate framebuffer for fragment shader pipelining
+    generateFramebuffer();
+
+    
+    const GLubyte* version = glGetString(GL_VERSION);
+    cout << "[INFO] OpenGL version: " << version << endl;
+}
+
+
+// Initialize OpenGL without a window, drawing into the intermediate framebuffer
+unique_ptr<HeadlessContext> initHeadless(bool debug) {
+
+    auto headlessContext(make_unique<HeadlessContext>(screenWidth, screenHeight, debug));
+
+    initGLFunctions();
+    initRendering(true, debug);
+
+    // A surfaceless context has no default framebuffer, nor viewport
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glViewport(0, 0, screenWidth, screenHeight);
+
+    return headlessContext;
 }
 
 
 // Initialize OpenGL and X11 Window
-void initOpenGL() {
+void initOpenGL(bool debug) {
 
     initGLFunctions();
+
+    // Shader hot reload may drive GLX from a shared-context compile thread
+    XInitThreads();
     
     display = XOpenDisplay(nullptr);
     if (!display) throw runtime_error("Cannot open X11 display");
@@ -164,10 +241,12 @@ void initOpenGL() {
         throw runtime_error("glXCreateContextAttribsARB not supported");
     }
 
+    // Some drivers only send debug output from a debug context
     int context_attribs[] = {
         GLX_CONTEXT_MAJOR_VERSION_ARB, 3,
         GLX_CONTEXT_MINOR_VERSION_ARB, 3,
         GLX_CONTEXT_PROFILE_MASK_ARB, GLX_CONTEXT_CORE_PROFILE_BIT_ARB,
+        GLX_CONTEXT_FLAGS_ARB, (debug ? GLX_CONTEXT_DEBUG_BIT_ARB : 0),
         None
     };
 
@@ -196,136 +275,477 @@ void initOpenGL() {
 
     glXMakeCurrent(display, window, context);
 
-    
-    // Disable VSYNC, permitting arbitrary frame rates
-    typedef void (*glXSwapIntervalEXTProc)(Display*, GLXDrawable, int);
-    glXSwapIntervalEXTProc glXSwapIntervalEXT = 
-      (glXSwapIntervalEXTProc)glXGetProcAddressARB((const GLubyte*)"glXSwapIntervalEXT");
-    if (glXSwapIntervalEXT) {
-        glXSwapIntervalEXT(display, glXGetCurrentDrawable(), 0);
-    }
 
     // Generate a test texture for use in debugging
     GLint testTex = 0;
     glGenTextures(1, (GLuint*)&testTex);
 
-    GLenum err = glewInit();
-    if (err != GLEW_OK) {
-        throw runtime_error(string("GLEW init failed: ") + (const char*)glewGetErrorString(err));
-    }
+    initRendering(false, debug);
+}
 
-    // Graphical housekeeping
-    glDisable(GL_DEPTH_TEST);
-    glDisable(GL_CULL_FACE);
-    
-    glFrontFace(GL_CCW);
-    glCullFace(GL_BACK);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+void onSignal(int) {
+    interrupted = 1;
+}
 
-    
-    // Generate an intermediate framebuffer for fragment shader pipelining
-    generateFramebuffer();
 
-    
-    const GLubyte* version = glGetString(GL_VERSION);
-    cout << "[INFO] OpenGL version: " << version << endl;
+// Report the average GL counts per frame on the console, and in the title of
+// any window
+void reportGLCounters(const GLCounters::Counts &totals, unsigned long frames, const string &title) {
+    auto perFrame([&totals, frames](GLCounters::Count count) {
+        return (static_cast<double>(totals[count]) / frames);
+    });
+
+    std::ostringstream report;
+    report << std::fixed << std::setprecision(1)
+           << perFrame(GLCounters::CALLS) << " GL calls per frame ("
+           << perFrame(GLCounters::UNIFORMS) << " uniforms, "
+           << perFrame(GLCounters::BINDS) << " binds, "
+           << perFrame(GLCounters::DRAWS) << " draws, "
+           << perFrame(GLCounters::CLEARS) << " clears, "
+           << perFrame(GLCounters::BUFFER_UPLOADS) << " buffer and "
+           << perFrame(GLCounters::TEXTURE_UPLOADS) << " texture uploads of "
+           << (perFrame(GLCounters::UPLOAD_BYTES) / 1024.0) << " KB), "
+           << perFrame(GLCounters::REDUNDANT) << " redundant";
+
+    cout << "[INFO] " << report.str() << endl;
+    FlorbUtils::setWindowTitle(display, window, (title + " : " + report.str()));
+}
+
+
+// Apply an input or configuration event, whether live or replayed; returns
+// false when the event ends the session
+bool applyEvent(const EventScript::Event &event, FlorbConfigs &configs) {
+
+    switch (event.type) {
+    case EventScript::Type::KEY:
+        if (event.key == "space") {
+            cout << "Showing the dashboard" << endl;
+        } else if (event.key == "escape") {
+            // Exit the application
+            cout << "Exiting Florb" << endl;
+            return false;
+        }
+        break;
+
+    case EventScript::Type::RESIZE:
+        if (event.width != screenWidth || event.height != screenHeight) {
+            screenWidth = event.width;
+            screenHeight = event.height;
+            glViewport(0, 0, screenWidth, screenHeight);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        }
+        break;
+
+    case EventScript::Type::CONFIG:
+        configs.parse(event.document);
+        break;
+
+    case EventScript::Type::END:
+        return false;
+    }
+
+    return true;
 }
 
 int main(int numArgs, const char *args[]) {
 
     cout << "Florb v" << VERSION_MAJOR << "." << VERSION_MINOR << endl;
 
-    // All parameters are provided by the config JSON
-    if (numArgs > 1) {
-        cerr << "Usage : " << args[0] << endl;
+    bool headless(false);
+    bool sized(false);
+    long frameLimit(0);
+    string exportPath;
+    double exportDuration(10.0);
+    unsigned int exportRate(60U);
+    auto clock(make_shared<Clock>());
+    bool seeded(false);
+    unsigned int seed(0U);
+    string recordPath;
+    string replayPath;
+    string configPath(FlorbConfigs::k_DefaultPath);
+    vector<EffectCosts::Size> costSizes;
+
+    // All other parameters are provided by the config JSON
+    for (int arg = 1; arg < numArgs; arg++) {
+        string option(args[arg]);
+        bool valid(true);
+
+        if ((option == "--trace") and ((arg + 1) < numArgs)) {
+            Tracer::start(args[++arg]);
+        } else if (option == "--headless") {
+            headless = true;
+        } else if ((option == "--size") and ((arg + 1) < numArgs)) {
+            char separator('\0');
+            valid = ((std::sscanf(args[++arg], "%d%c%d", &screenWidth, &separator, &screenHeight) == 3) and
+                     (separator == 'x') and (screenWidth > 0) and (screenHeight > 0));
+            sized = true;
+        } else if ((option == "--frames") and ((arg + 1) < numArgs)) {
+            frameLimit = std::atol(args[++arg]);
+            valid = (frameLimit > 0);
+        } else if ((option == "--export") and ((arg + 1) < numArgs)) {
+            exportPath = args[++arg];
+            valid = !exportPath.empty();
+        } else if ((option == "--duration") and ((arg + 1) < numArgs)) {
+            exportDuration = std::atof(args[++arg]);
+            valid = (exportDuration > 0.0);
+        } else if ((option == "--fps") and ((arg + 1) < numArgs)) {
+            auto rate(std::atol(args[++arg]));
+            exportRate = static_cast<unsigned int>(rate);
+            valid = ((rate > 0) and (rate <= 1000));
+        } else if ((option == "--clock") and ((arg + 1) < numArgs)) {
+            valid = clock->parse(args[++arg]);
+        } else if ((option == "--seed") and ((arg + 1) < numArgs)) {
+            seed = static_cast<unsigned int>(std::strtoul(args[++arg], nullptr, 0));
+            seeded = true;
+        } else if ((option == "--record") and ((arg + 1) < numArgs)) {
+            recordPath = args[++arg];
+        } else if ((option == "--replay") and ((arg + 1) < numArgs)) {
+            replayPath = args[++arg];
+        } else if ((option == "--config") and ((arg + 1) < numArgs)) {
+            configPath = args[++arg];
+        } else if ((option == "--effect-costs") and ((arg + 1) < numArgs)) {
+            valid = EffectCosts::parseSizes(args[++arg], costSizes);
+        } else {
+            valid = false;
+        }
+
+        if (!valid) {
+            cerr << "Usage : "
+                 << args[0]
+                 << " [--config <florb.json>]"
+                 << " [--trace <trace.json>]"
+                 << " [--headless [--size <width>x<height>] [--frames <count>]]"
+                 << " [--export <out.y4m|out.rgb|\"|command\"> [--duration <seconds>] [--fps <rate>]]"
+                 << " [--clock real|fixed:<rate>|accelerated:<scale>] [--seed <seed>]"
+                 << " [--record <script> | --replay <script>]"
+                 << " [--effect-costs <width>x<height>[,...] [--frames <count>]]"
+                 << endl;
+            return -EINVAL;
+        }
+    }
+
+    if (!recordPath.empty() and !replayPath.empty()) {
+        cerr << "A session cannot be recorded and replayed at once" << endl;
         return -EINVAL;
     }
 
+    // Exports render offscreen, one fixed time step per video frame
+    if (!exportPath.empty()) {
+        headless = true;
+        if (frameLimit == 0) frameLimit = std::max(std::lround(exportDuration * exportRate), 1L);
+    }
+
+    // Effect costs are measured offscreen, in a framebuffer fitting every size
+    if (!costSizes.empty()) {
+        headless = true;
+        if (!sized) {
+            screenWidth = screenHeight = 0;
+            for (const auto &size : costSizes) {
+                screenWidth = std::max(screenWidth, size.first);
+                screenHeight = std::max(screenHeight, size.second);
+            }
+            sized = true;
+        }
+    }
+
+    Tracer::setThreadName("render");
+
     try {
-        initOpenGL();
+        // A replay runs as recorded, with the same seed, clock and size
+        EventScript script;
+        if (!replayPath.empty()) {
+            auto header(script.replay(replayPath));
+
+            seed = header.seed;
+            seeded = true;
+            clock->parse(header.clock);
+
+            if (!sized) {
+                screenWidth = header.width;
+                screenHeight = header.height;
+                sized = true;
+            }
+        }
+
+        if (!exportPath.empty()) clock->setFixed(Timeline::fromSeconds(1.0 / exportRate));
+
+        // Every effect is measured on the same, frozen, scene
+        if (!costSizes.empty()) clock->setFixed(Clock::Duration(0));
+
+        if (!seeded) seed = std::random_device()();
+        cout << "[INFO] Random seed " << seed << ", " << clock->describe() << " clock" << endl;
+
+        if (headless and !sized) {
+            screenWidth = 1920;
+            screenHeight = 1080;
+        }
+
+        // The configuration comes first in a script, ahead of any input, and
+        // is read ahead of the context, which it may ask to be a debug context
+        auto configs(make_shared<FlorbConfigs>());
+        EventScript::Event event;
+
+        if (script.isReplaying()) {
+            if (!script.poll(0UL, event) or (event.type != EventScript::Type::CONFIG)) {
+                throw runtime_error("Session script holds no configuration");
+            }
+
+            configs->parse(event.document);
+        } else {
+            configs->load(configPath);
+        }
+
+        unique_ptr<HeadlessContext> headlessContext;
+
+        if (headless) {
+            headlessContext = initHeadless(configs->getGLDebug());
+
+            // Stop at the frame limit, or when interrupted
+            std::signal(SIGINT, onSignal);
+            std::signal(SIGTERM, onSignal);
+        } else {
+            initOpenGL(configs->getGLDebug());
+
+            // The title was configured before there was a window to show it
+            FlorbUtils::setWindowTitle(display, window, configs->getTitle());
+        }
 
         glEnable(GL_DEPTH_TEST);
 
-        Florb florb;
+        if (!recordPath.empty()) {
+            script.record(recordPath, { seed, clock->describe(), screenWidth, screenHeight });
+
+            event.frame = 0UL;
+            event.type = EventScript::Type::CONFIG;
+            event.document = configs->getSnapshot()->document;
+            script.add(event);
+        }
+
+        if (!costSizes.empty()) EffectCosts::prepare(*configs);
+
+        Florb florb(configs, seed);
+        florb.setClock(clock);
+
+        if (!costSizes.empty()) {
+            EffectCosts costs(configs, florb);
+            costs.run(costSizes, ((frameLimit > 0) ? frameLimit : EffectCosts::k_DefaultFrames));
+
+            Tracer::stop();
+            return 0;
+        }
+
+        unique_ptr<VideoExporter> exporter;
+        if (!exportPath.empty()) {
+            exporter = make_unique<VideoExporter>(exportPath, screenWidth, screenHeight, exportRate);
+        }
+
+        // Headless frames are only fenced, rendering as fast as they can
+        FramePacer pacer((headless ? nullptr : display), (headless ? None : window));
+
+        // Stages timed here, around the Florb's own
+        auto profiler(florb.getProfiler());
+        auto frameStage(profiler->addStage("frame"));
+        auto eventsStage(profiler->addStage("events"));
+        auto presentStage(profiler->addStage("present"));
+        auto exportStage(exporter ? profiler->addStage("export") : 0U);
+
+        auto recorder(florb.getRecorder());
+
+        // Soak runs sample what is held on animation time, once loaded
+        ResourceMonitor monitor;
+
+        // GL counts are profiled each frame, and reported once a second
+        unsigned int glValues[GLCounters::MAX_COUNTS];
+        for (unsigned int count = 0; count < GLCounters::MAX_COUNTS; count++) {
+            auto kind(static_cast<GLCounters::Count>(count));
+            glValues[count] = profiler->addValue(GLCounters::getName(kind), GLCounters::getUnit(kind));
+        }
+
+        GLCounters::Counts glTotals = {};
+        unsigned long glFrames(0UL);
+        auto glReported(FrameProfiler::now());
+
+        long frames(0);
+        auto runStart(FrameProfiler::now());
         
         bool running = true;
         while (running) {
-            while (XPending(display)) {
-                XEvent event;
-                XNextEvent(display, &event);
+            profiler->beginFrame();
+            auto frameStart(FrameProfiler::now());
+
+            while (!headless and XPending(display)) {
+                XEvent xevent;
+                XNextEvent(display, &xevent);
 
-                if (event.type == KeyPress) {
-                    KeySym sym = XLookupKeysym(&event.xkey, 0);
+                EventScript::Event input;
+                input.frame = frames;
+
+                if (xevent.type == KeyPress) {
+                    KeySym sym = XLookupKeysym(&xevent.xkey, 0);
+                    input.type = EventScript::Type::KEY;
                     
                     if (sym == XK_space) {
-                        cout << "Showing the dashboard" << endl;
+                        input.key = "space";
                     } else if (sym == XK_Escape) {
-                        // Exit the application
-                        cout << "Exiting Florb" << endl;
-                        running = false;
-                    }
-                }
-                else if (event.type == ConfigureNotify) {
-                    XConfigureEvent xce = event.xconfigure;
-                    if (xce.width != screenWidth || xce.height != screenHeight) {
-                        screenWidth = xce.width;
-                        screenHeight = xce.height;
-                        glViewport(0, 0, screenWidth, screenHeight);
-                        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-                    }
+                        input.key = "escape";
+                    } else if ((sym == XK_r) and FlorbConfigs::read(input.document, configPath)) {
+                        // Reload the configuration file
+                        input.type = EventScript::Type::CONFIG;
+                    } else continue;
                 }
+                else if ((xevent.type == ConfigureNotify) and
+                         ((xevent.xconfigure.width != screenWidth) or
+                          (xevent.xconfigure.height != screenHeight))) {
+                    input.type = EventScript::Type::RESIZE;
+                    input.width = xevent.xconfigure.width;
+                    input.height = xevent.xconfigure.height;
+                } else continue;
+
+                // A replay takes its input from the script, though Escape
+                // still ends it
+                if (script.isReplaying() and
+                    !((input.type == EventScript::Type::KEY) and (input.key == "escape"))) continue;
+
+                script.add(input);
+                if (!applyEvent(input, *configs)) running = false;
             }
 
-            // Get a pointer to the Florb configs
-            auto florbConfigs(florb.getConfigs());
+            while (script.poll(frames, event)) {
+                if (!applyEvent(event, *configs)) running = false;
+            }
+
+            profiler->endStage(eventsStage, frameStart);
+
+            pacer.markInput();
+
+            // Refresh our snapshot of the Florb configs
+            static shared_ptr<const FlorbConfigs::Snapshot> florbConfigs;
+            configs->refresh(florbConfigs);
             
-            // Update timing for flower transition
-            static steady_clock::time_point startTime = steady_clock::now();
-            float timeMsec = duration_cast<milliseconds>(steady_clock::now() - startTime).count();
-            float timeSeconds = (timeMsec / 1000.0f);
-
-            bool transition(false);
-            if (timeSeconds >= florbConfigs->getImageSwitch()) {
-                florb.nextFlower();
-                startTime = steady_clock::now();
-                transition = true;
+            // Pace frames at the configured rate, or locked to the display
+            pacer.setRate(florbConfigs->videoFrameRate);
+            pacer.setVsync(florbConfigs->vsync);
+            pacer.setReporting(florbConfigs->frameStats);
+            pacer.setFramesInFlight(florbConfigs->framesInFlight);
+
+            profiler->setEnabled(florbConfigs->profileEnabled);
+            profiler->setDump(florbConfigs->profilePath, florbConfigs->profileInterval);
+            profiler->setCounters(florbConfigs->profileEnabled and florbConfigs->profileCounters);
+
+            recorder->setEnabled(florbConfigs->recorderEnabled);
+            recorder->setWindow(florbConfigs->recorderWindow);
+            recorder->setThreshold(florbConfigs->recorderThreshold);
+            recorder->setDirectory(florbConfigs->recorderDirectory);
+
+            // The title is restored once counting stops
+            if (GLCounters::isEnabled() and !florbConfigs->glCounters) {
+                FlorbUtils::setWindowTitle(display, window, florbConfigs->title);
             }
+            GLCounters::setEnabled(florbConfigs->glCounters);
+            GLDebug::setSynchronous(florbConfigs->glSynchronous);
+
+            monitor.setPath(florbConfigs->resourcesEnabled ? florbConfigs->resourcesPath : string());
+            monitor.setInterval(florbConfigs->resourcesInterval);
 
-            // Fetch the configurable frame rate from the Florb
-            const float k_FrameTime(1000.0f / florbConfigs->getVideoFrameRate());
+            // Render a flower frame; image switches are scheduled by the Florb
+            florb.renderFrame();
 
-            static steady_clock::time_point lastFrame = steady_clock::now();
-            float frameElapsed = duration_cast<milliseconds>(steady_clock::now() - lastFrame).count();
+            if (exporter) {
+                FrameProfiler::Scope scope(*profiler, exportStage);
+                GLDebug::Group group("export readback");
+                exporter->capture();
+            }
 
-            if (frameElapsed < k_FrameTime) {
-              // Busy-wait or sleep for the remaining time
-              this_thread::sleep_for(milliseconds(static_cast<int>(k_FrameTime - frameElapsed)));
+            {
+                FrameProfiler::Scope scope(*profiler, presentStage);
+                GLDebug::Group group("present");
+                pacer.present();
             }
 
-            // Mark start of new frame
-            lastFrame = steady_clock::now();
- 
-            // Render a flower frame, marking transition frames
-            florb.renderFrame(transition);
-            glXSwapBuffers(display, window);
+            // Report the frame's OpenGL errors and warnings
+            GLDebug::flush();
+
+            profiler->endStage(frameStage, frameStart);
 
+            if (GLCounters::isEnabled()) {
+                auto counts(GLCounters::endFrame());
+                for (unsigned int count = 0; count < GLCounters::MAX_COUNTS; count++) {
+                    profiler->setValue(glValues[count], counts[count]);
+                    glTotals[count] += counts[count];
+                }
+
+                glFrames++;
+                if ((FrameProfiler::now() - glReported) >= 1000000000) {
+                    reportGLCounters(glTotals, glFrames, florbConfigs->title);
 
-        // cerr << "Frame start : "
-        //          << duration_cast<milliseconds>(frameElapsed).count() << " ms" << endl;
+                    glTotals.fill(0UL);
+                    glFrames = 0UL;
+                    glReported = FrameProfiler::now();
+                }
+            }
+
+            profiler->endFrame();
+
+            // Keep the recent past, snapshotting it if this frame ran long
+            recorder->addFrame(static_cast<int64_t>(1.0e9 / pacer.getRate()));
+
+            if (!florb.isLoading()) {
+                monitor.addFrame(FrameProfiler::now() - frameStart);
+                monitor.update(frames, (clock->now().count() / 1.0e9));
+            }
+
+            frames++;
+            if (interrupted or ((frameLimit > 0) and (frames >= frameLimit))) running = false;
             
         } // while (running)
 
-        glXMakeCurrent(display, None, nullptr);
-
-        glXDestroyContext(display, context);
-        XDestroyWindow(display, window);
-        XCloseDisplay(display);
+        // Mark the last frame, so a replay renders exactly as many
+        if (frames > 0) {
+            event.frame = (frames - 1);
+            event.type = EventScript::Type::END;
+            script.add(event);
+        }
+
+        if (headless) {
+            // Throughput includes the GPU, and any video still being written
+            if (exporter) exporter->finish();
+            glFinish();
+
+            auto seconds((FrameProfiler::now() - runStart) / 1.0e9);
+            cout << "[INFO] Rendered "
+                 << frames
+                 << " headless frames at "
+                 << screenWidth
+                 << "x"
+                 << screenHeight
+                 << " in "
+                 << std::fixed
+                 << std::setprecision(3)
+                 << seconds
+                 << " s ("
+                 << (frames / seconds)
+                 << " fps)"
+                 << endl;
+        } else {
+            glXMakeCurrent(display, None, nullptr);
+
+            glXDestroyContext(display, context);
+            XDestroyWindow(display, window);
+            XCloseDisplay(display);
+        }
+
+        // Write out the trace once every thread has finished recording,
+        // while the Florb whose profiler named its stages is still alive
+        Tracer::stop();
 
     } catch (const exception& e) {
         cerr << "Fatal error: " << e.what() << std::endl;
+        Tracer::stop();
         return 1;
     }
 
+    // Write out any trace not already written
+    Tracer::stop();
+
     return 0;
 }
@@ -0,0 +1,330 @@
+#version 330 core
+in vec2 fragUV;
+in vec3 fragPos;
+in vec3 fragNormal;
+
+out vec4 FragColor;
+
+#define PI 3.141592654
+
+uniform float time;
+
+uniform vec2 resolution;
+uniform float aspectRatio;
+
+uniform vec2 offset;
+uniform float zoom;
+
+// Motion descriptors, evaluated here against time rather than on the CPU
+#define MOTION_CONSTANT 0
+#define MOTION_SINUSOIDAL 1
+#define MOTION_EXPRESSION 2
+
+#define MOTION_BOUNCE 0
+#define MOTION_BREATHE 1
+#define MOTION_RIM 2
+#define MAX_MOTIONS 3
+
+struct Motion {
+    float bias;
+    float amplitude;
+    float frequency;
+    float phase;
+    int type;
+};
+
+layout(std140) uniform Motions {
+    Motion motions[MAX_MOTIONS];
+};
+
+// Expression motions are compiled into motionExpression() by the host, which
+// defines MOTION_EXPRESSIONS in a prelude ahead of this source
+#ifndef MOTION_EXPRESSIONS
+float motionExpression(int slot, float t) {
+    return 0.0;
+}
+#endif
+
+float evaluateMotion(int slot, float t) {
+    Motion motion = motions[slot];
+
+    if (motion.type == MOTION_EXPRESSION) {
+        return motionExpression(slot, t);
+    } else if (motion.type == MOTION_SINUSOIDAL) {
+        return motion.bias + motion.amplitude * sin(2.0 * PI * motion.frequency * t + motion.phase);
+    }
+
+    return motion.bias + motion.amplitude;
+}
+
+#define MAX_LIGHTS 4
+#define MAX_MOTES 256
+
+struct Spotlight {
+    vec3 direction;
+    float intensity;
+    vec3 color;
+};
+
+// Spotlights and specular parameters
+layout(std140) uniform Lights {
+    Spotlight spotlights[MAX_LIGHTS];
+    int lightCount;
+    float shininess;
+};
+
+// Effect parameters, laid out in std140 four-component rows
+layout(std140) uniform Effects {
+    vec3 rimColor;
+    float rimExponent;
+
+    float vignetteExponent;
+    float iridescenceStrength;
+    float iridescenceFrequency;
+    float iridescenceShift;
+
+    float anisotropyStrength;
+    float anisotropySharpness;
+    float waveAmplitude;
+    float waveFrequency;
+
+    float waveSpeed;
+    int anisotropyEnabled;
+    int anisotropicDebug;
+    int specularDebug;
+};
+
+// Dust motes, packed as (center.xy, radius, speed), with amplitudes four per row
+layout(std140) uniform Motes {
+    vec4 motes[MAX_MOTES];
+    vec4 motesAmplitudes[MAX_MOTES / 4];
+    vec3 motesColor;
+    int moteCount;
+};
+
+uniform vec3 viewPos;
+
+uniform sampler2D currentTexture;
+uniform sampler2D previousTexture;
+uniform float transitionProgress;
+
+// uniform float loadProgress;
+// uniform int showProgressBar;
+#define loadProgress 0.5
+#define showProgressBar 1
+
+void drawStatusBar(inout vec4 FragColor, vec2 screenUV, vec2 resolution) {
+    if ((showProgressBar == 0) || loadProgress >= 1.0) return;
+
+    // Bar dimensions (relative)
+    float barWidth = 0.90;
+    float barHeight = 0.03;
+    float radius = 0.015;
+
+    // Vertically centered
+    vec2 center = vec2(0.5, 0.5);
+    vec2 halfSize = vec2(barWidth * 0.5, barHeight * 0.5);
+    vec2 uv = screenUV;
+
+    // Relative to bar center
+    vec2 d = abs(uv - center) - halfSize;
+
+    // Rounded rectangle mask
+    float dist = length(max(d, 0.0)) - radius;
+    float alpha = smoothstep(0.005, 0.0, dist);
+
+    // Progress mask
+    float progressRight = center.x - halfSize.x + barWidth * loadProgress;
+    float inProgress = step(uv.x, progressRight);
+
+    vec3 barColor = vec3(0.0, 0.8, 0.0); // Solid green
+
+    // Composite blend
+    FragColor.rgb = mix(FragColor.rgb, barColor, alpha * inProgress);
+}
+
+
+void main() {
+
+    // Evaluate the breathing radius and rim pulse for this frame
+    float radius = evaluateMotion(MOTION_BREATHE, time);
+    float rimStrength = evaluateMotion(MOTION_RIM, time);
+
+    // Obtain a normalized direction vector from the fragment shader
+    vec3 dir = normalize(fragPos);
+
+    // Use spherical coordinates to modulate wave phase
+    float wavePhase =
+        ((dot(dir, vec3(1.0, 0.0, 0.0)) * waveFrequency) - (time * waveSpeed));
+
+    // Sine-based displacement along a direction (e.g. vertical in UV space)
+    vec2 waveOffset = vec2(0.0, sin(wavePhase) * waveAmplitude);
+
+    // Convert fragment direction to spherical UV coordinates
+    vec2 uv;
+    uv.x = atan(dir.z, dir.x) / (2.0 * PI) + 0.5;
+    uv.y = asin(dir.y) / PI + 0.5;
+
+    // Apply zoom and offset after spherical conersion, flipping vertically
+    uv = (uv - 0.5) * zoom + 0.5 + offset;
+    uv.y = 1.0 - uv.y;
+
+    // Apply aspect ratio correction centered on (0.5, 0.5)
+    uv.x = (uv.x - 0.5) * aspectRatio + 0.5;
+
+    // Clamp to avoid oversampling outside the texture
+    uv = clamp(uv, vec2(0.0), vec2(1.0));
+
+    // Apply displacement to UVs before texture sampling
+    uv += waveOffset;
+    uv = clamp(uv, vec2(0.0), vec2(1.0));
+
+    // Discard any pixel locations beyond the radius of the sphere
+    if (length(fragPos) > radius)
+        discard;
+
+
+    // Dust mote contributions
+    float moteGlow = 0.0;
+    float dust = 0.0;
+    for (int i = 0; i < moteCount; ++i) {
+        float speed = motes[i].w;
+        float radius = motes[i].z / resolution.y;
+
+        // Wobbling orbit using sin/cos with time
+        float wobbleX = sin(time * speed);
+        float wobbleY = cos(time * speed * 0.5);
+
+        vec2 orbitOffset = vec2(wobbleX, wobbleY) * 0.01;
+
+        // Map [-1,1] to [0,1]
+        vec2 motePos = (motes[i].xy * 0.5 + 0.5);
+        motePos += orbitOffset;
+
+        float dist = distance(uv, motePos);
+        float alpha = smoothstep(radius, 0.0, dist);
+
+        dust += motesAmplitudes[i >> 2][i & 3] * alpha;
+    }
+
+    // Aspect-corrected center-relative coords
+    vec2 screenUV = gl_FragCoord.xy / resolution;
+    vec2 centered = screenUV - vec2(0.5);
+    centered.x *= resolution.x / resolution.y;
+
+
+    // Diffuse lighting
+    vec3 norm = normalize(fragNormal);
+
+
+    // Spotlighting
+    vec3 totalLighting = vec3(0.0);
+    vec3 viewDir = normalize(viewPos - fragPos);
+    float totalSpecular = 0.0;
+    vec3 anisotropicColor = vec3(0.0);
+    for (int i = 0; i < lightCount; ++i) {
+        vec3 lightDir = normalize(-spotlights[i].direction);
+        vec3 reflectDir = reflect(-lightDir, norm);
+
+        float diff = max(dot(norm, lightDir), 0.0);
+        float spec = pow(max(dot(viewDir, reflectDir), 0.0), shininess);
+        totalSpecular += spec;
+
+        vec3 lightColor = spotlights[i].color * spotlights[i].intensity;
+        vec3 lighting = (diff + spec) * lightColor;
+
+        anisotropicColor += lightColor;
+
+        totalLighting += lighting;
+    }
+
+    // Average the spotlight colors to produce the anisotropic color
+    if (lightCount > 0) anisotropicColor /= lightCount;
+
+
+    // Anisotropic specular reflections
+    vec3 anisotropicLightDir = -spotlights[0].direction;
+    vec3 anisotropicN = normalize(fragNormal);
+    vec3 anisotropicT = normalize(dFdx(fragPos));
+    vec3 anisotropicB = normalize(dFdy(fragPos));
+    vec3 tangent = normalize(anisotropicT - norm * dot(norm, anisotropicT));
+    vec3 bitangent = cross(norm, tangent);
+
+    // Simulate using a modified Blinn-Phong calculation
+    vec3 anisotropicH = normalize(viewDir + anisotropicLightDir);
+    float dotTH = dot(tangent, anisotropicH);
+    float dotNH = dot(norm, anisotropicH);
+
+    float th2 = (dotTH * dotTH);
+    float anisotropicFactor = pow(max(th2, 0.0001), anisotropySharpness);
+    float anisotropicSpec = pow(max(dotNH, 0.0), shininess) * anisotropicFactor;
+
+    vec3 specularColor = (anisotropicColor * pow(max(dotNH, 0.0), shininess) *
+                          anisotropicFactor * anisotropyStrength * 10.0);
+
+
+    // Calculate rim lighting
+    float rim = pow(1.0 - max(dot(viewDir, normalize(fragNormal)), 0.0), rimExponent);
+    vec3 rimLight = rimStrength * rim * rimColor;
+
+
+    // Vignette effect
+    float radial = length(centered);
+    float fadeStart = 1.0 - radius;
+    float fadeEnd = 1.0;
+
+    float vignette = 1.0;
+    if (radial > fadeStart) {
+        float t = (radial - fadeStart) / (fadeEnd - fadeStart);
+        vignette = 1.0 - clamp(pow(t, vignetteExponent), 0.0, 1.0);
+    }
+
+
+    // Iridescence effect
+    vec3 iridescenceN = normalize(fragNormal);
+    vec3 iridescenceV = normalize(viewPos - fragPos);
+    float angle = dot(iridescenceN, iridescenceV);
+
+    float facing = clamp(1.0 - angle, 0.0, 1.0);
+    float iridescence = sin(facing * iridescenceFrequency + iridescenceShift);
+    iridescence = 0.5 + 0.5 * iridescence;
+
+    vec3 shimmerColor = vec3(
+        0.5 + 0.5 * sin(6.2831 * iridescence + 0.0),
+        0.5 + 0.5 * sin(6.2831 * iridescence + 2.0),
+        0.5 + 0.5 * sin(6.2831 * iridescence + 4.0)
+    );
+
+
+    // Sample texture colors
+    vec4 colorPrev = texture(previousTexture, uv);
+    vec4 colorCurr = texture(currentTexture, uv);
+
+    vec4 texColor = mix(colorPrev, colorCurr, clamp(transitionProgress, 0.0, 1.0));
+
+    // Compute final color
+    vec3 finalColor = vignette * totalLighting * texColor.rgb;
+
+    if (anisotropyEnabled == 1) finalColor += specularColor;
+
+    finalColor += rimLight;
+
+    // Clamp and overlay colored dust mote glow
+    finalColor += clamp(dust, 0.0, 1.0) * motesColor;
+
+    // Incorporate iridescence
+    finalColor.rgb = mix(finalColor.rgb, shimmerColor, iridescenceStrength);
+
+
+    // Assign final color, taking debug modes into account
+    if (anisotropicDebug == 1) {
+       FragColor = vec4(specularColor, 1.0);
+    } else if (specularDebug == 1) {
+       FragColor = vec4(vec3(totalSpecular), 1.0);
+    } else {
+        FragColor = vec4(finalColor, 1.0);
+    }
+
+    // Update the status bar
+    drawStatusBar(FragColor, screenUV, resolution);
+}
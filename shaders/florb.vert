@@ -0,0 +1,78 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+
+out vec2 fragUV;
+out vec3 fragPos;
+out vec3 fragNormal;
+
+#define PI 3.141592654
+
+uniform float time;
+
+uniform vec2 resolution;
+
+// Motion descriptors, evaluated here against time rather than on the CPU
+#define MOTION_CONSTANT 0
+#define MOTION_SINUSOIDAL 1
+#define MOTION_EXPRESSION 2
+
+#define MOTION_BOUNCE 0
+#define MOTION_BREATHE 1
+#define MOTION_RIM 2
+#define MAX_MOTIONS 3
+
+struct Motion {
+    float bias;
+    float amplitude;
+    float frequency;
+    float phase;
+    int type;
+};
+
+layout(std140) uniform Motions {
+    Motion motions[MAX_MOTIONS];
+};
+
+// Expression motions are compiled into motionExpression() by the host, which
+// defines MOTION_EXPRESSIONS in a prelude ahead of this source
+#ifndef MOTION_EXPRESSIONS
+float motionExpression(int slot, float t) {
+    return 0.0;
+}
+#endif
+
+float evaluateMotion(int slot, float t) {
+    Motion motion = motions[slot];
+
+    if (motion.type == MOTION_EXPRESSION) {
+        return motionExpression(slot, t);
+    } else if (motion.type == MOTION_SINUSOIDAL) {
+        return motion.bias + motion.amplitude * sin(2.0 * PI * motion.frequency * t + motion.phase);
+    }
+
+    return motion.bias + motion.amplitude;
+}
+
+void main()
+{
+    // Breathing radius scales the unit sphere, then bounce offsets it
+    float breatheRadius = evaluateMotion(MOTION_BREATHE, time);
+    float bounceOffset = evaluateMotion(MOTION_BOUNCE, time);
+
+    vec3 scaled = aPos * breatheRadius;
+    vec3 pos = scaled + vec3(0.0, bounceOffset, 0.0);
+
+    // Aspect ratio correction
+    pos.x *= resolution.y / resolution.x;
+
+    // Assign fragment position and normal
+    fragPos = scaled;
+    fragNormal = normalize(pos);
+
+    // Generate spherical UV coordinates
+    vec3 dir = normalize(aPos);
+    fragUV.x = atan(dir.z, dir.x) / (2.0 * 3.14159265) + 0.5;
+    fragUV.y = asin(dir.y) / 3.14159265 + 0.5;
+
+    gl_Position = vec4(pos, 1.0);
+}